@@ -79,7 +79,8 @@ bool Settings::activateStylesheet(const SettingsStylesheetData *data)
     ESP_UTILS_LOGD("Activate stylesheet");
 
     ESP_UTILS_CHECK_FALSE_RETURN(
-        SettingsStylesheet::activateStylesheet(data->screen_size, *data), false, "Failed to activate stylesheet"
+        SettingsStylesheet::activateStylesheet(data->name, data->screen_size, *data), false,
+        "Failed to activate stylesheet"
     );
 
     return true;
@@ -189,7 +189,9 @@ bool SettingsManager::processInit()
     ESP_UTILS_CHECK_FALSE_RETURN(initWlan(), false, "Init WLAN failed");
 
     auto &storage_service = StorageNVS::requestInstance();
-    storage_service.connectEventSignal([this](const StorageNVS::Event & event) {
+    storage_service.connectKeyEventSignal({
+        Manager::SETTINGS_WLAN_SWITCH, Manager::SETTINGS_VOLUME, Manager::SETTINGS_BRIGHTNESS
+    }, [this](const StorageNVS::Event & event) {
         if ((event.operation != StorageNVS::Operation::UpdateNVS) || (event.sender == this)) {
             ESP_UTILS_LOGD("Ignore event: operation(%d), sender(%p)", static_cast<int>(event.operation), event.sender);
             return;
@@ -2651,11 +2653,10 @@ bool SettingsManager::processOnWlanUI_Thread()
     auto event_id = is_wifi_event ?
                     static_cast<int>(std::get<wifi_event_t>(wlan_event)) : static_cast<int>(std::get<ip_event_t>(wlan_event));
 
-    auto system = app.getSystem();
-    auto &quick_settings = system->getDisplay().getQuickSettings();
     auto &storage_service = StorageNVS::requestInstance();
     // Use temp variable to avoid `_ui_wlan_available_data` being modified outside lvgl task
     decltype(_ui_wlan_available_data) temp_available_data;
+    SettingsUI_ScreenWlan::WlanData connected_data = {};
 
     // Process non-UI
     if (is_wifi_event) {
@@ -2707,30 +2708,24 @@ bool SettingsManager::processOnWlanUI_Thread()
                 } else if (checkIsWlanGeneralState(WlanGeneraState::_START)) {
                     // Only connect to default AP when WLAN is not connecting or connected
                     // Check if default AP is in scan list
-                    StorageNVS::Value default_connect_ssid;
-                    StorageNVS::Value default_connect_pwd;
+                    // Read the stored AP through a snapshot, which neither locks nor copies the strings
+                    auto params_snapshot = storage_service.getParamsSnapshot();
+                    std::string_view default_connect_ssid_str;
+                    std::string_view default_connect_pwd_str;
                     ESP_UTILS_CHECK_FALSE_RETURN(
-                        storage_service.getLocalParam(Manager::SETTINGS_WLAN_SSID, default_connect_ssid), false,
+                        params_snapshot.getString(Manager::SETTINGS_WLAN_SSID, default_connect_ssid_str), false,
                         "Get default connect SSID failed"
                     );
                     ESP_UTILS_CHECK_FALSE_RETURN(
-                        storage_service.getLocalParam(Manager::SETTINGS_WLAN_PASSWORD, default_connect_pwd), false,
+                        params_snapshot.getString(Manager::SETTINGS_WLAN_PASSWORD, default_connect_pwd_str), false,
                         "Get default connect PWD failed"
                     );
-                    ESP_UTILS_CHECK_FALSE_RETURN(
-                        std::holds_alternative<std::string>(default_connect_ssid), false, "Invalid default connect SSID type"
-                    );
-                    ESP_UTILS_CHECK_FALSE_RETURN(
-                        std::holds_alternative<std::string>(default_connect_pwd), false, "Invalid default connect PWD type"
-                    );
-                    auto &default_connect_ssid_str = std::get<std::string>(default_connect_ssid);
-                    auto &default_connect_pwd_str = std::get<std::string>(default_connect_pwd);
 
                     if ((default_connect_ssid_str.size() > 0) &&
-                            strcmp((const char *)ap_info[i].ssid, default_connect_ssid_str.c_str()) == 0) {
-                        ESP_UTILS_LOGD("Found default AP(%s), try to connect later", default_connect_ssid_str.c_str());
+                            (default_connect_ssid_str == reinterpret_cast<const char *>(ap_info[i].ssid))) {
+                        ESP_UTILS_LOGD("Found default AP(%s), try to connect later", ap_info[i].ssid);
                         _wlan_connecting_info.first = getWlanDataFromApInfo(ap_info[i]);
-                        _wlan_connecting_info.second = default_connect_pwd_str;
+                        _wlan_connecting_info.second = std::string(default_connect_pwd_str);
 
                         if (!ui.checkInitialized() ||
                                 !ui.screen_wlan.checkConnectedVisible() ||
@@ -2758,9 +2753,79 @@ bool SettingsManager::processOnWlanUI_Thread()
         default:
             break;
         }
+    } else {
+        switch (event_id) {
+        case IP_EVENT_STA_GOT_IP: {
+            // Query the driver and start the time sync here, so the LVGL task only updates the UI
+            wifi_ap_record_t ap_info = {};
+            ESP_UTILS_CHECK_FALSE_RETURN(esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK, false, "Get AP info failed");
+            connected_data = getWlanDataFromApInfo(ap_info);
+            ESP_UTILS_LOGI("Connected to AP(%s, %d)", connected_data.ssid.c_str(), connected_data.signal_level);
+            ESP_UTILS_CHECK_FALSE_RETURN(startWlanTimeSync(), false, "Start WLAN time sync failed");
+            break;
+        }
+        default:
+            break;
+        }
     }
 
-    LvLockGuard gui_guard;
+    // Update the UI in the LVGL task, so this thread does not wait for the renderer to release the lock. Products which
+    // do not run the UI task timer get the update under the lock instead
+    if (!LvLock::isUiTaskTimerRunning()) {
+        LvLockGuard gui_guard;
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            processWlanEventOnUI(is_wifi_event, event_id, connected_data), false, "Process WLAN event on UI failed"
+        );
+        return true;
+    }
+    ESP_UTILS_CHECK_FALSE_RETURN(LvLock::runOnUiThread([this, is_wifi_event, event_id, connected_data]() {
+        ESP_UTILS_CHECK_FALSE_EXIT(
+            processWlanEventOnUI(is_wifi_event, event_id, connected_data), "Process WLAN event on UI failed"
+        );
+    }), false, "Run on UI thread failed");
+
+    return true;
+}
+
+bool SettingsManager::startWlanTimeSync()
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    if (app_sntp_is_time_synced()) {
+        ESP_UTILS_LOGD("Time is synchronized");
+        return true;
+    }
+    if (_wlan_time_sync_thread.joinable()) {
+        ESP_UTILS_LOGD("Update time thread is running");
+        return true;
+    }
+
+    esp_utils::thread_config_guard thread_config(esp_utils::ThreadConfig{
+        .name = WLAN_TIME_SYNC_THREAD_NAME,
+        .stack_size = WLAN_TIME_SYNC_THREAD_STACK_SIZE,
+        .stack_in_ext = WLAN_TIME_SYNC_THREAD_STACK_CAPS_EXT,
+    });
+    _wlan_time_sync_thread = boost::thread([this]() {
+        ESP_UTILS_LOGD("Update time start");
+
+        if (!app_sntp_start()) {
+            ESP_UTILS_LOGE("Start SNTP failed, restart the device");
+            esp_restart();
+        }
+
+        ESP_UTILS_LOGD("Update time end");
+    });
+
+    return true;
+}
+
+bool SettingsManager::processWlanEventOnUI(
+    bool is_wifi_event, int event_id, const SettingsUI_ScreenWlan::WlanData &connected_data
+)
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    auto &quick_settings = app.getSystem()->getDisplay().getQuickSettings();
 
     // Process system UI
     if (is_wifi_event) {
@@ -2793,37 +2858,10 @@ bool SettingsManager::processOnWlanUI_Thread()
             ESP_UTILS_CHECK_FALSE_RETURN(
                 toggleWlanScanTimer(_ui_current_screen == UI_Screen::WIRELESS_WLAN, true), false, "Toggle WLAN scan timer failed"
             );
-            wifi_ap_record_t ap_info = {};
-            ESP_UTILS_CHECK_FALSE_RETURN(esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK, false, "Get AP info failed");
-            auto data = getWlanDataFromApInfo(ap_info);
-            ESP_UTILS_LOGI("Connected to AP(%s, %d)", data.ssid.c_str(), data.signal_level);
             ESP_UTILS_CHECK_FALSE_RETURN(
-                quick_settings.setWifiIconState(static_cast<QuickSettings::WifiState>(data.signal_level + 1)), false,
-                "Set WLAN icon state failed"
+                quick_settings.setWifiIconState(static_cast<QuickSettings::WifiState>(connected_data.signal_level + 1)),
+                false, "Set WLAN icon state failed"
             );
-            if (!app_sntp_is_time_synced()) {
-                if (!_wlan_time_sync_thread.joinable()) {
-                    esp_utils::thread_config_guard thread_config(esp_utils::ThreadConfig{
-                        .name = WLAN_TIME_SYNC_THREAD_NAME,
-                        .stack_size = WLAN_TIME_SYNC_THREAD_STACK_SIZE,
-                        .stack_in_ext = WLAN_TIME_SYNC_THREAD_STACK_CAPS_EXT,
-                    });
-                    _wlan_time_sync_thread = boost::thread([this]() {
-                        ESP_UTILS_LOGD("Update time start");
-
-                        if (!app_sntp_start()) {
-                            ESP_UTILS_LOGE("Start SNTP failed, restart the device");
-                            esp_restart();
-                        }
-
-                        ESP_UTILS_LOGD("Update time end");
-                    });
-                } else {
-                    ESP_UTILS_LOGD("Update time thread is running");
-                }
-            } else {
-                ESP_UTILS_LOGD("Time is synchronized");
-            }
             break;
         }
         default:
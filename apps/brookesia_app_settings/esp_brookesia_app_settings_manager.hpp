@@ -243,6 +243,10 @@ private:
     bool waitForWlanScanState(const std::vector<WlanScanState> &state, int timeout_ms);
     bool processOnWlanOperationThread();
     bool processOnWlanUI_Thread();
+    bool startWlanTimeSync();
+    bool processWlanEventOnUI(
+        bool is_wifi_event, int event_id, const SettingsUI_ScreenWlan::WlanData &connected_data
+    );
     bool processOnWlanEventHandler(WlanEvent event, void *event_data);
     bool saveWlanConfig(std::string ssid, std::string pwd);
     bool checkIsWlanGeneralState(WlanGeneraState state)
@@ -3,11 +3,60 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <algorithm>
+#include <vector>
 #include "private/esp_brookesia_ai_expression_utils.hpp"
 #include "esp_brookesia_ai_expression.hpp"
 
 namespace esp_brookesia::ai_framework {
 
+void ExpressionEmotionHistory::use(int type)
+{
+    _recent_types.remove(type);
+    _recent_types.push_front(type);
+    // Halve the counts from time to time, so the emotions used a long time ago fade out
+    if (++_use_counts[type] > USE_COUNT_MAX) {
+        for (auto &[_, count] : _use_counts) {
+            count /= 2;
+        }
+    }
+}
+
+std::vector<int> ExpressionEmotionHistory::predict(int num) const
+{
+    std::vector<int> candidates;
+    if ((num <= 0) || _recent_types.empty()) {
+        return candidates;
+    }
+
+    // The emoji signal often flips back, and a temporary emoji always returns, so the previous emotion comes first
+    auto current = _recent_types.front();
+    if (_recent_types.size() > 1) {
+        candidates.push_back(*std::next(_recent_types.begin()));
+    }
+    std::vector<std::pair<int, uint32_t>> counts(_use_counts.begin(), _use_counts.end());
+    std::stable_sort(counts.begin(), counts.end(), [](const auto &a, const auto &b) {
+        return a.second > b.second;
+    });
+    for (auto &[type, count] : counts) {
+        if (static_cast<int>(candidates.size()) >= num) {
+            break;
+        }
+        if ((type != current) && (count > 0) &&
+                (std::find(candidates.begin(), candidates.end(), type) == candidates.end())) {
+            candidates.push_back(type);
+        }
+    }
+
+    return candidates;
+}
+
+void ExpressionEmotionHistory::clear()
+{
+    _recent_types.clear();
+    _use_counts.clear();
+}
+
 Expression::~Expression()
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
@@ -32,6 +81,21 @@ bool Expression::begin(const ExpressionData &data, const EmojiMap *emoji_map, co
         ESP_UTILS_CHECK_FALSE_EXIT(del(), "Del failed");
     });
 
+    if (data.scheduler.worker_num > 0) {
+        ESP_UTILS_CHECK_EXCEPTION_RETURN(
+            _player_scheduler = std::make_shared<gui::AnimPlayerScheduler>(gui::AnimPlayerScheduler::Config{
+                .name = "expr_anim",
+                .worker_num = data.scheduler.worker_num,
+                .task_priority = data.scheduler.task_priority,
+                .task_stack = data.scheduler.task_stack,
+                .task_stack_in_ext = data.scheduler.task_stack_in_ext,
+                .task_affinity = -1,
+                .enable_pin_core = true,
+            }), false, "Failed to create player scheduler"
+        );
+        ESP_UTILS_CHECK_FALSE_RETURN(_player_scheduler->begin(), false, "Player scheduler begin failed");
+    }
+
     if (data.flags.enable_emotion) {
         auto animation_num = data.emotion.data.getAnimationNum();
         ESP_UTILS_CHECK_FALSE_RETURN(animation_num > 0, false, "Invalid emotion animation num");
@@ -48,9 +112,10 @@ bool Expression::begin(const ExpressionData &data, const EmojiMap *emoji_map, co
         }
 
         _emoji_map = emoji_map_tmp;
+        _emotion_preload_num = std::max(data.emotion.preload_num, 0);
         _emotion_player = std::make_unique<gui::AnimPlayer>();
         ESP_UTILS_CHECK_NULL_RETURN(_emotion_player, false, "Invalid emotion player");
-        ESP_UTILS_CHECK_FALSE_RETURN(_emotion_player->begin(data.emotion.data), false, "Emotion player begin failed");
+        ESP_UTILS_CHECK_FALSE_RETURN(_emotion_player->begin(data.emotion.data, _player_scheduler), false, "Emotion player begin failed");
     }
     if (data.flags.enable_icon) {
         auto animation_num = data.icon.data.getAnimationNum();
@@ -67,7 +132,7 @@ bool Expression::begin(const ExpressionData &data, const EmojiMap *emoji_map, co
         _system_icon_map = system_icon_map_tmp;
         _icon_player = std::make_unique<gui::AnimPlayer>();
         ESP_UTILS_CHECK_NULL_RETURN(_icon_player, false, "Invalid icon player");
-        ESP_UTILS_CHECK_FALSE_RETURN(_icon_player->begin(data.icon.data), false, "Icon player begin failed");
+        ESP_UTILS_CHECK_FALSE_RETURN(_icon_player->begin(data.icon.data, _player_scheduler), false, "Icon player begin failed");
     }
 
     del_guard.release();
@@ -85,10 +150,14 @@ bool Expression::del()
     _flags = {};
     _emotion_player = nullptr;
     _icon_player = nullptr;
+    // Released after the players, which remove themselves from it
+    _player_scheduler = nullptr;
     _emotion_operation_before_pause = gui::AnimPlayer::Operation::PlayOnceStop;
     _icon_operation_before_pause = gui::AnimPlayer::Operation::PlayOnceStop;
     _emotion_type_before_pause = EMOTION_TYPE_NONE;
     _icon_type_before_pause = ICON_TYPE_NONE;
+    _emotion_preload_num = 0;
+    _emotion_history.clear();
 
     return true;
 }
@@ -316,6 +385,7 @@ bool Expression::setEmotion(EmotionType type, gui::AnimPlayer::Operation operati
             .enable_interrupt = immediate,
         },
     }, true), false, "Send emotion event failed");
+    preloadNextEmotions(type);
 
 end:
     _emotion_type_before_pause = type;
@@ -323,6 +393,20 @@ end:
     return true;
 }
 
+void Expression::preloadNextEmotions(EmotionType type)
+{
+    if ((_emotion_preload_num <= 0) || (type == EMOTION_TYPE_NONE)) {
+        return;
+    }
+
+    _emotion_history.use(type);
+    for (auto emotion : _emotion_history.predict(_emotion_preload_num)) {
+        ESP_UTILS_CHECK_FALSE_EXIT(
+            _emotion_player->preloadAnimation(emotion), "Preload emotion %d failed", emotion
+        );
+    }
+}
+
 bool Expression::setIcon(IconType type, gui::AnimPlayer::Operation operation, bool immediate)
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
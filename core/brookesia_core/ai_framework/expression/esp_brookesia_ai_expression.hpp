@@ -5,8 +5,10 @@
  */
 #pragma once
 
+#include <list>
 #include <map>
 #include <string>
+#include <vector>
 #include "boost/thread.hpp"
 #include "gui/anim_player/esp_brookesia_anim_player.hpp"
 
@@ -15,16 +17,47 @@ namespace esp_brookesia::ai_framework {
 struct ExpressionData {
     struct {
         gui::AnimPlayerData data;
+        /**
+         * @brief Number of emotions predicted to be used next (the previous one, then the most used ones) whose
+         *        sources are preloaded after each switch. Keep it below the `cache_num` of the path resources.
+         */
+        int preload_num;
     } emotion;
     struct {
         gui::AnimPlayerData data;
     } icon;
+    /**
+     * @brief Scheduler shared by the emotion and icon players, the i-th worker is pinned to core i. Set `worker_num`
+     *        to 0 to let each player use its own event thread.
+     */
+    struct {
+        int worker_num;
+        int task_priority;
+        int task_stack;
+        bool task_stack_in_ext;
+    } scheduler;
     struct {
         int enable_emotion: 1;
         int enable_icon: 1;
     } flags;
 };
 
+/**
+ * @brief Predicts the emotions used next from the switches, the previous one first, then the most used ones
+ */
+class ExpressionEmotionHistory {
+public:
+    static constexpr uint32_t USE_COUNT_MAX = 64;
+
+    void use(int type);
+    std::vector<int> predict(int num) const;
+    void clear();
+
+private:
+    std::list<int> _recent_types;       // Most recently used first
+    std::map<int, uint32_t> _use_counts;
+};
+
 class Expression {
 public:
     struct AnimOperationConfig {
@@ -72,6 +105,7 @@ public:
 private:
     bool setEmotion(EmotionType type, gui::AnimPlayer::Operation operation, bool immediate);
     bool setIcon(IconType type, gui::AnimPlayer::Operation operation, bool immediate);
+    void preloadNextEmotions(EmotionType type);
     static void emojiTimerCallback(TimerHandle_t timer);
 
     struct {
@@ -90,10 +124,14 @@ private:
     EmotionType _emotion_type_before_pause = EMOTION_TYPE_NONE;
     gui::AnimPlayer::Operation _emotion_operation_before_pause = gui::AnimPlayer::Operation::PlayOnceStop;
     std::unique_ptr<gui::AnimPlayer> _emotion_player;
+    int _emotion_preload_num = 0;
+    ExpressionEmotionHistory _emotion_history;
 
     IconType _icon_type_before_pause = ICON_TYPE_NONE;
     gui::AnimPlayer::Operation _icon_operation_before_pause = gui::AnimPlayer::Operation::PlayOnceStop;
     std::unique_ptr<gui::AnimPlayer> _icon_player;
+
+    std::shared_ptr<gui::AnimPlayerScheduler> _player_scheduler;
 };
 
 } // namespace esp_brookesia::ai_framework
@@ -16,6 +16,7 @@
 /* GUI - lvgl */
 #include "style/esp_brookesia_gui_style.hpp"
 #include "style/esp_brookesia_gui_stylesheet_manager.hpp"
+#include "style/esp_brookesia_gui_stylesheet_diff.hpp"
 #include "gui/lvgl/esp_brookesia_lv_helper.hpp"
 
 /* Services */
@@ -3,30 +3,35 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
-#include <iostream>
-#include <filesystem>
+#include <algorithm>
 #include <vector>
-#include <fstream>
+#include <cstring>
 #include "esp_heap_caps.h"
 #include "esp_brookesia_gui_internal.h"
 #if !ESP_BROOKESIA_ANIM_PLAYER_ENABLE_DEBUG_LOG
 #   define ESP_BROOKESIA_UTILS_DISABLE_DEBUG_LOG
 #endif
 #include "private/esp_brookesia_anim_player_utils.hpp"
+#include "esp_brookesia_anim_player_pixel.hpp"
 #include "esp_brookesia_anim_player.hpp"
 
-#define THREAD_EXIT_CHECK_INTERVAL_MS       100
-
 #define ANIM_EVENT_THREAD_NAME              "anim_event"
 #define ANIM_EVENT_THREAD_STACK_SIZE        (10 * 1024)
 #define ANIM_EVENT_THREAD_STACK_CAPS_EXT    (true)
+#define ANIM_PRELOAD_THREAD_NAME            "anim_preload"
+#define ANIM_PRELOAD_THREAD_STACK_SIZE      (4 * 1024)
+// The files may be read from the SPI flash, which can not be accessed with the stack in PSRAM
+#define ANIM_PRELOAD_THREAD_STACK_CAPS_EXT  (false)
 
-namespace fs = std::filesystem;
+#define ANIM_PIXEL_BYTES                    (2)
+// Rows without change between two changed rows which are still merged into one rectangle
+#define ANIM_DELTA_MERGE_GAP_ROWS           (8)
 
 namespace esp_brookesia::gui {
 
 AnimPlayer::FlushReadySignal AnimPlayer::flush_ready_signal;
 AnimPlayer::AnimationStopSignal AnimPlayer::animation_stop_signal;
+std::atomic<uint32_t> AnimPlayer::_delta_invalidate_count = 0;
 
 AnimPlayer::~AnimPlayer()
 {
@@ -37,7 +42,7 @@ AnimPlayer::~AnimPlayer()
     }
 }
 
-bool AnimPlayer::begin(const AnimPlayerData &data)
+bool AnimPlayer::begin(const AnimPlayerData &data, std::shared_ptr<AnimPlayerScheduler> scheduler)
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
 
@@ -52,6 +57,8 @@ bool AnimPlayer::begin(const AnimPlayerData &data)
         ESP_UTILS_CHECK_FALSE_EXIT(del(), "Failed to delete anim player");
     });
 
+    _shutdown_token.reset();
+
     // Update animation source
     if (std::holds_alternative<AnimPlayerPartitionConfig>(data.source)) {
         ESP_UTILS_LOGD("Enable source partition");
@@ -75,11 +82,49 @@ bool AnimPlayer::begin(const AnimPlayerData &data)
 
             auto &anim_paths = std::get<const AnimPlayerAnimPath *>(resources_config.resources);
             ESP_UTILS_CHECK_FALSE_RETURN(
-                loadAnimationConfig(anim_paths, resources_config.num), false, "Failed to load animation config"
+                loadAnimationConfig(
+                    anim_paths, resources_config.num, resources_config.cache_num, resources_config.enable_mmap
+                ), false, "Failed to load animation config"
             );
         }
     }
 
+    // Swap the bytes while copying the blocks, or in place when they are sent from the decoder buffer
+    _is_swap_bytes = data.flags.enable_data_swap_bytes;
+    _is_frame_drop_enabled = data.flags.enable_frame_drop;
+    if (data.pipeline.buffer_num > 1) {
+        ESP_UTILS_CHECK_FALSE_RETURN(beginPipeline(data), false, "Failed to begin pipeline");
+    }
+    if (data.delta.enable) {
+        ESP_UTILS_CHECK_FALSE_RETURN(beginDelta(data), false, "Failed to begin delta");
+    }
+    // A cache of one source only holds the playing animation, and without a limit all the files are already loaded
+    if (_source_cache_num > 1) {
+        ESP_UTILS_CHECK_FALSE_RETURN(beginPreload(), false, "Failed to begin preload");
+    }
+
+    // The scheduler must be ready before the decoder reports any event, so set it up before the player
+    if (scheduler == nullptr) {
+        ESP_UTILS_LOGD("Create private scheduler");
+
+        ESP_UTILS_CHECK_EXCEPTION_RETURN(
+            scheduler = std::make_shared<AnimPlayerScheduler>(AnimPlayerScheduler::Config{
+                .name = ANIM_EVENT_THREAD_NAME,
+                .worker_num = 1,
+                .task_priority = -1,
+                .task_stack = ANIM_EVENT_THREAD_STACK_SIZE,
+                .task_stack_in_ext = ANIM_EVENT_THREAD_STACK_CAPS_EXT,
+                .task_affinity = (data.pipeline.buffer_num > 1) ? data.pipeline.task_affinity : -1,
+                .enable_pin_core = false,
+            }), false, "Failed to create scheduler"
+        );
+        ESP_UTILS_CHECK_FALSE_RETURN(scheduler->begin(), false, "Failed to begin scheduler");
+    }
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        scheduler->addPlayer(this, data.task.task_priority), false, "Failed to add player to scheduler"
+    );
+    _scheduler = scheduler;
+
     {
         anim_player_config_t config = {
             .flush_cb = [](anim_player_handle_t handle, int x1, int y1, int x2, int y2, const void *data)
@@ -104,7 +149,7 @@ bool AnimPlayer::begin(const AnimPlayerData &data)
                 int x_end = std::min(x_start + width, canvas_config.coord_x + canvas_config.width);
                 int y_end = std::min(y_start + height, canvas_config.coord_y + canvas_config.height);
 
-                flush_ready_signal(x_start, y_start, x_end, y_end, data, self);
+                self->onFlush(x_start, y_start, x_end, y_end, data, (y2 >= canvas_config.height));
             },
             .update_cb = [](anim_player_handle_t handle, player_event_t event)
             {
@@ -119,6 +164,10 @@ bool AnimPlayer::begin(const AnimPlayerData &data)
                 auto *self = static_cast<AnimPlayer *>(anim_player_get_user_data(handle));
                 ESP_UTILS_CHECK_NULL_EXIT(self, "Invalid user data");
 
+                // Let the scheduler continue the event which is waiting for this state
+                esp_utils::function_guard schedule_guard([self]() {
+                    self->_scheduler->schedule(self);
+                });
                 std::unique_lock<std::mutex> lock(self->_player_mutex);
 
                 if (event == PLAYER_EVENT_ALL_FRAME_DONE) {
@@ -132,7 +181,12 @@ bool AnimPlayer::begin(const AnimPlayerData &data)
                     if (event_wrapper->event.operation == Operation::PlayOnceStop) {
                         ESP_UTILS_LOGD("Animation play once stop: %d", event_wrapper->event.index);
 
-                        if (self->_event_queue.empty() && !self->_player_flags.is_starting) {
+                        bool is_queue_empty = false;
+                        {
+                            std::lock_guard event_lock(self->_event_mutex);
+                            is_queue_empty = self->_event_queue.empty();
+                        }
+                        if (is_queue_empty && !self->_player_flags.is_starting) {
                             self->sendEvent({-1, Operation::Stop, {true, true}}, false);
                         } else {
                             if (event_wrapper->promise != nullptr) {
@@ -155,12 +209,10 @@ bool AnimPlayer::begin(const AnimPlayerData &data)
                         event_wrapper.reset();
                     }
                 }
-
-                self->_player_condition.notify_all();
             },
             .user_data = this,
             .flags = {
-                .swap = static_cast<unsigned char>(data.flags.enable_data_swap_bytes),
+                .swap = 0,
             },
             .task = {
                 .task_priority = data.task.task_priority,
@@ -175,48 +227,10 @@ bool AnimPlayer::begin(const AnimPlayerData &data)
         ESP_UTILS_CHECK_NULL_RETURN(_player_handle, false, "Failed to create anim player");
     }
 
-    _event_thread_need_exit = false;
-    {
-        esp_utils::thread_config_guard thread_config(esp_utils::ThreadConfig{
-            .name = ANIM_EVENT_THREAD_NAME,
-            .stack_size = ANIM_EVENT_THREAD_STACK_SIZE,
-            .stack_in_ext = ANIM_EVENT_THREAD_STACK_CAPS_EXT,
-        });
-        _event_thread = boost::thread([this] {
-            ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
-
-            while (!_event_thread_need_exit)
-            {
-                std::unique_lock<std::mutex> lock(_event_mutex);
-                while (_event_queue.empty() && !_event_thread_need_exit) {
-                    _event_cv.wait_for(lock, std::chrono::milliseconds(THREAD_EXIT_CHECK_INTERVAL_MS));
-                }
-                if (_event_thread_need_exit) {
-                    ESP_UTILS_LOGD("Event thread not running, exit");
-                    break;
-                }
-
-                while (!_event_queue.empty() && !_event_thread_need_exit) {
-                    auto event_wrapper = _event_queue.front();
-                    _event_queue.pop();
-
-                    lock.unlock();
-                    if (!processEvent(event_wrapper)) {
-                        ESP_UTILS_LOGE("Failed to process event");
-                    }
-                    lock.lock();
-                }
-                if (_event_thread_need_exit) {
-                    ESP_UTILS_LOGD("Event thread not running, exit");
-                    break;
-                }
-            }
-        });
-    }
-
     del_guard.release();
     _is_begun = true;
     _canvas_config = data.canvas;
+    resetFrameStats();
 
     return true;
 }
@@ -225,19 +239,29 @@ bool AnimPlayer::del()
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
 
-    {
-        std::lock_guard lock(_event_mutex);
-        _event_thread_need_exit = true;
-        _event_cv.notify_all();
+    // Wake up the decoder waiting for a buffer, and stop the scheduler from running the work of the player
+    _shutdown_token.request();
+    if (_scheduler != nullptr) {
+        _scheduler->removePlayer(this);
     }
-    if (_event_thread.joinable()) {
-        _event_thread.join();
+    if (_preload_thread.joinable()) {
+        _preload_thread.join();
     }
 
     if (_player_handle != nullptr) {
         anim_player_deinit(_player_handle);
         _player_handle = nullptr;
     }
+    // Released after the decoder is stopped, since it schedules the player from its callbacks
+    _scheduler.reset();
+    _flushing_block = nullptr;
+    _pipeline.reset();
+    _delta.reset();
+    _is_swap_bytes = false;
+    _is_frame_drop_enabled = false;
+    _processing_event.reset();
+    _event_step = EventStep::None;
+    _current_event.reset();
 
     if (_assets_handle != nullptr) {
         mmap_assets_del(_assets_handle);
@@ -245,7 +269,10 @@ bool AnimPlayer::del()
     }
 
     _animation_configs.clear();
-    _animation_data.clear();
+    _animation_sources.clear();
+    _loaded_sources.clear();
+    _source_cache_num = 0;
+    _preload_indexes.clear();
     _is_begun = false;
 
     return true;
@@ -260,7 +287,7 @@ bool AnimPlayer::sendEvent(const Event &event, bool clear_queue, EventFuture *fu
         event.flags.force
     );
 
-    std::lock_guard lock(_event_mutex);
+    std::unique_lock lock(_event_mutex);
     if (clear_queue) {
         while (!_event_queue.empty()) {
             auto event_wrapper = _event_queue.front();
@@ -282,16 +309,19 @@ bool AnimPlayer::sendEvent(const Event &event, bool clear_queue, EventFuture *fu
 
     std::shared_ptr<EventWrapper> event_wrapper = nullptr;
     ESP_UTILS_CHECK_EXCEPTION_RETURN(
-        event_wrapper = std::make_shared<EventWrapper>(EventWrapper{event, promise}), false,
+        event_wrapper = std::make_shared<EventWrapper>(EventWrapper{event, promise, Clock::now()}), false,
         "Failed to create event wrapper"
     );
 
     _event_queue.emplace(event_wrapper);
-    _event_cv.notify_all();
-
     if (future != nullptr) {
         *future = promise->get_future();
     }
+    lock.unlock();
+
+    if (_scheduler != nullptr) {
+        _scheduler->schedule(this);
+    }
 
     return true;
 }
@@ -302,11 +332,46 @@ bool AnimPlayer::notifyFlushFinished() const
 
     ESP_UTILS_CHECK_NULL_RETURN(_player_handle, false, "Invalid handle");
 
-    anim_player_flush_ready(_player_handle);
+    {
+        std::lock_guard lock(_flush_mutex);
+        ESP_UTILS_CHECK_NULL_RETURN(_flushing_block, false, "No block is being flushed");
+
+        // Called from the signal, let `emitFlushRects()` continue with the next rectangle instead of recursing
+        if (_is_emitting_rect) {
+            _is_rect_done = true;
+            return true;
+        }
+    }
+
+    if (advanceFlushRect()) {
+        emitFlushRects();
+    }
 
     return true;
 }
 
+void AnimPlayer::invalidateDeltaFrames()
+{
+    _delta_invalidate_count++;
+}
+
+AnimPlayer::FrameStats AnimPlayer::getFrameStats() const
+{
+    std::lock_guard lock(_frame_stats_mutex);
+
+    return _frame_stats;
+}
+
+void AnimPlayer::resetFrameStats()
+{
+    std::lock_guard lock(_frame_stats_mutex);
+
+    _frame_stats = {};
+    _frame_decode_us = 0;
+    _frame_flush_us = 0;
+    _is_start_pending = false;
+}
+
 bool AnimPlayer::loadAnimationConfig(const AnimPlayerPartitionConfig &partition_config)
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
@@ -354,172 +419,824 @@ bool AnimPlayer::loadAnimationConfig(const AnimPlayerAnimAddress *anim_address,
     return true;
 }
 
-bool AnimPlayer::loadAnimationConfig(const AnimPlayerAnimPath *anim_path, int num)
+bool AnimPlayer::loadAnimationConfig(const AnimPlayerAnimPath *anim_path, int num, int cache_num, bool enable_mmap)
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
 
-    _animation_data.clear();
+    ESP_UTILS_LOGD("Param: num(%d), cache_num(%d), enable_mmap(%d)", num, cache_num, enable_mmap);
+
+    _animation_configs.clear();
+    _animation_sources.clear();
+    _loaded_sources.clear();
+    _source_cache_num = std::max(cache_num, 0);
     for (int i = 0; i < num; i++) {
-        ESP_UTILS_CHECK_FALSE_RETURN(fs::exists(anim_path[i].path), false, "File not exists: %s", anim_path[i].path);
+        ESP_UTILS_LOGD("Load animation %d: %s, fps(%d)", i, anim_path[i].path, anim_path[i].fps);
 
-        std::ifstream file(anim_path[i].path, std::ios::binary);
-        ESP_UTILS_CHECK_FALSE_RETURN(file.is_open(), false, "Failed to open file: %s", anim_path[i].path);
+        std::unique_ptr<AnimPlayerFileSource> source;
+        ESP_UTILS_CHECK_EXCEPTION_RETURN(
+            source = std::make_unique<AnimPlayerFileSource>(anim_path[i].path, enable_mmap), false,
+            "Failed to create source"
+        );
+        ESP_UTILS_CHECK_FALSE_RETURN(source->open(), false, "Failed to open source: %s", anim_path[i].path);
 
-        ESP_UTILS_LOGD("Load animation %d: %s, fps(%d)", i, anim_path[i].path, anim_path[i].fps);
-        _animation_data.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        _animation_sources.emplace_back(std::move(source));
         _animation_configs.emplace_back(AnimPlayerAnimAddress{
-            .data_address = _animation_data.back().data(),
-            .data_length = _animation_data.back().size(),
+            .data_address = nullptr,
+            .data_length = _animation_sources.back()->getSize(),
             .fps = anim_path[i].fps,
         });
     }
 
+    // Without a cache limit, keep the previous behavior and bring all the files into memory now
+    if (_source_cache_num == 0) {
+        for (int i = 0; i < num; i++) {
+            ESP_UTILS_CHECK_FALSE_RETURN(prepareAnimation(i), false, "Failed to prepare animation %d", i);
+        }
+    }
+
     return true;
 }
 
-bool AnimPlayer::waitPlayerFrameDone()
+bool AnimPlayer::prepareAnimation(int index)
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
 
-    std::unique_lock<std::mutex> lock(_player_mutex);
-    _player_flags.is_frame_done = false;
-    while (!_event_thread_need_exit && !_player_flags.is_frame_done && (_player_state != OperationState::Stop)) {
-        _player_condition.wait_for(lock, std::chrono::milliseconds(THREAD_EXIT_CHECK_INTERVAL_MS));
+    if (_animation_sources.empty()) {
+        return true;
+    }
+
+    std::unique_lock lock(_source_mutex);
+    // Wait for the preload of the same file instead of reading it again
+    _source_cv.wait(lock, [this, index]() {
+        return _loading_index != index;
+    });
+
+    auto &source = _animation_sources[index];
+    if (!source->isLoaded()) {
+        ESP_UTILS_CHECK_FALSE_RETURN(reserveSourceCache(index), false, "Failed to reserve source cache");
+        ESP_UTILS_CHECK_FALSE_RETURN(source->load(), false, "Failed to load source: %s", source->getPath().c_str());
+        _animation_configs[index].data_address = source->getData();
+        _animation_configs[index].data_length = source->getSize();
+    } else {
+        _loaded_sources.remove(index);
     }
+    _loaded_sources.push_front(index);
 
     return true;
 }
 
-bool AnimPlayer::waitPlayerIdle()
+bool AnimPlayer::reserveSourceCache(int playing_index)
 {
-    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+    // The file being preloaded takes a place in the cache as well
+    auto get_used_num = [this]() {
+        return static_cast<int>(_loaded_sources.size()) + ((_loading_index != INDEX_NONE) ? 1 : 0);
+    };
+
+    // The file used by the decoder is never evicted, it is the target of the event or the playing one of a preload
+    while ((_source_cache_num > 0) && (get_used_num() >= _source_cache_num)) {
+        auto it = std::find_if(_loaded_sources.rbegin(), _loaded_sources.rend(), [playing_index](int i) {
+            return i != playing_index;
+        });
+        if (it == _loaded_sources.rend()) {
+            ESP_UTILS_LOGD("No source can be evicted");
+            return false;
+        }
+        auto evict_index = *it;
+        _loaded_sources.erase(std::next(it).base());
 
-    std::unique_lock<std::mutex> lock(_player_mutex);
-    while (!_event_thread_need_exit && (_player_state != OperationState::Stop) && (_player_state != OperationState::Pause)) {
-        _player_condition.wait_for(lock, std::chrono::milliseconds(THREAD_EXIT_CHECK_INTERVAL_MS));
+        ESP_UTILS_LOGD("Unload animation %d: %s", evict_index, _animation_sources[evict_index]->getPath().c_str());
+        _animation_sources[evict_index]->unload();
+        _animation_configs[evict_index].data_address = nullptr;
     }
 
     return true;
 }
 
-bool AnimPlayer::waitPlayerState(OperationState state)
+int AnimPlayer::getPlayingIndex()
+{
+    std::lock_guard lock(_player_mutex);
+
+    return (_current_event != nullptr) ? _current_event->event.index : INDEX_NONE;
+}
+
+bool AnimPlayer::preloadAnimation(int index)
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
 
-    ESP_UTILS_LOGD("Param: state(%d)", static_cast<int>(state));
+    ESP_UTILS_LOGD("Param: index(%d)", index);
+
+    ESP_UTILS_CHECK_FALSE_RETURN(_is_begun, false, "Not begun");
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        (index >= 0) && (index < static_cast<int>(_animation_configs.size())), false, "Invalid index: %d", index
+    );
 
-    if (_player_state & state) {
-        ESP_UTILS_LOGD("Already meet target state");
+    // The partition and the address resources are always in memory, and so are the files without a cache limit
+    if (!_preload_thread.joinable()) {
         return true;
     }
 
-    std::unique_lock<std::mutex> lock(_player_mutex);
-    while (!_event_thread_need_exit && !(_player_state & state)) {
-        _player_condition.wait_for(lock, std::chrono::milliseconds(THREAD_EXIT_CHECK_INTERVAL_MS));
-        ESP_UTILS_LOGD("Not meet target state, current state: %d", static_cast<int>(_player_state));
+    {
+        std::lock_guard lock(_preload_mutex);
+        if (std::find(_preload_indexes.begin(), _preload_indexes.end(), index) == _preload_indexes.end()) {
+            _preload_indexes.push_back(index);
+        }
     }
+    _preload_cv.notify_one();
 
     return true;
 }
 
-bool AnimPlayer::processEvent(std::shared_ptr<EventWrapper> event_wrapper)
+bool AnimPlayer::beginPreload()
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
 
-    ESP_UTILS_CHECK_NULL_RETURN(event_wrapper, false, "Invalid event wrapper");
+    _shutdown_token.attach(_preload_mutex, _preload_cv);
 
-    auto &event = event_wrapper->event;
-    ESP_UTILS_LOGD(
-        "Param: event(%d,%d,%d,%d)", event.index, static_cast<int>(event.operation), event.flags.enable_interrupt,
-        event.flags.force
+    esp_utils::thread_config_guard thread_config(esp_utils::ThreadConfig{
+        .name = ANIM_PRELOAD_THREAD_NAME,
+        .stack_size = ANIM_PRELOAD_THREAD_STACK_SIZE,
+        .stack_in_ext = ANIM_PRELOAD_THREAD_STACK_CAPS_EXT,
+    });
+    ESP_UTILS_CHECK_EXCEPTION_RETURN(
+        _preload_thread = boost::thread([this]() {
+            ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+            runPreload();
+        }), false, "Failed to create preload thread"
     );
 
-    if (!event.flags.force && (_current_event != nullptr) && (_current_event->event.index == event.index) &&
-            (_current_event->event.operation == event.operation)) {
-        ESP_UTILS_LOGD("Animation already in index & operation");
+    return true;
+}
+
+void AnimPlayer::runPreload()
+{
+    while (true) {
+        int index = INDEX_NONE;
+        {
+            std::unique_lock lock(_preload_mutex);
+            _preload_cv.wait(lock, [this]() {
+                return _shutdown_token.isRequested() || !_preload_indexes.empty();
+            });
+            if (_shutdown_token.isRequested()) {
+                break;
+            }
+            index = _preload_indexes.front();
+            _preload_indexes.erase(_preload_indexes.begin());
+        }
+
+        std::unique_lock lock(_source_mutex);
+        auto &source = _animation_sources[index];
+        if (source->isLoaded()) {
+            // Predicted to be used next, so keep it away from the eviction
+            _loaded_sources.remove(index);
+            _loaded_sources.push_front(index);
+            continue;
+        }
+        // Read the playing index under the lock, so a file prepared by the scheduler meanwhile is never evicted
+        if (!reserveSourceCache(getPlayingIndex())) {
+            ESP_UTILS_LOGD("Skip preloading animation %d", index);
+            continue;
+        }
+
+        // Read the file without the lock, so the scheduler can still switch to the sources in memory
+        _loading_index = index;
+        lock.unlock();
+        bool is_loaded = source->load();
+        lock.lock();
+        _loading_index = INDEX_NONE;
+        if (is_loaded) {
+            _animation_configs[index].data_address = source->getData();
+            _animation_configs[index].data_length = source->getSize();
+            _loaded_sources.push_front(index);
+            ESP_UTILS_LOGD("Preloaded animation %d", index);
+        } else {
+            ESP_UTILS_LOGE("Failed to preload animation %d", index);
+        }
+        _source_cv.notify_all();
+    }
+}
+
+size_t AnimPlayer::getLoadedSourceSize() const
+{
+    std::lock_guard lock(_source_mutex);
+
+    size_t size = 0;
+    for (auto index : _loaded_sources) {
+        auto &source = _animation_sources[index];
+        if (!source->isMapped()) {
+            size += source->getSize();
+        }
+    }
+
+    return size;
+}
+
+bool AnimPlayer::beginPipeline(const AnimPlayerData &data)
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    ESP_UTILS_LOGD("Param: buffer_num(%d)", data.pipeline.buffer_num);
+
+    ESP_UTILS_CHECK_EXCEPTION_RETURN(
+        _pipeline = std::make_unique<Pipeline>(), false, "Failed to create pipeline"
+    );
+    // The buffers grow to the size of the largest block on demand
+    _pipeline->buffers.resize(data.pipeline.buffer_num);
+    for (size_t i = 0; i < _pipeline->buffers.size(); i++) {
+        _pipeline->free_buffers.push(i);
+    }
+    _shutdown_token.attach(_pipeline->mutex, _pipeline->cv);
+
+    return true;
+}
+
+bool AnimPlayer::isPipelineIdle()
+{
+    if (_pipeline == nullptr) {
         return true;
     }
 
-    {
-        _player_flags.is_starting = true;
-        esp_utils::function_guard end_guard([this]() {
-            ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
-            _player_flags.is_starting = false;
+    std::lock_guard lock(_pipeline->mutex);
+
+    return _pipeline->ready_buffers.empty() && !_pipeline->is_flushing;
+}
+
+bool AnimPlayer::beginDelta(const AnimPlayerData &data)
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    ESP_UTILS_LOGD("Param: max_rect_num(%d)", data.delta.max_rect_num);
+
+    ESP_UTILS_CHECK_FALSE_RETURN(data.delta.max_rect_num > 0, false, "Invalid max rect num");
+
+    ESP_UTILS_CHECK_EXCEPTION_RETURN(
+        _delta = std::make_unique<Delta>(), false, "Failed to create delta"
+    );
+    ESP_UTILS_CHECK_EXCEPTION_RETURN(
+        _delta->frame.resize(static_cast<size_t>(data.canvas.width) * data.canvas.height), false,
+        "Failed to create delta frame"
+    );
+    _delta->is_row_valid.resize(data.canvas.height, false);
+    _delta->row_ranges.resize(data.canvas.height);
+    _delta->max_rect_num = data.delta.max_rect_num;
+    _delta->invalidate_count = _delta_invalidate_count;
+
+    return true;
+}
+
+void AnimPlayer::onFlush(int x_start, int y_start, int x_end, int y_end, const void *data, bool is_frame_end)
+{
+    uint32_t frame_decode_us = recordBlockDecoded(is_frame_end);
+
+    if (checkFrameDrop(is_frame_end)) {
+        // The frame can not be flushed in its slot anymore, so let the decoder continue with the next one
+        {
+            std::lock_guard lock(_frame_stats_mutex);
+            _decode_start_time = Clock::now();
+        }
+        anim_player_flush_ready(_player_handle);
+        return;
+    }
+
+    FlushBlock *block = &_direct_block;
+    size_t index = 0;
+    if (_pipeline != nullptr) {
+        std::unique_lock lock(_pipeline->mutex);
+        if (_pipeline->free_buffers.empty()) {
+            std::lock_guard stats_lock(_frame_stats_mutex);
+            _frame_stats.stall_count++;
+        }
+        _pipeline->cv.wait(lock, [this]() {
+            return _shutdown_token.isRequested() || !_pipeline->free_buffers.empty();
         });
+        if (_shutdown_token.isRequested()) {
+            lock.unlock();
+            anim_player_flush_ready(_player_handle);
+            return;
+        }
+        index = _pipeline->free_buffers.front();
+        _pipeline->free_buffers.pop();
+        block = &_pipeline->buffers[index];
+    }
 
-        if (_current_event != nullptr) {
-            if (!event.flags.enable_interrupt) {
-                ESP_UTILS_LOGD("Do not enable interrupt, wait player frame done");
-                ESP_UTILS_CHECK_FALSE_RETURN(waitPlayerFrameDone(), false, "Failed to wait player frame done");
-                if (_event_thread_need_exit) {
-                    ESP_UTILS_LOGD("Event thread need exit, return true");
-                    return true;
-                }
+    block->is_frame_end = is_frame_end;
+    block->frame_decode_us = frame_decode_us;
+    prepareFlushBlock(*block, x_start, y_start, x_end, y_end, static_cast<const uint8_t *>(data));
+
+    if (block->rects.empty()) {
+        // Nothing changed since the previous frame, the decoder can continue right away
+        recordBlockFlushed(0, *block);
+        if (_pipeline != nullptr) {
+            std::lock_guard lock(_pipeline->mutex);
+            _pipeline->free_buffers.push(index);
+        }
+    } else if (_pipeline == nullptr) {
+        beginFlushBlock(block);
+        emitFlushRects();
+        return;
+    } else {
+        {
+            std::lock_guard lock(_pipeline->mutex);
+            _pipeline->ready_buffers.push(index);
+        }
+        // The block should be flushed before the next frame is due
+        auto deadline = Clock::now() + std::chrono::microseconds(_frame_period_us.load());
+        _scheduler->schedule(this, deadline);
+    }
+
+    {
+        std::lock_guard lock(_frame_stats_mutex);
+        _decode_start_time = Clock::now();
+    }
+    anim_player_flush_ready(_player_handle);
+}
+
+void AnimPlayer::prepareFlushBlock(
+    FlushBlock &block, int x_start, int y_start, int x_end, int y_end, const uint8_t *data
+)
+{
+    size_t stride = static_cast<size_t>(x_end - x_start) * ANIM_PIXEL_BYTES;
+    size_t decoded_pixels = static_cast<size_t>(x_end - x_start) * (y_end - y_start);
+
+    block.rects.clear();
+    block.rect_index = 0;
+    if (_delta == nullptr) {
+        block.rects.push_back({x_start, y_start, x_end, y_end, 0});
+    } else {
+        findDirtyRects(x_start, y_start, x_end, y_end, reinterpret_cast<const uint16_t *>(data), block.rects);
+    }
+
+    size_t size = 0;
+    bool is_full_width = true;
+    for (auto &rect : block.rects) {
+        size += static_cast<size_t>(rect.x_end - rect.x_start) * (rect.y_end - rect.y_start) * ANIM_PIXEL_BYTES;
+        is_full_width = is_full_width && (rect.x_start == x_start) && (rect.x_end == x_end);
+    }
+    {
+        std::lock_guard lock(_frame_stats_mutex);
+        _frame_stats.decoded_pixel_count += decoded_pixels;
+        _frame_stats.flushed_pixel_count += size / ANIM_PIXEL_BYTES;
+        if (block.rects.empty()) {
+            _frame_stats.skipped_block_count++;
+        }
+    }
+
+    // The rows of a full width rectangle are contiguous, so send them from the decoder buffer if it stays valid. The
+    // decoder does not read the buffer back, so the bytes can be swapped in it, as its own swap did
+    if ((_pipeline == nullptr) && is_full_width) {
+        for (auto &rect : block.rects) {
+            rect.offset = (rect.y_start - y_start) * stride;
+            if (_is_swap_bytes) {
+                auto pixels = reinterpret_cast<uint16_t *>(const_cast<uint8_t *>(data) + rect.offset);
+                AnimPlayerPixel::swapRGB565(
+                    pixels, pixels, static_cast<size_t>(rect.x_end - rect.x_start) * (rect.y_end - rect.y_start)
+                );
             }
+        }
+        block.data = data;
+        return;
+    }
 
-            ESP_UTILS_LOGD("Update current event[%d] to stop", _current_event->event.index);
-            anim_player_update(_player_handle, PLAYER_ACTION_STOP);
+    // Otherwise copy the rectangles, so the decoder can reuse its buffer for the next block right away
+    block.buffer.resize(size);
+    size_t offset = 0;
+    auto copy_pixels = [this](uint8_t *dst, const uint8_t *src, size_t size) {
+        if (_is_swap_bytes) {
+            AnimPlayerPixel::swapRGB565(
+                reinterpret_cast<uint16_t *>(dst), reinterpret_cast<const uint16_t *>(src), size / ANIM_PIXEL_BYTES
+            );
+        } else {
+            memcpy(dst, src, size);
+        }
+    };
+    for (auto &rect : block.rects) {
+        size_t rect_stride = static_cast<size_t>(rect.x_end - rect.x_start) * ANIM_PIXEL_BYTES;
+        const uint8_t *src = data + (rect.y_start - y_start) * stride + (rect.x_start - x_start) * ANIM_PIXEL_BYTES;
+
+        rect.offset = offset;
+        if (rect_stride == stride) {
+            copy_pixels(block.buffer.data() + offset, src, rect_stride * (rect.y_end - rect.y_start));
+            offset += rect_stride * (rect.y_end - rect.y_start);
+            continue;
+        }
+        for (int y = rect.y_start; y < rect.y_end; y++) {
+            copy_pixels(block.buffer.data() + offset, src, rect_stride);
+            src += stride;
+            offset += rect_stride;
+        }
+    }
+    block.data = block.buffer.data();
+}
 
-            ESP_UTILS_LOGD("Wait player idle");
-            ESP_UTILS_CHECK_FALSE_RETURN(waitPlayerIdle(), false, "Failed to wait player idle");
-            if (_event_thread_need_exit) {
-                ESP_UTILS_LOGD("Event thread need exit, return true");
-                return true;
+void AnimPlayer::findDirtyRects(
+    int x_start, int y_start, int x_end, int y_end, const uint16_t *data, std::vector<FlushRect> &rects
+)
+{
+    auto &delta = *_delta;
+    int canvas_width = _canvas_config.width;
+    int width = x_end - x_start;
+    int canvas_x = x_start - _canvas_config.coord_x;
+    int canvas_y = y_start - _canvas_config.coord_y;
+
+    // Only called by the decoder task, which may be in the middle of a frame, so invalidate the rows one by one
+    uint32_t invalidate_count = _delta_invalidate_count;
+    if (delta.need_invalidate.exchange(false) || (delta.invalidate_count != invalidate_count)) {
+        delta.invalidate_count = invalidate_count;
+        std::fill(delta.is_row_valid.begin(), delta.is_row_valid.end(), false);
+    }
+
+    // Compare each row with the previous frame and keep the range of the changed pixels
+    for (int y = 0; y < y_end - y_start; y++) {
+        const uint16_t *src = data + static_cast<size_t>(y) * width;
+        uint16_t *dst = delta.frame.data() + static_cast<size_t>(canvas_y + y) * canvas_width + canvas_x;
+        auto &range = delta.row_ranges[canvas_y + y];
+
+        range = {0, width};
+        if (delta.is_row_valid[canvas_y + y]) {
+            while ((range.first < width) && (src[range.first] == dst[range.first])) {
+                range.first++;
             }
+            while ((range.second > range.first) && (src[range.second - 1] == dst[range.second - 1])) {
+                range.second--;
+            }
+        }
+        if (range.first < range.second) {
+            memcpy(dst + range.first, src + range.first, (range.second - range.first) * ANIM_PIXEL_BYTES);
         }
+        delta.is_row_valid[canvas_y + y] = true;
+    }
 
-        // Then update animation
-        auto index = event.index;
-        switch (event.operation) {
-        case Operation::PlayLoop:
-        case Operation::PlayOnceStop:
-        case Operation::PlayOncePause: {
-            _current_event = event_wrapper;
+    // Merge the changed rows into rectangles, close rows are merged since each rectangle has a fixed cost
+    FlushRect bounds = {x_end, y_end, x_start, y_start, 0};
+    int last_y = -ANIM_DELTA_MERGE_GAP_ROWS - 1;
+    for (int y = 0; y < y_end - y_start; y++) {
+        auto &range = delta.row_ranges[canvas_y + y];
+        if (range.first >= range.second) {
+            continue;
+        }
 
-            ESP_UTILS_CHECK_FALSE_RETURN(
-                (index >= 0) && (index < static_cast<int>(_animation_configs.size())), false, "Invalid index: %d", index
-            );
+        int x1 = x_start + range.first;
+        int x2 = x_start + range.second;
+        if (rects.empty() || ((y - last_y - 1) > ANIM_DELTA_MERGE_GAP_ROWS)) {
+            rects.push_back({x1, y_start + y, x2, y_start + y + 1, 0});
+        } else {
+            auto &rect = rects.back();
+            rect.x_start = std::min(rect.x_start, x1);
+            rect.x_end = std::max(rect.x_end, x2);
+            rect.y_end = y_start + y + 1;
+        }
+        bounds.x_start = std::min(bounds.x_start, x1);
+        bounds.y_start = std::min(bounds.y_start, y_start + y);
+        bounds.x_end = std::max(bounds.x_end, x2);
+        bounds.y_end = y_start + y + 1;
+        last_y = y;
+    }
+
+    if (static_cast<int>(rects.size()) > delta.max_rect_num) {
+        rects.assign(1, bounds);
+    }
+}
 
-            auto &config = _animation_configs[index];
-            uint32_t start = 0;
-            uint32_t end = 0;
-            bool is_repeat = (event.operation == Operation::PlayLoop);
+void AnimPlayer::runPipelineFlush()
+{
+    if (_pipeline == nullptr) {
+        return;
+    }
 
-            ESP_UTILS_LOGD("Animation[%d] set src data start", index);
-            ESP_UTILS_CHECK_ERROR_RETURN(
-                anim_player_set_src_data(_player_handle, config.data_address, config.data_length), false,
-                "Failed to set src data"
-            );
-            ESP_UTILS_LOGD("Animation[%d] set src data end", index);
+    std::unique_lock lock(_pipeline->mutex);
+    // Only one block is handed out at a time, `notifyFlushFinished()` returns it and schedules the next one
+    if (_pipeline->is_flushing || _pipeline->ready_buffers.empty()) {
+        return;
+    }
 
-            _player_state = OperationState::Play;
-            anim_player_get_segment(_player_handle, &start, &end);
-            anim_player_set_segment(_player_handle, start, end, config.fps, is_repeat);
-            anim_player_update(_player_handle, PLAYER_ACTION_START);
-            ESP_UTILS_LOGI(
-                "Update animation: %d, start(%d), end(%d), fps(%d), is_repeat(%d)", index,
-                static_cast<int>(start), static_cast<int>(end), config.fps, is_repeat
-            );
-            break;
+    auto index = _pipeline->ready_buffers.front();
+    _pipeline->ready_buffers.pop();
+    _pipeline->flushing_buffer = index;
+    _pipeline->is_flushing = true;
+    auto block = &_pipeline->buffers[index];
+    lock.unlock();
+
+    beginFlushBlock(block);
+    emitFlushRects();
+}
+
+void AnimPlayer::beginFlushBlock(FlushBlock *block) const
+{
+    std::lock_guard lock(_flush_mutex);
+
+    _flushing_block = block;
+    _flush_start_time = Clock::now();
+}
+
+void AnimPlayer::emitFlushRects() const
+{
+    std::unique_lock lock(_flush_mutex);
+    while (true) {
+        auto block = _flushing_block;
+        auto &rect = block->rects[block->rect_index];
+        _is_emitting_rect = true;
+        _is_rect_done = false;
+        lock.unlock();
+
+        if (block->rect_index == 0) {
+            recordBlockFlushStart();
         }
-        case Operation::Pause: {
-            break;
+        flush_ready_signal(
+            rect.x_start, rect.y_start, rect.x_end, rect.y_end, block->data + rect.offset,
+            const_cast<AnimPlayer *>(this)
+        );
+
+        lock.lock();
+        _is_emitting_rect = false;
+        // Not finished yet, the later `notifyFlushFinished()` continues with the next rectangle
+        if (!_is_rect_done) {
+            return;
         }
-        case Operation::Stop:
-            animation_stop_signal(
-                _canvas_config.coord_x, _canvas_config.coord_y, _canvas_config.coord_x + _canvas_config.width,
-                _canvas_config.coord_y + _canvas_config.height, this
+        lock.unlock();
+
+        if (!advanceFlushRect()) {
+            return;
+        }
+        lock.lock();
+    }
+}
+
+bool AnimPlayer::advanceFlushRect() const
+{
+    std::unique_lock lock(_flush_mutex);
+
+    auto block = _flushing_block;
+    if (++block->rect_index < block->rects.size()) {
+        return true;
+    }
+
+    uint32_t flush_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                            Clock::now() - _flush_start_time
+                        ).count();
+    _flushing_block = nullptr;
+    lock.unlock();
+
+    finishFlushBlock(*block, flush_us);
+
+    return false;
+}
+
+void AnimPlayer::finishFlushBlock(const FlushBlock &block, uint32_t flush_us) const
+{
+    recordBlockFlushed(flush_us, block);
+
+    if (_pipeline != nullptr) {
+        {
+            std::lock_guard lock(_pipeline->mutex);
+            _pipeline->free_buffers.push(_pipeline->flushing_buffer);
+            _pipeline->is_flushing = false;
+            _pipeline->cv.notify_all();
+        }
+        // Flush the next ready block, or continue the event which waits for the pipeline to be idle
+        _scheduler->schedule(const_cast<AnimPlayer *>(this));
+        return;
+    }
+
+    {
+        std::lock_guard lock(_frame_stats_mutex);
+        _decode_start_time = Clock::now();
+    }
+    anim_player_flush_ready(_player_handle);
+}
+
+uint32_t AnimPlayer::recordBlockDecoded(bool is_frame_end)
+{
+    std::lock_guard lock(_frame_stats_mutex);
+
+    _frame_decode_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                            Clock::now() - _decode_start_time
+                        ).count();
+    uint32_t frame_decode_us = _frame_decode_us;
+    if (is_frame_end) {
+        _frame_decode_us = 0;
+    }
+
+    return frame_decode_us;
+}
+
+void AnimPlayer::recordBlockFlushStart() const
+{
+    std::lock_guard lock(_frame_stats_mutex);
+
+    if (!_is_start_pending) {
+        return;
+    }
+    _is_start_pending = false;
+
+    uint32_t latency_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                              Clock::now() - _start_request_time
+                          ).count();
+    _frame_stats.last_start_latency_us = latency_us;
+    _frame_stats.max_start_latency_us = std::max(_frame_stats.max_start_latency_us, latency_us);
+}
+
+bool AnimPlayer::checkFrameDrop(bool is_frame_end)
+{
+    std::lock_guard lock(_frame_stats_mutex);
+
+    auto now = Clock::now();
+    // Slots start from the first block of the animation, so the time to set it up does not count
+    if (!_is_pacing_started) {
+        _is_pacing_started = true;
+        _pacing_start_time = now;
+    }
+    if (_is_frame_begin) {
+        auto period = std::chrono::microseconds(_frame_period_us.load());
+        auto slot_end = _pacing_start_time + period * (_pacing_frame_index + 1);
+        _is_dropping_frame = _is_frame_drop_enabled && (period.count() > 0) && (now > slot_end);
+    }
+    _is_frame_begin = is_frame_end;
+
+    bool is_dropping = _is_dropping_frame;
+    if (is_frame_end) {
+        _pacing_frame_index++;
+        if (is_dropping) {
+            _frame_stats.dropped_frame_count++;
+        }
+    }
+
+    return is_dropping;
+}
+
+void AnimPlayer::recordBlockFlushed(uint32_t flush_us, const FlushBlock &block) const
+{
+    std::lock_guard lock(_frame_stats_mutex);
+
+    _frame_flush_us += flush_us;
+    if (!block.is_frame_end) {
+        return;
+    }
+
+    auto &stats = _frame_stats;
+    uint32_t frame_decode_us = block.frame_decode_us;
+    auto now = Clock::now();
+    auto period = std::chrono::microseconds(_frame_period_us.load());
+    if (_is_pacing_started && (period.count() > 0)) {
+        if (_pacing_flushed_count > 0) {
+            auto interval = now - _last_frame_flushed_time;
+            uint32_t jitter_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                     (interval > period) ? (interval - period) : (period - interval)
+                                 ).count();
+            stats.last_jitter_us = jitter_us;
+            stats.max_jitter_us = std::max(stats.max_jitter_us, jitter_us);
+        }
+        uint64_t elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                  now - _pacing_start_time
+                              ).count();
+        _pacing_flushed_count++;
+        _last_frame_flushed_time = now;
+        stats.achieved_fps = (elapsed_us > 0) ? (_pacing_flushed_count * 1000000.0f / elapsed_us) : 0;
+    }
+    stats.frame_count++;
+    stats.last = {
+        .decode_us = frame_decode_us,
+        .flush_us = _frame_flush_us,
+    };
+    stats.max.decode_us = std::max(stats.max.decode_us, frame_decode_us);
+    stats.max.flush_us = std::max(stats.max.flush_us, _frame_flush_us);
+    stats.total_decode_us += frame_decode_us;
+    stats.total_flush_us += _frame_flush_us;
+    _frame_flush_us = 0;
+}
+
+void AnimPlayer::ShutdownToken::attach(std::mutex &mutex, std::condition_variable &cv)
+{
+    _waiters.emplace_back(&mutex, &cv);
+}
+
+void AnimPlayer::ShutdownToken::request()
+{
+    _is_requested = true;
+    // Notify with the mutex held, so a thread which has just checked the token can not miss the wake-up
+    for (auto &[mutex, cv] : _waiters) {
+        std::lock_guard lock(*mutex);
+        cv->notify_all();
+    }
+}
+
+void AnimPlayer::ShutdownToken::reset()
+{
+    _is_requested = false;
+    _waiters.clear();
+}
+
+void AnimPlayer::setPlayerStarting(bool is_starting)
+{
+    std::lock_guard lock(_player_mutex);
+    _player_flags.is_starting = is_starting;
+}
+
+bool AnimPlayer::isPlayerFrameDone()
+{
+    std::lock_guard lock(_player_mutex);
+
+    return _player_flags.is_frame_done || (_player_state == OperationState::Stop);
+}
+
+bool AnimPlayer::isPlayerIdle()
+{
+    std::lock_guard lock(_player_mutex);
+
+    return (_player_state == OperationState::Stop) || (_player_state == OperationState::Pause);
+}
+
+void AnimPlayer::runScheduledWork()
+{
+    if (_shutdown_token.isRequested()) {
+        return;
+    }
+
+    if (!processEvents()) {
+        ESP_UTILS_LOGE("Failed to process events");
+    }
+    runPipelineFlush();
+}
+
+bool AnimPlayer::processEvents()
+{
+    while (true) {
+        if (_processing_event == nullptr) {
+            {
+                std::lock_guard lock(_event_mutex);
+                if (_event_queue.empty()) {
+                    return true;
+                }
+                _processing_event = _event_queue.front();
+                _event_queue.pop();
+            }
+
+            auto &event = _processing_event->event;
+            ESP_UTILS_LOGD(
+                "Process event(%d,%d,%d,%d)", event.index, static_cast<int>(event.operation),
+                event.flags.enable_interrupt, event.flags.force
             );
-            if (_current_event != nullptr) {
-                // In this case, the current event type is PlayOnceStop, so we need to send value to the current event
-                if (_current_event->promise != nullptr) {
-                    _current_event->promise->set_value();
+
+            bool has_current_event = false;
+            {
+                std::lock_guard lock(_player_mutex);
+                if (!event.flags.force && (_current_event != nullptr) && (_current_event->event.index == event.index) &&
+                        (_current_event->event.operation == event.operation)) {
+                    ESP_UTILS_LOGD("Animation already in index & operation");
+                    _processing_event.reset();
+                    continue;
                 }
-                _current_event.reset();
+                has_current_event = (_current_event != nullptr);
+                _player_flags.is_starting = true;
+                _player_flags.is_frame_done = false;
+            }
+
+            if (!has_current_event) {
+                _event_step = EventStep::WaitPipelineIdle;
+            } else if (!event.flags.enable_interrupt) {
+                ESP_UTILS_LOGD("Do not enable interrupt, wait player frame done");
+                _event_step = EventStep::WaitFrameDone;
+            } else {
+                _event_step = EventStep::StopPlayer;
+            }
+        }
+
+        // Each waiting step returns, the player is scheduled again when the decoder or the pipeline changes
+        switch (_event_step) {
+        case EventStep::WaitFrameDone:
+            if (!isPlayerFrameDone()) {
+                return true;
+            }
+            _event_step = EventStep::StopPlayer;
+            [[fallthrough]];
+        case EventStep::StopPlayer:
+            ESP_UTILS_LOGD("Update current event to stop");
+            anim_player_update(_player_handle, PLAYER_ACTION_STOP);
+            _event_step = EventStep::WaitPlayerIdle;
+            [[fallthrough]];
+        case EventStep::WaitPlayerIdle:
+            if (!isPlayerIdle()) {
+                return true;
+            }
+            _event_step = EventStep::WaitPipelineIdle;
+            [[fallthrough]];
+        case EventStep::WaitPipelineIdle:
+            // The blocks decoded before the stop are still in the pipeline, flush them before switching
+            if (!isPipelineIdle()) {
+                return true;
             }
+            _event_step = EventStep::Apply;
+            [[fallthrough]];
+        case EventStep::Apply: {
+            auto event_wrapper = std::move(_processing_event);
+            _event_step = EventStep::None;
+            esp_utils::function_guard end_guard([this]() {
+                setPlayerStarting(false);
+            });
+            ESP_UTILS_CHECK_FALSE_RETURN(applyEvent(event_wrapper), false, "Failed to apply event");
             break;
+        }
         default:
-            ESP_UTILS_CHECK_FALSE_RETURN(false, false, "Invalid operation: %d", static_cast<int>(event.operation));
+            ESP_UTILS_CHECK_FALSE_RETURN(false, false, "Invalid event step: %d", static_cast<int>(_event_step));
             break;
         }
     }
@@ -527,4 +1244,93 @@ bool AnimPlayer::processEvent(std::shared_ptr<EventWrapper> event_wrapper)
     return true;
 }
 
+bool AnimPlayer::applyEvent(std::shared_ptr<EventWrapper> event_wrapper)
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    ESP_UTILS_CHECK_NULL_RETURN(event_wrapper, false, "Invalid event wrapper");
+
+    auto &event = event_wrapper->event;
+    auto index = event.index;
+    switch (event.operation) {
+    case Operation::PlayLoop:
+    case Operation::PlayOnceStop:
+    case Operation::PlayOncePause: {
+        {
+            std::lock_guard lock(_player_mutex);
+            _current_event = event_wrapper;
+        }
+
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            (index >= 0) && (index < static_cast<int>(_animation_configs.size())), false, "Invalid index: %d", index
+        );
+
+        ESP_UTILS_CHECK_FALSE_RETURN(prepareAnimation(index), false, "Failed to prepare animation %d", index);
+
+        auto &config = _animation_configs[index];
+        uint32_t start = 0;
+        uint32_t end = 0;
+        bool is_repeat = (event.operation == Operation::PlayLoop);
+
+        ESP_UTILS_LOGD("Animation[%d] set src data start", index);
+        ESP_UTILS_CHECK_ERROR_RETURN(
+            anim_player_set_src_data(_player_handle, config.data_address, config.data_length), false,
+            "Failed to set src data"
+        );
+        ESP_UTILS_LOGD("Animation[%d] set src data end", index);
+
+        {
+            std::lock_guard lock(_player_mutex);
+            _player_state = OperationState::Play;
+        }
+        anim_player_get_segment(_player_handle, &start, &end);
+        anim_player_set_segment(_player_handle, start, end, config.fps, is_repeat);
+        _frame_period_us = (config.fps > 0) ? (1000000 / config.fps) : 0;
+        {
+            std::lock_guard lock(_frame_stats_mutex);
+            _decode_start_time = Clock::now();
+            _frame_decode_us = 0;
+            _start_request_time = event_wrapper->send_time;
+            _is_start_pending = true;
+            _is_pacing_started = false;
+            _is_dropping_frame = false;
+            _is_frame_begin = true;
+            _pacing_frame_index = 0;
+            _pacing_flushed_count = 0;
+        }
+        anim_player_update(_player_handle, PLAYER_ACTION_START);
+        ESP_UTILS_LOGI(
+            "Update animation: %d, start(%d), end(%d), fps(%d), is_repeat(%d)", index,
+            static_cast<int>(start), static_cast<int>(end), config.fps, is_repeat
+        );
+        break;
+    }
+    case Operation::Pause: {
+        break;
+    }
+    case Operation::Stop:
+        // The area is cleared by the receivers of the signal
+        if (_delta != nullptr) {
+            _delta->need_invalidate = true;
+        }
+        animation_stop_signal(
+            _canvas_config.coord_x, _canvas_config.coord_y, _canvas_config.coord_x + _canvas_config.width,
+            _canvas_config.coord_y + _canvas_config.height, this
+        );
+        if (std::lock_guard lock(_player_mutex); _current_event != nullptr) {
+            // In this case, the current event type is PlayOnceStop, so we need to send value to the current event
+            if (_current_event->promise != nullptr) {
+                _current_event->promise->set_value();
+            }
+            _current_event.reset();
+        }
+        break;
+    default:
+        ESP_UTILS_CHECK_FALSE_RETURN(false, false, "Invalid operation: %d", static_cast<int>(event.operation));
+        break;
+    }
+
+    return true;
+}
+
 } // namespace esp_brookesia::gui
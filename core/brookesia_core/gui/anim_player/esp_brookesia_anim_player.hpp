@@ -6,8 +6,11 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <future>
+#include <list>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <variant>
@@ -16,6 +19,8 @@
 #include "boost/thread.hpp"
 #include "esp_mmap_assets.h"
 #include "anim_player.h"
+#include "esp_brookesia_anim_player_source.hpp"
+#include "esp_brookesia_anim_player_scheduler.hpp"
 
 namespace esp_brookesia::gui {
 
@@ -40,6 +45,12 @@ struct AnimPlayerAnimPath {
 struct AnimPlayerResourcesConfig {
     int num;
     std::variant<const AnimPlayerAnimAddress *, const AnimPlayerAnimPath *> resources;
+    /**
+     * Only for the path resources, the files are loaded on demand and at most `cache_num` of them are kept in
+     * memory. Use `0` to load all the files in `begin()`.
+     */
+    int cache_num;
+    bool enable_mmap;   /*!< Only for the path resources, map the files instead of reading them if possible */
 };
 
 struct AnimPlayerPartitionConfig {
@@ -62,14 +73,35 @@ struct AnimPlayerData {
 
     AnimPlayerCanvasConfig canvas;
     std::variant<AnimPlayerResourcesConfig, AnimPlayerPartitionConfig> source;
+    /**
+     * @brief Task of the decoder, `task_priority` is also the priority of the player in the scheduler
+     */
     struct {
         int task_priority;
         int task_stack;
         int task_affinity;
         bool task_stack_in_ext;
     } task;
+    /**
+     * @brief Flush pipeline, the decoder copies each block into a free buffer and continues with the next one while
+     *        the previous block is being flushed. Set `buffer_num` to 2 or more to enable it.
+     */
+    struct {
+        int buffer_num;
+        int task_affinity;  /*!< Only for the private scheduler, the core of its worker which flushes the blocks */
+    } pipeline;
+    /**
+     * @brief Delta frames, each block is compared with the previous frame and only the changed rectangles are sent
+     *        to `flush_ready_signal`. A block with more than `max_rect_num` rectangles is sent as their bounding box.
+     */
+    struct {
+        bool enable;
+        int max_rect_num;
+    } delta;
     struct {
         int enable_data_swap_bytes: 1;
+        int enable_frame_drop: 1;   /*!< Keep the frames on their wall-clock slots, and drop the frames which can no
+                                     *   longer be flushed in time instead of running behind the `fps` */
     } flags;
 };
 
@@ -109,6 +141,29 @@ public:
 
     using EventFuture = std::future<void>;
 
+    struct FrameTiming {
+        uint32_t decode_us; /*!< Time spent by the decoder on all the blocks of the frame */
+        uint32_t flush_us;  /*!< Time from `flush_ready_signal` to `notifyFlushFinished()` for all the blocks */
+    };
+
+    struct FrameStats {
+        size_t frame_count;
+        size_t stall_count;         /*!< Times the decoder waited for a free pipeline buffer */
+        FrameTiming last;
+        FrameTiming max;
+        uint64_t total_decode_us;
+        uint64_t total_flush_us;
+        uint32_t last_start_latency_us; /*!< Time from `sendEvent()` to the first flushed block of the animation */
+        uint32_t max_start_latency_us;
+        uint64_t decoded_pixel_count;
+        uint64_t flushed_pixel_count;   /*!< Less than the decoded pixels if the delta frames are enabled */
+        size_t skipped_block_count;     /*!< Blocks without any change since the previous frame */
+        size_t dropped_frame_count;     /*!< Frames not flushed since they missed their slot */
+        float achieved_fps;             /*!< Flushed frames per second since the animation started */
+        uint32_t last_jitter_us;        /*!< Difference between the interval of two flushed frames and the period */
+        uint32_t max_jitter_us;
+    };
+
     using FlushReadySignal = boost::signals2::signal <
                              void(int x_start, int y_start, int x_end, int y_end, const void *data, AnimPlayer *player)
                              >;
@@ -125,42 +180,187 @@ public:
     AnimPlayer(const AnimPlayer &) = delete;
     AnimPlayer &operator=(const AnimPlayer &) = delete;
 
-    bool begin(const AnimPlayerData &data);
+    /**
+     * @brief Begin the player
+     *
+     * @param data Configuration of the player
+     * @param scheduler Scheduler shared with other players to handle the events and flush the blocks. If it is
+     *                  `nullptr`, the player creates a private scheduler with a single worker
+     */
+    bool begin(const AnimPlayerData &data, std::shared_ptr<AnimPlayerScheduler> scheduler = nullptr);
     bool del();
 
     bool sendEvent(const Event &event, bool clear_queue, EventFuture *future = nullptr);
 
+    /**
+     * @brief Called by the receiver of `flush_ready_signal` once the rectangle is flushed, from the signal or later
+     */
     bool notifyFlushFinished() const;
 
+    FrameStats getFrameStats() const;
+    void resetFrameStats();
+
+    size_t getLoadedSourceSize() const;
+
+    /**
+     * @brief Load the source of an animation in the background, so a later switch to it does not wait for the file.
+     *        Only for the path resources with a `cache_num` above 1, the least recently used source which is not
+     *        playing may be evicted. The files are read by a thread of the player, not by the scheduler workers.
+     */
+    bool preloadAnimation(int index);
+
+    bool isPipelineEnabled() const
+    {
+        return (_pipeline != nullptr);
+    }
+
+    std::shared_ptr<AnimPlayerScheduler> getScheduler() const
+    {
+        return _scheduler;
+    }
+
+    bool isDeltaEnabled() const
+    {
+        return (_delta != nullptr);
+    }
+
+    /**
+     * @brief Flush the next frame of all the players completely, call it when the content of the screen is changed by
+     *        others (e.g. cleared or redrawn by LVGL)
+     */
+    static void invalidateDeltaFrames();
+
     static FlushReadySignal flush_ready_signal;
     static AnimationStopSignal animation_stop_signal;
 
 private:
+    friend class AnimPlayerScheduler;
+
     using EventPromise = std::promise<void>;
+    using Clock = std::chrono::steady_clock;
     struct EventWrapper {
         Event event;
         std::shared_ptr<EventPromise> promise;
+        Clock::time_point send_time;
+    };
+    /**
+     * @brief Steps of the event being processed, each step returns to the scheduler until its condition is met
+     */
+    enum class EventStep {
+        None,
+        WaitFrameDone,
+        StopPlayer,
+        WaitPlayerIdle,
+        WaitPipelineIdle,
+        Apply,
+    };
+    /**
+     * @brief Explicit shutdown request, every wait of the player threads is woken up when it is requested
+     */
+    class ShutdownToken {
+    public:
+        void attach(std::mutex &mutex, std::condition_variable &cv);
+        void request();
+        void reset();
+
+        bool isRequested() const
+        {
+            return _is_requested;
+        }
+
+    private:
+        std::atomic<bool> _is_requested = false;
+        std::vector<std::pair<std::mutex *, std::condition_variable *>> _waiters;
+    };
+    struct FlushRect {
+        int x_start;
+        int y_start;
+        int x_end;
+        int y_end;
+        size_t offset;      // Offset of the pixels in `FlushBlock::data`
+    };
+    struct FlushBlock {
+        std::vector<uint8_t> buffer;    // Copy of the rectangles, unused if they can be sent from the decoder buffer
+        const uint8_t *data = nullptr;
+        std::vector<FlushRect> rects;
+        size_t rect_index = 0;
+        bool is_frame_end = false;
+        uint32_t frame_decode_us = 0;
+    };
+    struct Delta {
+        std::vector<uint16_t> frame;            // Pixels of the canvas which have been sent
+        std::vector<uint8_t> is_row_valid;
+        std::vector<std::pair<int, int>> row_ranges;
+        int max_rect_num = 0;
+        uint32_t invalidate_count = 0;
+        std::atomic<bool> need_invalidate = true;
+    };
+    struct Pipeline {
+        std::vector<FlushBlock> buffers;
+        std::queue<size_t> free_buffers;
+        std::queue<size_t> ready_buffers;
+        size_t flushing_buffer = 0;
+        bool is_flushing = false;
+        std::mutex mutex;
+        std::condition_variable cv;
     };
 
     bool loadAnimationConfig(const AnimPlayerPartitionConfig &partition_config);
     bool loadAnimationConfig(const AnimPlayerAnimAddress *anim_address, int num);
-    bool loadAnimationConfig(const AnimPlayerAnimPath *anim_path, int num);
-    bool waitPlayerFrameDone();
-    bool waitPlayerIdle();
-    bool waitPlayerState(OperationState state);
-    bool processEvent(std::shared_ptr<EventWrapper> event_wrapper);
+    bool loadAnimationConfig(const AnimPlayerAnimPath *anim_path, int num, int cache_num, bool enable_mmap);
+    bool prepareAnimation(int index);
+    bool reserveSourceCache(int playing_index);
+    int getPlayingIndex();
+    bool beginPreload();
+    void runPreload();
+    void setPlayerStarting(bool is_starting);
+    bool isPlayerFrameDone();
+    bool isPlayerIdle();
+    bool isPipelineIdle();
+    void runScheduledWork();
+    bool processEvents();
+    bool applyEvent(std::shared_ptr<EventWrapper> event_wrapper);
+    bool beginPipeline(const AnimPlayerData &data);
+    bool beginDelta(const AnimPlayerData &data);
+    void onFlush(int x_start, int y_start, int x_end, int y_end, const void *data, bool is_frame_end);
+    void prepareFlushBlock(FlushBlock &block, int x_start, int y_start, int x_end, int y_end, const uint8_t *data);
+    void findDirtyRects(
+        int x_start, int y_start, int x_end, int y_end, const uint16_t *data, std::vector<FlushRect> &rects
+    );
+    void runPipelineFlush();
+    void beginFlushBlock(FlushBlock *block) const;
+    void emitFlushRects() const;
+    bool advanceFlushRect() const;
+    void finishFlushBlock(const FlushBlock &block, uint32_t flush_us) const;
+    uint32_t recordBlockDecoded(bool is_frame_end);
+    void recordBlockFlushStart() const;
+    bool checkFrameDrop(bool is_frame_end);
+    void recordBlockFlushed(uint32_t flush_us, const FlushBlock &block) const;
 
     bool _is_begun = false;
     AnimPlayerCanvasConfig _canvas_config = {};
     std::vector<AnimPlayerAnimAddress> _animation_configs;
-    std::vector<std::vector<uint8_t>> _animation_data;
+    std::vector<std::unique_ptr<AnimPlayerFileSource>> _animation_sources;
+    std::list<int> _loaded_sources;     // Most recently used first
+    int _source_cache_num = 0;
+    // Guards the loaded sources, which are loaded by the scheduler and by the preload thread
+    mutable std::mutex _source_mutex;
+    std::condition_variable _source_cv;
+    int _loading_index = INDEX_NONE;    // File being read by the preload thread without the lock
+    std::mutex _preload_mutex;
+    std::condition_variable _preload_cv;
+    std::vector<int> _preload_indexes;
+    boost::thread _preload_thread;
 
-    std::atomic<bool> _event_thread_need_exit = false;
-    boost::thread _event_thread;
+    ShutdownToken _shutdown_token;
+    std::shared_ptr<AnimPlayerScheduler> _scheduler;
     std::queue<std::shared_ptr<EventWrapper>> _event_queue;
     std::shared_ptr<EventWrapper> _current_event;
     std::mutex _event_mutex;
-    std::condition_variable _event_cv;
+    // Only accessed by the scheduler, which never runs the work of a player on two workers at the same time
+    std::shared_ptr<EventWrapper> _processing_event;
+    EventStep _event_step = EventStep::None;
+    std::atomic<uint32_t> _frame_period_us = 0;
 
     std::mutex _player_mutex;
     struct {
@@ -168,9 +368,37 @@ private:
         int is_frame_done: 1;
     } _player_flags;
     OperationState _player_state = OperationState::Stop;
-    std::condition_variable _player_condition;
     anim_player_handle_t _player_handle = nullptr;
     mmap_assets_handle_t _assets_handle = nullptr;
+
+    std::unique_ptr<Pipeline> _pipeline;
+    std::unique_ptr<Delta> _delta;
+    bool _is_swap_bytes = false;
+    FlushBlock _direct_block;
+    // State of the block being sent to `flush_ready_signal`, the rectangles are sent one by one
+    mutable std::mutex _flush_mutex;
+    mutable FlushBlock *_flushing_block = nullptr;
+    mutable Clock::time_point _flush_start_time;
+    mutable bool _is_emitting_rect = false;
+    mutable bool _is_rect_done = false;
+    static std::atomic<uint32_t> _delta_invalidate_count;
+    // Timing of the blocks, written by the decoder task and the thread which calls `notifyFlushFinished()`
+    mutable std::mutex _frame_stats_mutex;
+    mutable FrameStats _frame_stats = {};
+    mutable Clock::time_point _decode_start_time;
+    mutable uint32_t _frame_decode_us = 0;
+    mutable uint32_t _frame_flush_us = 0;
+    mutable Clock::time_point _start_request_time;
+    mutable bool _is_start_pending = false;
+    // Slots of the frames, the decoder task decides to drop a frame when its first block is decoded
+    bool _is_frame_drop_enabled = false;
+    bool _is_pacing_started = false;
+    bool _is_dropping_frame = false;
+    bool _is_frame_begin = true;
+    uint32_t _pacing_frame_index = 0;
+    Clock::time_point _pacing_start_time;
+    mutable uint32_t _pacing_flushed_count = 0;
+    mutable Clock::time_point _last_frame_flushed_time;
 };
 
 } // namespace esp_brookesia::gui
@@ -0,0 +1,118 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <cstring>
+#include "esp_brookesia_anim_player_pixel.hpp"
+
+// Green, red and blue of a RGB565 pixel spread over 32 bits, with 5 free bits above each of them for the products
+#define PIXEL_RGB565_SPREAD_MASK    (0x07E0F81FU)
+
+namespace esp_brookesia::gui {
+
+static inline uint32_t loadWord(const uint16_t *src)
+{
+    uint32_t word;
+    memcpy(&word, src, sizeof(word));
+    return word;
+}
+
+static inline void storeWord(uint16_t *dst, uint32_t word)
+{
+    memcpy(dst, &word, sizeof(word));
+}
+
+static inline uint16_t swapPixel(uint16_t pixel)
+{
+    return static_cast<uint16_t>((pixel << 8) | (pixel >> 8));
+}
+
+static inline uint32_t swapWord(uint32_t word)
+{
+    return ((word & 0x00FF00FFU) << 8) | ((word >> 8) & 0x00FF00FFU);
+}
+
+static inline uint16_t convertPixel(const uint8_t *src)
+{
+    return static_cast<uint16_t>(((src[2] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[0] >> 3));
+}
+
+static inline uint32_t spreadPixel(uint16_t pixel)
+{
+    return (pixel | (static_cast<uint32_t>(pixel) << 16)) & PIXEL_RGB565_SPREAD_MASK;
+}
+
+static inline uint16_t packPixel(uint32_t spread)
+{
+    spread &= PIXEL_RGB565_SPREAD_MASK;
+    return static_cast<uint16_t>(spread | (spread >> 16));
+}
+
+void AnimPlayerPixel::swapRGB565(uint16_t *dst, const uint16_t *src, size_t num)
+{
+    // Align the destination, so the loop below writes whole words
+    if ((num > 0) && (reinterpret_cast<uintptr_t>(dst) & 0x3)) {
+        *dst++ = swapPixel(*src++);
+        num--;
+    }
+    for (; num >= 8; num -= 8, src += 8, dst += 8) {
+        uint32_t w0 = loadWord(src);
+        uint32_t w1 = loadWord(src + 2);
+        uint32_t w2 = loadWord(src + 4);
+        uint32_t w3 = loadWord(src + 6);
+        storeWord(dst, swapWord(w0));
+        storeWord(dst + 2, swapWord(w1));
+        storeWord(dst + 4, swapWord(w2));
+        storeWord(dst + 6, swapWord(w3));
+    }
+    for (; num >= 2; num -= 2, src += 2, dst += 2) {
+        storeWord(dst, swapWord(loadWord(src)));
+    }
+    if (num > 0) {
+        *dst = swapPixel(*src);
+    }
+}
+
+void AnimPlayerPixel::convertRGB888ToRGB565(uint16_t *dst, const uint8_t *src, size_t num, bool swap)
+{
+    if ((num > 0) && (reinterpret_cast<uintptr_t>(dst) & 0x3)) {
+        uint16_t pixel = convertPixel(src);
+        *dst++ = swap ? swapPixel(pixel) : pixel;
+        src += 3;
+        num--;
+    }
+    for (; num >= 2; num -= 2, src += 6, dst += 2) {
+        uint32_t word = convertPixel(src) | (static_cast<uint32_t>(convertPixel(src + 3)) << 16);
+        storeWord(dst, swap ? swapWord(word) : word);
+    }
+    if (num > 0) {
+        uint16_t pixel = convertPixel(src);
+        *dst = swap ? swapPixel(pixel) : pixel;
+    }
+}
+
+void AnimPlayerPixel::blendRGB565(
+    uint16_t *dst, const uint16_t *src, const uint8_t *alpha, size_t num, uint16_t bg_color, bool swap
+)
+{
+    uint32_t bg = spreadPixel(swap ? swapPixel(bg_color) : bg_color);
+
+    for (size_t i = 0; i < num; i++) {
+        // Reduce the opacity to 5 bits, so the three channels are blended with a single multiplication each
+        uint32_t a = (alpha[i] + 4) >> 3;
+        if (a == 0) {
+            dst[i] = bg_color;
+            continue;
+        }
+
+        uint16_t pixel = swap ? swapPixel(src[i]) : src[i];
+        if (a < 32) {
+            uint32_t fg = spreadPixel(pixel);
+            pixel = packPixel((fg * a + bg * (32 - a)) >> 5);
+        }
+        dst[i] = swap ? swapPixel(pixel) : pixel;
+    }
+}
+
+} // namespace esp_brookesia::gui
@@ -0,0 +1,46 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esp_brookesia::gui {
+
+/**
+ * @brief Pixel kernels used on the flush path of the animations.
+ *
+ *        They work on two pixels per 32-bit word (SWAR), so they run on every target and on the host. `dst` and
+ *        `src` may be the same buffer, and neither needs to be aligned.
+ */
+class AnimPlayerPixel {
+public:
+    /**
+     * @brief Swap the bytes of each RGB565 pixel
+     */
+    static void swapRGB565(uint16_t *dst, const uint16_t *src, size_t num);
+
+    /**
+     * @brief Convert RGB888 pixels to RGB565
+     *
+     * @param src Pixels with the bytes in order B, G, R (same as `LV_COLOR_FORMAT_RGB888`)
+     * @param swap Swap the bytes of the converted pixels
+     */
+    static void convertRGB888ToRGB565(uint16_t *dst, const uint8_t *src, size_t num, bool swap);
+
+    /**
+     * @brief Blend RGB565 pixels over a background color
+     *
+     * @param alpha Opacity of each pixel, 0 is transparent and 255 is opaque
+     * @param bg_color Background color, with the same byte order as `src`
+     * @param swap The bytes of `src` and `bg_color` are swapped
+     */
+    static void blendRGB565(
+        uint16_t *dst, const uint16_t *src, const uint8_t *alpha, size_t num, uint16_t bg_color, bool swap
+    );
+};
+
+} // namespace esp_brookesia::gui
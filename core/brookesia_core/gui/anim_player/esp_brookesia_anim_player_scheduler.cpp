@@ -0,0 +1,280 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <algorithm>
+#include "esp_brookesia_gui_internal.h"
+#if !ESP_BROOKESIA_ANIM_PLAYER_ENABLE_DEBUG_LOG
+#   define ESP_BROOKESIA_UTILS_DISABLE_DEBUG_LOG
+#endif
+#include "private/esp_brookesia_anim_player_utils.hpp"
+#include "esp_brookesia_anim_player.hpp"
+#include "esp_brookesia_anim_player_scheduler.hpp"
+
+namespace esp_brookesia::gui {
+
+AnimPlayerScheduler::AnimPlayerScheduler(const Config &config):
+    _config(config)
+{
+}
+
+AnimPlayerScheduler::~AnimPlayerScheduler()
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    ESP_UTILS_CHECK_FALSE_EXIT(del(), "Failed to delete scheduler");
+}
+
+bool AnimPlayerScheduler::begin()
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    ESP_UTILS_LOGD(
+        "Param: name(%s), worker_num(%d), task_priority(%d), enable_pin_core(%d)", _config.name, _config.worker_num,
+        _config.task_priority, _config.enable_pin_core
+    );
+
+    if (!_workers.empty()) {
+        ESP_UTILS_LOGW("Already begun");
+        return true;
+    }
+    ESP_UTILS_CHECK_FALSE_RETURN(_config.worker_num > 0, false, "Invalid worker num: %d", _config.worker_num);
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        _config.enable_pin_core || (_config.task_affinity < CONFIG_FREERTOS_NUMBER_OF_CORES), false,
+        "Invalid task affinity: %d", _config.task_affinity
+    );
+
+    esp_utils::function_guard del_guard([this] {
+        ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+        ESP_UTILS_CHECK_FALSE_EXIT(del(), "Failed to delete scheduler");
+    });
+
+    {
+        std::lock_guard lock(_mutex);
+        _need_exit = false;
+    }
+    for (int i = 0; i < _config.worker_num; i++) {
+        esp_utils::ThreadConfig thread_config = {
+            .name = _config.name,
+            // More workers than cores are spread over the cores in turn
+            .core_id = _config.enable_pin_core ? (i % CONFIG_FREERTOS_NUMBER_OF_CORES) : _config.task_affinity,
+            .stack_size = static_cast<size_t>(_config.task_stack),
+            .stack_in_ext = _config.task_stack_in_ext,
+        };
+        if (_config.task_priority >= 0) {
+            thread_config.priority = _config.task_priority;
+        }
+        esp_utils::thread_config_guard thread_config_guard(thread_config);
+        ESP_UTILS_CHECK_EXCEPTION_RETURN(
+            _workers.emplace_back([this] {
+                ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+                runWorker();
+            }), false, "Failed to create worker %d", i
+        );
+    }
+
+    del_guard.release();
+
+    return true;
+}
+
+bool AnimPlayerScheduler::del()
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    {
+        std::lock_guard lock(_mutex);
+        _need_exit = true;
+        _cv.notify_all();
+    }
+    for (auto &worker : _workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    _workers.clear();
+
+    std::lock_guard lock(_mutex);
+    _entries.clear();
+
+    return true;
+}
+
+bool AnimPlayerScheduler::addPlayer(AnimPlayer *player, int priority)
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    ESP_UTILS_LOGD("Param: player(%p), priority(%d)", player, priority);
+    ESP_UTILS_CHECK_NULL_RETURN(player, false, "Invalid player");
+
+    std::lock_guard lock(_mutex);
+    ESP_UTILS_CHECK_FALSE_RETURN(findEntry(player) == nullptr, false, "Player already added");
+    ESP_UTILS_CHECK_EXCEPTION_RETURN(
+        _entries.emplace_back(Entry{
+            .player = player,
+            .priority = priority,
+            .is_scheduled = false,
+            .is_running = false,
+            .has_deadline = false,
+            .run_time = {},
+            .deadline = {},
+            .stats = {},
+        }), false, "Failed to add player"
+    );
+
+    return true;
+}
+
+bool AnimPlayerScheduler::removePlayer(AnimPlayer *player)
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    ESP_UTILS_LOGD("Param: player(%p)", player);
+
+    std::unique_lock lock(_mutex);
+    _cv.wait(lock, [this, player]() {
+        auto entry = findEntry(player);
+        return (entry == nullptr) || !entry->is_running;
+    });
+
+    auto it = std::find_if(_entries.begin(), _entries.end(), [player](const Entry & entry) {
+        return entry.player == player;
+    });
+    if (it == _entries.end()) {
+        ESP_UTILS_LOGD("Player not found");
+        return true;
+    }
+    _entries.erase(it);
+
+    return true;
+}
+
+void AnimPlayerScheduler::schedule(AnimPlayer *player)
+{
+    schedule(player, Clock::now(), false);
+}
+
+void AnimPlayerScheduler::schedule(AnimPlayer *player, Clock::time_point deadline)
+{
+    schedule(player, deadline, true);
+}
+
+bool AnimPlayerScheduler::getPlayerStats(const AnimPlayer *player, PlayerStats &stats) const
+{
+    std::lock_guard lock(_mutex);
+    auto entry = findEntry(player);
+    ESP_UTILS_CHECK_NULL_RETURN(entry, false, "Player not found");
+    stats = entry->stats;
+
+    return true;
+}
+
+void AnimPlayerScheduler::resetPlayerStats(const AnimPlayer *player)
+{
+    std::lock_guard lock(_mutex);
+    auto entry = findEntry(player);
+    if (entry != nullptr) {
+        entry->stats = {};
+    }
+}
+
+void AnimPlayerScheduler::schedule(AnimPlayer *player, Clock::time_point run_time, bool has_deadline)
+{
+    std::lock_guard lock(_mutex);
+
+    // Removed players are ignored, the decoder may still report events until it is deinitialized
+    auto entry = findEntry(player);
+    if (entry == nullptr) {
+        return;
+    }
+
+    // Keep the earliest time if the player is already scheduled
+    if (!entry->is_scheduled || (run_time < entry->run_time)) {
+        entry->run_time = run_time;
+    }
+    if (has_deadline && (!entry->has_deadline || (run_time < entry->deadline))) {
+        entry->has_deadline = true;
+        entry->deadline = run_time;
+    }
+    entry->is_scheduled = true;
+    _cv.notify_one();
+}
+
+AnimPlayerScheduler::Entry *AnimPlayerScheduler::findEntry(const AnimPlayer *player)
+{
+    auto it = std::find_if(_entries.begin(), _entries.end(), [player](const Entry & entry) {
+        return entry.player == player;
+    });
+
+    return (it != _entries.end()) ? &(*it) : nullptr;
+}
+
+const AnimPlayerScheduler::Entry *AnimPlayerScheduler::findEntry(const AnimPlayer *player) const
+{
+    return const_cast<AnimPlayerScheduler *>(this)->findEntry(player);
+}
+
+AnimPlayerScheduler::Entry *AnimPlayerScheduler::pickEntry()
+{
+    Entry *picked = nullptr;
+    for (auto &entry : _entries) {
+        // A running player is scheduled again after its current run
+        if (!entry.is_scheduled || entry.is_running) {
+            continue;
+        }
+        if ((picked == nullptr) || (entry.priority > picked->priority) ||
+                ((entry.priority == picked->priority) && (entry.run_time < picked->run_time))) {
+            picked = &entry;
+        }
+    }
+
+    return picked;
+}
+
+void AnimPlayerScheduler::runWorker()
+{
+    std::unique_lock lock(_mutex);
+    while (true) {
+        Entry *entry = nullptr;
+        _cv.wait(lock, [this, &entry]() {
+            return _need_exit || ((entry = pickEntry()) != nullptr);
+        });
+        if (_need_exit) {
+            ESP_UTILS_LOGD("Worker need exit, exit");
+            break;
+        }
+
+        auto now = Clock::now();
+        auto player = entry->player;
+        entry->is_scheduled = false;
+        entry->is_running = true;
+        entry->stats.run_count++;
+        if (entry->has_deadline) {
+            entry->has_deadline = false;
+            if (now > entry->deadline) {
+                uint32_t lateness_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                           now - entry->deadline
+                                       ).count();
+                entry->stats.deadline_miss_count++;
+                entry->stats.max_lateness_us = std::max(entry->stats.max_lateness_us, lateness_us);
+            }
+        }
+
+        lock.unlock();
+        player->runScheduledWork();
+        lock.lock();
+
+        // The entry may have been moved by `addPlayer()`, so look it up again
+        entry = findEntry(player);
+        if (entry != nullptr) {
+            entry->is_running = false;
+        }
+        // Wake up `removePlayer()` and the workers waiting for this player
+        _cv.notify_all();
+    }
+}
+
+} // namespace esp_brookesia::gui
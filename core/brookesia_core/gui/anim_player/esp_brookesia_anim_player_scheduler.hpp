@@ -0,0 +1,103 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "boost/thread.hpp"
+
+namespace esp_brookesia::gui {
+
+class AnimPlayer;
+
+/**
+ * @brief Worker pool which runs the event handling and the flushing of several `AnimPlayer`s.
+ *
+ *        A player schedules itself whenever it has work (a new event, a state change of the decoder or a decoded
+ *        block). A worker picks the scheduled player with the highest priority and then the earliest deadline, and
+ *        the work of one player never runs on two workers at the same time.
+ */
+class AnimPlayerScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Config {
+        const char *name;
+        int worker_num;
+        int task_priority;      /*!< Use `-1` for the default priority of the threads */
+        int task_stack;
+        bool task_stack_in_ext;
+        int task_affinity;      /*!< Core of all the workers, `-1` for none. Ignored if `enable_pin_core` is set */
+        bool enable_pin_core;   /*!< Pin the i-th worker to core `i % CONFIG_FREERTOS_NUMBER_OF_CORES` */
+    };
+
+    struct PlayerStats {
+        size_t run_count;
+        size_t deadline_miss_count;     /*!< Times a block started flushing after the deadline of its frame */
+        uint32_t max_lateness_us;
+    };
+
+    explicit AnimPlayerScheduler(const Config &config);
+    ~AnimPlayerScheduler();
+
+    AnimPlayerScheduler(const AnimPlayerScheduler &) = delete;
+    AnimPlayerScheduler &operator=(const AnimPlayerScheduler &) = delete;
+
+    bool begin();
+    bool del();
+
+    bool addPlayer(AnimPlayer *player, int priority);
+    /**
+     * @brief Remove the player, wait for its running work to finish if needed. Scheduling it has no effect afterwards
+     */
+    bool removePlayer(AnimPlayer *player);
+
+    /**
+     * @brief Run the work of the player as soon as possible
+     */
+    void schedule(AnimPlayer *player);
+    /**
+     * @brief Run the work of the player before `deadline`, a late start is counted as a deadline miss
+     */
+    void schedule(AnimPlayer *player, Clock::time_point deadline);
+
+    bool getPlayerStats(const AnimPlayer *player, PlayerStats &stats) const;
+    void resetPlayerStats(const AnimPlayer *player);
+
+    const Config &getConfig() const
+    {
+        return _config;
+    }
+
+private:
+    struct Entry {
+        AnimPlayer *player;
+        int priority;
+        bool is_scheduled;
+        bool is_running;
+        bool has_deadline;
+        Clock::time_point run_time;
+        Clock::time_point deadline;
+        PlayerStats stats;
+    };
+
+    void schedule(AnimPlayer *player, Clock::time_point run_time, bool has_deadline);
+    Entry *findEntry(const AnimPlayer *player);
+    const Entry *findEntry(const AnimPlayer *player) const;
+    Entry *pickEntry();
+    void runWorker();
+
+    Config _config;
+    bool _need_exit = false;
+    std::vector<boost::thread> _workers;
+    std::vector<Entry> _entries;
+    mutable std::mutex _mutex;
+    std::condition_variable _cv;
+};
+
+} // namespace esp_brookesia::gui
@@ -0,0 +1,143 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <algorithm>
+#include <cstdio>
+#include <sys/stat.h>
+#include "esp_heap_caps.h"
+#include "esp_brookesia_gui_internal.h"
+// The VFS of the chip targets has no `mmap()`, only the host build can map a file
+#if CONFIG_IDF_TARGET_LINUX || !defined(ESP_PLATFORM)
+#   include <sys/mman.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#   define ANIM_SOURCE_MMAP_SUPPORTED   (1)
+#else
+#   define ANIM_SOURCE_MMAP_SUPPORTED   (0)
+#endif
+#if !ESP_BROOKESIA_ANIM_PLAYER_ENABLE_DEBUG_LOG
+#   define ESP_BROOKESIA_UTILS_DISABLE_DEBUG_LOG
+#endif
+#include "private/esp_brookesia_anim_player_utils.hpp"
+#include "esp_brookesia_anim_player_source.hpp"
+
+#define ANIM_SOURCE_BUFFER_CAPS             (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#define ANIM_SOURCE_BUFFER_CAPS_FALLBACK    (MALLOC_CAP_DEFAULT)
+
+namespace esp_brookesia::gui {
+
+AnimPlayerFileSource::AnimPlayerFileSource(const char *path, bool enable_mmap):
+    _path(path),
+    _enable_mmap(enable_mmap)
+{
+}
+
+AnimPlayerFileSource::~AnimPlayerFileSource()
+{
+    unload();
+}
+
+bool AnimPlayerFileSource::open()
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    struct stat file_stat = {};
+    ESP_UTILS_CHECK_FALSE_RETURN(stat(_path.c_str(), &file_stat) == 0, false, "File not exists: %s", _path.c_str());
+    ESP_UTILS_CHECK_FALSE_RETURN(file_stat.st_size > 0, false, "Empty file: %s", _path.c_str());
+    _size = static_cast<size_t>(file_stat.st_size);
+
+    return true;
+}
+
+bool AnimPlayerFileSource::load()
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    if (isLoaded()) {
+        return true;
+    }
+    ESP_UTILS_CHECK_FALSE_RETURN(_size > 0, false, "Not opened: %s", _path.c_str());
+
+    if (_enable_mmap && map()) {
+        ESP_UTILS_LOGD("Mapped file: %s, size(%d)", _path.c_str(), static_cast<int>(_size));
+        return true;
+    }
+    ESP_UTILS_CHECK_FALSE_RETURN(read(), false, "Failed to read file: %s", _path.c_str());
+    ESP_UTILS_LOGD("Read file: %s, size(%d)", _path.c_str(), static_cast<int>(_size));
+
+    return true;
+}
+
+void AnimPlayerFileSource::unload()
+{
+    if (_data == nullptr) {
+        return;
+    }
+
+#if ANIM_SOURCE_MMAP_SUPPORTED
+    if (_is_mapped) {
+        munmap(_data, _size);
+    } else
+#endif
+    {
+        heap_caps_free(_data);
+    }
+    _data = nullptr;
+    _is_mapped = false;
+}
+
+bool AnimPlayerFileSource::map()
+{
+#if ANIM_SOURCE_MMAP_SUPPORTED
+    int fd = ::open(_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    void *data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        // Not supported by the file system, fall back to reading
+        ESP_UTILS_LOGD("Failed to map file: %s", _path.c_str());
+        return false;
+    }
+    _data = static_cast<uint8_t *>(data);
+    _is_mapped = true;
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool AnimPlayerFileSource::read()
+{
+    FILE *file = fopen(_path.c_str(), "rb");
+    ESP_UTILS_CHECK_NULL_RETURN(file, false, "Failed to open file: %s", _path.c_str());
+    esp_utils::function_guard close_guard([file]() {
+        fclose(file);
+    });
+
+    // Prefer PSRAM, but the boards without it should still work as with the internal RAM before
+    auto data = static_cast<uint8_t *>(
+                    heap_caps_malloc_prefer(_size, 2, ANIM_SOURCE_BUFFER_CAPS, ANIM_SOURCE_BUFFER_CAPS_FALLBACK)
+                );
+    ESP_UTILS_CHECK_NULL_RETURN(data, false, "Failed to allocate buffer(%d)", static_cast<int>(_size));
+
+    size_t offset = 0;
+    while (offset < _size) {
+        size_t len = fread(data + offset, 1, std::min(READ_CHUNK_SIZE, _size - offset), file);
+        if (len == 0) {
+            heap_caps_free(data);
+            ESP_UTILS_CHECK_FALSE_RETURN(false, false, "Read file failed at offset(%d)", static_cast<int>(offset));
+        }
+        offset += len;
+    }
+    _data = data;
+    _is_mapped = false;
+
+    return true;
+}
+
+} // namespace esp_brookesia::gui
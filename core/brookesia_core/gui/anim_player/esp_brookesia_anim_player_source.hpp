@@ -0,0 +1,67 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace esp_brookesia::gui {
+
+/**
+ * @brief Animation file which is only brought into memory while it is needed.
+ *
+ *        The decoder needs the whole file while playing, so `load()` either maps the file (if the VFS supports
+ *        `mmap()`) or reads it in chunks into a buffer allocated in PSRAM, or in the internal RAM if there is no
+ *        PSRAM. `unload()` gives the memory back.
+ */
+class AnimPlayerFileSource {
+public:
+    static constexpr size_t READ_CHUNK_SIZE = 16 * 1024;
+
+    AnimPlayerFileSource(const char *path, bool enable_mmap);
+    ~AnimPlayerFileSource();
+
+    AnimPlayerFileSource(const AnimPlayerFileSource &) = delete;
+    AnimPlayerFileSource &operator=(const AnimPlayerFileSource &) = delete;
+
+    bool open();
+    bool load();
+    void unload();
+
+    bool isLoaded() const
+    {
+        return (_data != nullptr);
+    }
+    bool isMapped() const
+    {
+        return _is_mapped;
+    }
+    const void *getData() const
+    {
+        return _data;
+    }
+    size_t getSize() const
+    {
+        return _size;
+    }
+    const std::string &getPath() const
+    {
+        return _path;
+    }
+
+private:
+    bool map();
+    bool read();
+
+    std::string _path;
+    bool _enable_mmap = false;
+    size_t _size = 0;
+    uint8_t *_data = nullptr;
+    bool _is_mapped = false;
+};
+
+} // namespace esp_brookesia::gui
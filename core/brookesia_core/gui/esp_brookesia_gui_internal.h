@@ -109,6 +109,30 @@
 #   endif
 #endif
 
+#if !defined(ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER)
+#   if defined(CONFIG_ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER)
+#       define ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER  CONFIG_ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER
+#   else
+#       define ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER  (0)
+#   endif
+#endif
+#if ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER
+#   if !defined(ESP_BROOKESIA_LVGL_LOCK_PROFILER_RECORD_NUM)
+#       if defined(CONFIG_ESP_BROOKESIA_LVGL_LOCK_PROFILER_RECORD_NUM)
+#           define ESP_BROOKESIA_LVGL_LOCK_PROFILER_RECORD_NUM  CONFIG_ESP_BROOKESIA_LVGL_LOCK_PROFILER_RECORD_NUM
+#       else
+#           define ESP_BROOKESIA_LVGL_LOCK_PROFILER_RECORD_NUM  (256)
+#       endif
+#   endif
+#endif
+#if !defined(ESP_BROOKESIA_LVGL_LOCK_UI_TASK_BATCH_NUM)
+#   if defined(CONFIG_ESP_BROOKESIA_LVGL_LOCK_UI_TASK_BATCH_NUM)
+#       define ESP_BROOKESIA_LVGL_LOCK_UI_TASK_BATCH_NUM  CONFIG_ESP_BROOKESIA_LVGL_LOCK_UI_TASK_BATCH_NUM
+#   else
+#       define ESP_BROOKESIA_LVGL_LOCK_UI_TASK_BATCH_NUM  (0)
+#   endif
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////// Squareline ////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -8,6 +8,7 @@
 #include "esp_brookesia_lv_canvas.hpp"
 #include "esp_brookesia_lv_container.hpp"
 #include "esp_brookesia_lv_display.hpp"
+#include "esp_brookesia_lv_handle.hpp"
 #include "esp_brookesia_lv_helper.hpp"
 #include "esp_brookesia_lv_lock.hpp"
 #include "esp_brookesia_lv_object.hpp"
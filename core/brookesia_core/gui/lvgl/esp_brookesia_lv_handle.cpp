@@ -0,0 +1,87 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include "esp_brookesia_gui_internal.h"
+#include "private/esp_brookesia_lv_utils.hpp"
+#include "esp_brookesia_lv_handle.hpp"
+
+namespace esp_brookesia::gui {
+
+namespace {
+
+struct Slab {
+    Slab *next;
+    LvHandlePool::Node nodes[LvHandlePool::SLAB_NODE_NUM];
+};
+
+// Guards the slabs, the free list and the stats
+std::mutex pool_mutex;
+Slab *slab_list = nullptr;
+LvHandlePool::Node *free_list = nullptr;
+LvHandlePool::Stats pool_stats = {};
+
+} // namespace
+
+LvHandlePool::Node *LvHandlePool::allocate(void *native_handle)
+{
+    std::lock_guard<std::mutex> lock(pool_mutex);
+
+    if (free_list == nullptr) {
+        Slab *slab = new (std::nothrow) Slab;
+        ESP_UTILS_CHECK_NULL_RETURN(slab, nullptr, "Allocate slab failed");
+
+        slab->next = slab_list;
+        slab_list = slab;
+        for (auto &node : slab->nodes) {
+            node.next_free = free_list;
+            free_list = &node;
+        }
+        pool_stats.slab_num++;
+        pool_stats.node_num += SLAB_NODE_NUM;
+    }
+
+    Node *node = free_list;
+    free_list = node->next_free;
+    node->native_handle = native_handle;
+    node->ref_count.store(1, std::memory_order_relaxed);
+
+    pool_stats.used_node_num++;
+    pool_stats.max_used_node_num = std::max(pool_stats.max_used_node_num, pool_stats.used_node_num);
+    pool_stats.alloc_count++;
+
+    return node;
+}
+
+void LvHandlePool::release(Node *node)
+{
+    std::lock_guard<std::mutex> lock(pool_mutex);
+
+    node->next_free = free_list;
+    free_list = node;
+    pool_stats.used_node_num--;
+}
+
+LvHandlePool::Stats LvHandlePool::getStats()
+{
+    std::lock_guard<std::mutex> lock(pool_mutex);
+
+    return pool_stats;
+}
+
+void LvHandlePool::dumpStats()
+{
+    auto stats = getStats();
+    ESP_UTILS_LOGI(
+        "LVGL handle pool: slabs(%d), nodes(%d), used(%d), max used(%d), allocated(%d)",
+        static_cast<int>(stats.slab_num), static_cast<int>(stats.node_num),
+        static_cast<int>(stats.used_node_num), static_cast<int>(stats.max_used_node_num),
+        static_cast<int>(stats.alloc_count)
+    );
+}
+
+} // namespace esp_brookesia::gui
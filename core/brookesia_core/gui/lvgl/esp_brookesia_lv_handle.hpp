@@ -0,0 +1,169 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace esp_brookesia::gui {
+
+/**
+ * @brief Slab allocator of the reference counts used by `LvHandle`.
+ *
+ *        The nodes are allocated in slabs of `SLAB_NODE_NUM` and recycled through a free list, the slabs are never
+ *        freed. So creating and deleting widgets does not allocate from the heap once the slabs are enough.
+ *
+ * @note  The free list is guarded by a mutex, so the handles can be allocated and released in any thread
+ */
+class LvHandlePool {
+public:
+    static constexpr size_t SLAB_NODE_NUM = 32;
+
+    struct Node {
+        union {
+            void *native_handle;
+            Node *next_free;
+        };
+        std::atomic<uint32_t> ref_count;
+    };
+
+    struct Stats {
+        size_t slab_num;
+        size_t node_num;
+        size_t used_node_num;
+        size_t max_used_node_num;
+        size_t alloc_count;         /*!< Nodes allocated since boot, including the recycled ones */
+    };
+
+    static Node *allocate(void *native_handle);
+    static void release(Node *node);
+
+    static Stats getStats();
+    static void dumpStats();
+};
+
+/**
+ * @brief Reference counted handle of a LVGL object, timer or animation. It is used the same way as a `shared_ptr`,
+ *        but the pointer and the atomic reference count share a single node from `LvHandlePool`.
+ *
+ * @note  Same as a `shared_ptr`, the handles can be copied and released in any thread, but the native handle is
+ *        deleted by the thread releasing the last reference, which should hold the LVGL lock
+ *
+ * @tparam Deleter Called with the native handle when the last reference is released
+ */
+template <typename T, typename Deleter>
+class LvHandle {
+public:
+    LvHandle() = default;
+    LvHandle(std::nullptr_t) {}
+    /**
+     * @brief Take the ownership of `native_handle`, it is deleted at once if no node can be allocated
+     */
+    explicit LvHandle(T *native_handle)
+    {
+        if (native_handle == nullptr) {
+            return;
+        }
+        _node = LvHandlePool::allocate(native_handle);
+        if (_node == nullptr) {
+            Deleter()(native_handle);
+        }
+    }
+    ~LvHandle()
+    {
+        reset();
+    }
+
+    LvHandle(const LvHandle &other):
+        _node(other._node)
+    {
+        if (_node != nullptr) {
+            _node->ref_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    LvHandle &operator=(const LvHandle &other)
+    {
+        if (_node != other._node) {
+            LvHandle(other).swap(*this);
+        }
+        return *this;
+    }
+    LvHandle(LvHandle &&other):
+        _node(other._node)
+    {
+        other._node = nullptr;
+    }
+    LvHandle &operator=(LvHandle &&other)
+    {
+        if (this != &other) {
+            LvHandle(static_cast<LvHandle &&>(other)).swap(*this);
+        }
+        return *this;
+    }
+    LvHandle &operator=(std::nullptr_t)
+    {
+        reset();
+        return *this;
+    }
+
+    void reset()
+    {
+        Node *node = _node;
+        _node = nullptr;
+        // The release order makes the last owner see all the writes of the others before deleting
+        if ((node == nullptr) || (node->ref_count.fetch_sub(1, std::memory_order_acq_rel) > 1)) {
+            return;
+        }
+        // Release the node first, the deleter may release other handles
+        T *native_handle = static_cast<T *>(node->native_handle);
+        LvHandlePool::release(node);
+        Deleter()(native_handle);
+    }
+    void swap(LvHandle &other)
+    {
+        Node *node = _node;
+        _node = other._node;
+        other._node = node;
+    }
+
+    T *get() const
+    {
+        return (_node != nullptr) ? static_cast<T *>(_node->native_handle) : nullptr;
+    }
+    T *operator->() const
+    {
+        return get();
+    }
+    T &operator*() const
+    {
+        return *get();
+    }
+    explicit operator bool() const
+    {
+        return (_node != nullptr);
+    }
+    size_t use_count() const
+    {
+        return (_node != nullptr) ? _node->ref_count.load(std::memory_order_relaxed) : 0;
+    }
+
+    friend bool operator==(const LvHandle &a, const LvHandle &b)
+    {
+        return a._node == b._node;
+    }
+    friend bool operator==(const LvHandle &a, std::nullptr_t)
+    {
+        return a._node == nullptr;
+    }
+
+private:
+    using Node = LvHandlePool::Node;
+
+    Node *_node = nullptr;
+};
+
+} // namespace esp_brookesia::gui
@@ -17,11 +17,11 @@
 #   include "src/lv_api_map_v8.h"
 #endif
 #include "style/esp_brookesia_gui_style.hpp"
+#include "esp_brookesia_lv_handle.hpp"
 
 namespace esp_brookesia::gui {
 
-// Smart pointer for LVGL objects with automatic cleanup
-using LvObjSharedPtr = std::shared_ptr<lv_obj_t>;
+// Handle of LVGL objects with automatic cleanup
 struct LvObjDeleter {
     void operator()(lv_obj_t *obj)
     {
@@ -30,18 +30,20 @@ struct LvObjDeleter {
         }
     }
 };
+using LvObjHandle = LvHandle<lv_obj_t, LvObjDeleter>;
+using LvObjSharedPtr = LvObjHandle;
 
-// Smart pointer for LVGL timers with automatic cleanup
-using LvTimerSharedPtr = std::shared_ptr<lv_timer_t>;
+// Handle of LVGL timers with automatic cleanup
 struct LvTimerDeleter {
     void operator()(lv_timer_t *t)
     {
         lv_timer_del(t);
     }
 };
+using LvTimerHandle = LvHandle<lv_timer_t, LvTimerDeleter>;
+using LvTimerSharedPtr = LvTimerHandle;
 
-// Smart pointer for LVGL animations with automatic cleanup
-using LvAnimSharedPtr = std::shared_ptr<lv_anim_t>;
+// Handle of LVGL animations with automatic cleanup
 struct LvAnimDeleter {
     void operator()(lv_anim_t *anim)
     {
@@ -49,6 +51,8 @@ struct LvAnimDeleter {
         delete anim;
     }
 };
+using LvAnimHandle = LvHandle<lv_anim_t, LvAnimDeleter>;
+using LvAnimSharedPtr = LvAnimHandle;
 
 /**
  * @brief Convert GUI types to LVGL types
@@ -73,19 +77,18 @@ lv_anim_path_cb_t getLvAnimPathCb(esp_brookesia::gui::StyleAnimation::AnimationP
 } // namespace esp_brookesia::gui
 
 #define ESP_BROOKESIA_MAKE_LV_OBJ_PTR(type, parent) \
-    esp_brookesia::gui::LvObjSharedPtr(lv_##type##_create(parent), esp_brookesia::gui::LvObjDeleter());
+    esp_brookesia::gui::LvObjHandle(lv_##type##_create(parent));
 #define ESP_BROOKESIA_MAKE_LV_TIMER_PTR(func, t, data) \
-    esp_brookesia::gui::LvTimerSharedPtr(lv_timer_create(func, t, data), esp_brookesia::gui::LvTimerDeleter());
+    esp_brookesia::gui::LvTimerHandle(lv_timer_create(func, t, data));
 #define ESP_BROOKESIA_MAKE_LV_ANIM_PTR() \
-    esp_brookesia::gui::LvAnimSharedPtr( \
+    esp_brookesia::gui::LvAnimHandle( \
         [](){ \
             lv_anim_t *anim = new lv_anim_t; \
             if (anim != nullptr) { \
                 lv_anim_init(anim); \
             } \
             return anim; \
-        }(), \
-        esp_brookesia::gui::LvAnimDeleter() \
+        }() \
     )
 
 /**
@@ -3,6 +3,13 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "esp_brookesia_gui_internal.h"
 #if !ESP_BROOKESIA_LVGL_LOCK_ENABLE_DEBUG_LOG
 #   define ESP_BROOKESIA_UTILS_DISABLE_DEBUG_LOG
@@ -10,8 +17,77 @@
 #include "private/esp_brookesia_lv_utils.hpp"
 #include "esp_brookesia_lv_lock.hpp"
 
+#define PROFILE_THREAD_NAME_SIZE    (16)
+
 namespace esp_brookesia::gui {
 
+namespace {
+
+// Nesting depth of `LvLockForbidGuard` in the current thread
+thread_local int forbid_depth = 0;
+
+} // namespace
+
+#if ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct ProfileRecord {
+    const char *tag;
+    char thread_name[PROFILE_THREAD_NAME_SIZE];
+    uint32_t wait_us;
+    uint32_t hold_us;
+};
+
+/**
+ * @brief Each slot is written by a single thread at a time, its sequence is odd while being written. A reader keeps
+ *        a copy only if the sequence is even and unchanged around the copy.
+ */
+struct ProfileSlot {
+    std::atomic<uint32_t> sequence = 0;
+    ProfileRecord record = {};
+};
+
+ProfileSlot profile_slots[ESP_BROOKESIA_LVGL_LOCK_PROFILER_RECORD_NUM];
+std::atomic<uint32_t> profile_write_index = 0;
+std::atomic<uint32_t> profile_reset_index = 0;
+
+// The lock is recursive, only the outermost lock of each thread is recorded
+thread_local int profile_depth = 0;
+thread_local const char *profile_tag = nullptr;
+thread_local uint32_t profile_wait_us = 0;
+thread_local Clock::time_point profile_acquire_time;
+
+uint32_t elapsedUs(Clock::time_point start, Clock::time_point end)
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+}
+
+void pushProfileRecord(const char *tag, uint32_t wait_us, uint32_t hold_us)
+{
+    uint32_t index = profile_write_index.fetch_add(1, std::memory_order_relaxed);
+    auto &slot = profile_slots[index % ESP_BROOKESIA_LVGL_LOCK_PROFILER_RECORD_NUM];
+
+    slot.sequence.store(index * 2 + 1, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.record.tag = tag;
+    slot.record.wait_us = wait_us;
+    slot.record.hold_us = hold_us;
+    strncpy(slot.record.thread_name, pcTaskGetName(nullptr), PROFILE_THREAD_NAME_SIZE - 1);
+    slot.record.thread_name[PROFILE_THREAD_NAME_SIZE - 1] = '\0';
+    slot.sequence.store(index * 2 + 2, std::memory_order_release);
+}
+
+size_t getBucketIndex(uint32_t time_us)
+{
+    auto &limits = LvLock::PROFILE_BUCKET_LIMITS_US;
+    return std::upper_bound(limits.begin(), limits.end(), time_us) - limits.begin();
+}
+
+} // namespace
+#endif // ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER
+
 LvLock &LvLock::getInstance()
 {
     static LvLock s_instance;
@@ -27,14 +103,56 @@ void LvLock::registerCallbacks(LockCallback lock_cb, UnlockCallback unlock_cb)
     inst.unlock_cb_ = std::move(unlock_cb);
 }
 
-bool LvLock::lock(int timeout_ms)
+bool LvLock::lock(int timeout_ms, const char *tag)
 {
     ESP_UTILS_LOG_TRACE_GUARD();
 
-    ESP_UTILS_LOGD("Param: timeout_ms(%d)", timeout_ms);
+    ESP_UTILS_LOGD("Param: timeout_ms(%d), tag(%s)", timeout_ms, (tag != nullptr) ? tag : "");
 
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        !LvLockForbidGuard::checkForbidden(), false, "Lock is forbidden in this thread, tag(%s)",
+        (tag != nullptr) ? tag : ""
+    );
     ESP_UTILS_CHECK_FALSE_RETURN(lock_cb_.operator bool(), false, "Lock callback not registered");
+#if ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER
+    auto wait_start_time = Clock::now();
+#endif
     ESP_UTILS_CHECK_FALSE_RETURN(lock_cb_(timeout_ms), false, "Lock callback failed");
+#if ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER
+    if (profile_depth++ == 0) {
+        profile_acquire_time = Clock::now();
+        profile_wait_us = elapsedUs(wait_start_time, profile_acquire_time);
+        profile_tag = tag;
+    }
+#endif
+    lock_count_++;
+    ESP_UTILS_LOGD("Locked count: %d", static_cast<int>(lock_count_));
+
+    return true;
+}
+
+bool LvLock::tryLock(const char *tag)
+{
+    ESP_UTILS_LOG_TRACE_GUARD();
+
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        !LvLockForbidGuard::checkForbidden(), false, "Lock is forbidden in this thread, tag(%s)",
+        (tag != nullptr) ? tag : ""
+    );
+    ESP_UTILS_CHECK_FALSE_RETURN(lock_cb_.operator bool(), false, "Lock callback not registered");
+
+    // Not an error if the lock is busy, so the callback is checked here instead of by `lock()`
+    if (!lock_cb_(0)) {
+        ESP_UTILS_LOGD("Lock is busy");
+        return false;
+    }
+#if ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER
+    if (profile_depth++ == 0) {
+        profile_acquire_time = Clock::now();
+        profile_wait_us = 0;
+        profile_tag = tag;
+    }
+#endif
     lock_count_++;
     ESP_UTILS_LOGD("Locked count: %d", static_cast<int>(lock_count_));
 
@@ -46,6 +164,12 @@ bool LvLock::unlock()
     ESP_UTILS_LOG_TRACE_GUARD();
 
     ESP_UTILS_CHECK_FALSE_RETURN(unlock_cb_.operator bool(), false, "Unlock callback not registered");
+#if ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER
+    // Recorded before the lock is given, so the hold time does not include the switch to a waiting thread
+    if ((profile_depth > 0) && (--profile_depth == 0)) {
+        pushProfileRecord(profile_tag, profile_wait_us, elapsedUs(profile_acquire_time, Clock::now()));
+    }
+#endif
     ESP_UTILS_CHECK_FALSE_RETURN(unlock_cb_(), false, "Unlock callback failed");
     if (lock_count_ > 0) {
         lock_count_--;
@@ -55,11 +179,193 @@ bool LvLock::unlock()
     return true;
 }
 
-LvLockGuard::LvLockGuard()
+bool LvLock::getProfileReport(ProfileReport &report, size_t top_num)
+{
+#if ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER
+    report = {};
+
+    uint32_t end_index = profile_write_index.load(std::memory_order_acquire);
+    uint32_t start_index = profile_reset_index.load(std::memory_order_relaxed);
+    if (end_index - start_index > ESP_BROOKESIA_LVGL_LOCK_PROFILER_RECORD_NUM) {
+        start_index = end_index - ESP_BROOKESIA_LVGL_LOCK_PROFILER_RECORD_NUM;
+    }
+    std::map<std::pair<std::string, std::string>, ProfileOffender> offenders;
+    for (uint32_t index = start_index; index < end_index; index++) {
+        auto &slot = profile_slots[index % ESP_BROOKESIA_LVGL_LOCK_PROFILER_RECORD_NUM];
+        // Skip the slots being written or already overwritten by a newer record
+        if (slot.sequence.load(std::memory_order_acquire) != index * 2 + 2) {
+            continue;
+        }
+        ProfileRecord record = slot.record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != index * 2 + 2) {
+            continue;
+        }
+
+        report.record_count++;
+        report.wait_histogram[getBucketIndex(record.wait_us)]++;
+        report.hold_histogram[getBucketIndex(record.hold_us)]++;
+
+        std::string tag = (record.tag != nullptr) ? record.tag : "unknown";
+        auto &offender = offenders[ {tag, record.thread_name}];
+        offender.tag = tag;
+        offender.thread_name = record.thread_name;
+        offender.count++;
+        offender.total_hold_us += record.hold_us;
+        offender.max_hold_us = std::max(offender.max_hold_us, record.hold_us);
+        offender.total_wait_us += record.wait_us;
+        offender.max_wait_us = std::max(offender.max_wait_us, record.wait_us);
+    }
+
+    for (auto &[_, offender] : offenders) {
+        report.offenders.push_back(std::move(offender));
+    }
+    std::sort(report.offenders.begin(), report.offenders.end(), [](const auto &a, const auto &b) {
+        return a.total_hold_us > b.total_hold_us;
+    });
+    if (report.offenders.size() > top_num) {
+        report.offenders.resize(top_num);
+    }
+
+    return true;
+#else
+    ESP_UTILS_LOGW("Lock profiler is not enabled, please enable it in the menuconfig");
+    return false;
+#endif
+}
+
+bool LvLock::dumpProfile(size_t top_num)
+{
+    ProfileReport report = {};
+    if (!getProfileReport(report, top_num)) {
+        return false;
+    }
+
+    ESP_UTILS_LOGI("LVGL lock profile: %d records", static_cast<int>(report.record_count));
+    for (size_t i = 0; i < PROFILE_BUCKET_NUM; i++) {
+        if (i < PROFILE_BUCKET_LIMITS_US.size()) {
+            ESP_UTILS_LOGI(
+                "   < %6d us: wait(%d), hold(%d)", static_cast<int>(PROFILE_BUCKET_LIMITS_US[i]),
+                static_cast<int>(report.wait_histogram[i]), static_cast<int>(report.hold_histogram[i])
+            );
+        } else {
+            ESP_UTILS_LOGI(
+                "  >= %6d us: wait(%d), hold(%d)", static_cast<int>(PROFILE_BUCKET_LIMITS_US.back()),
+                static_cast<int>(report.wait_histogram[i]), static_cast<int>(report.hold_histogram[i])
+            );
+        }
+    }
+    for (auto &offender : report.offenders) {
+        ESP_UTILS_LOGI(
+            "  %s @ %s: count(%d), hold total(%d us) max(%d us), wait total(%d us) max(%d us)",
+            offender.tag.c_str(), offender.thread_name.c_str(), static_cast<int>(offender.count),
+            static_cast<int>(offender.total_hold_us), static_cast<int>(offender.max_hold_us),
+            static_cast<int>(offender.total_wait_us), static_cast<int>(offender.max_wait_us)
+        );
+    }
+
+    return true;
+}
+
+bool LvLock::runOnUiThread(UiTask task)
+{
+    ESP_UTILS_LOG_TRACE_GUARD();
+
+    ESP_UTILS_CHECK_FALSE_RETURN(task.operator bool(), false, "Invalid task");
+
+    auto &inst = getInstance();
+    std::lock_guard<std::mutex> lock(inst.ui_task_mutex_);
+    ESP_UTILS_CHECK_NULL_RETURN(inst.ui_task_timer_, false, "UI task timer not created");
+    inst.ui_tasks_.push_back(std::move(task));
+
+    return true;
+}
+
+bool LvLock::beginUiTaskTimer()
+{
+    ESP_UTILS_LOG_TRACE_GUARD();
+
+    auto &inst = getInstance();
+    ESP_UTILS_CHECK_FALSE_RETURN(inst.lock(-1, __func__), false, "Lock failed");
+    lv_timer_t *timer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(inst.ui_task_mutex_);
+        if (inst.ui_task_timer_ == nullptr) {
+            inst.ui_task_timer_ = lv_timer_create(onUiTaskTimer, LV_DEF_REFR_PERIOD, nullptr);
+        }
+        timer = inst.ui_task_timer_;
+    }
+    inst.unlock();
+    ESP_UTILS_CHECK_NULL_RETURN(timer, false, "Create UI task timer failed");
+
+    return true;
+}
+
+bool LvLock::delUiTaskTimer()
+{
+    ESP_UTILS_LOG_TRACE_GUARD();
+
+    auto &inst = getInstance();
+    ESP_UTILS_CHECK_FALSE_RETURN(inst.lock(-1, __func__), false, "Lock failed");
+    {
+        std::lock_guard<std::mutex> lock(inst.ui_task_mutex_);
+        if (inst.ui_task_timer_ != nullptr) {
+            lv_timer_delete(inst.ui_task_timer_);
+            inst.ui_task_timer_ = nullptr;
+        }
+        inst.ui_tasks_.clear();
+    }
+    inst.unlock();
+
+    return true;
+}
+
+bool LvLock::isUiTaskTimerRunning()
+{
+    auto &inst = getInstance();
+    std::lock_guard<std::mutex> lock(inst.ui_task_mutex_);
+
+    return (inst.ui_task_timer_ != nullptr);
+}
+
+void LvLock::onUiTaskTimer(lv_timer_t *)
+{
+    auto &inst = getInstance();
+    std::deque<UiTask> tasks;
+    {
+        std::lock_guard<std::mutex> lock(inst.ui_task_mutex_);
+        if (inst.ui_tasks_.empty()) {
+            return;
+        }
+        if ((ESP_BROOKESIA_LVGL_LOCK_UI_TASK_BATCH_NUM == 0) ||
+                (inst.ui_tasks_.size() <= ESP_BROOKESIA_LVGL_LOCK_UI_TASK_BATCH_NUM)) {
+            tasks.swap(inst.ui_tasks_);
+        } else {
+            auto batch_end = inst.ui_tasks_.begin() + ESP_BROOKESIA_LVGL_LOCK_UI_TASK_BATCH_NUM;
+            tasks.assign(std::make_move_iterator(inst.ui_tasks_.begin()), std::make_move_iterator(batch_end));
+            inst.ui_tasks_.erase(inst.ui_tasks_.begin(), batch_end);
+        }
+    }
+
+    // Run without the queue mutex, so the tasks can queue new ones
+    ESP_UTILS_LOGD("Run %d UI tasks", static_cast<int>(tasks.size()));
+    for (auto &task : tasks) {
+        task();
+    }
+}
+
+void LvLock::resetProfile()
+{
+#if ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER
+    profile_reset_index = profile_write_index.load();
+#endif
+}
+
+LvLockGuard::LvLockGuard(const char *tag)
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
 
-    locked_ = LvLock::getInstance().lock();
+    locked_ = LvLock::getInstance().lock(-1, tag);
 }
 
 LvLockGuard::~LvLockGuard()
@@ -71,4 +377,19 @@ LvLockGuard::~LvLockGuard()
     }
 }
 
+LvLockForbidGuard::LvLockForbidGuard()
+{
+    forbid_depth++;
+}
+
+LvLockForbidGuard::~LvLockForbidGuard()
+{
+    forbid_depth--;
+}
+
+bool LvLockForbidGuard::checkForbidden()
+{
+    return (forbid_depth > 0);
+}
+
 } // namespace esp_brookesia::gui
@@ -5,8 +5,15 @@
  */
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "lvgl.h"
 
 namespace esp_brookesia::gui {
 
@@ -14,27 +21,99 @@ class LvLock {
 public:
     using LockCallback = std::function<bool(int timeout_ms)>;
     using UnlockCallback = std::function<bool()>;
+    using UiTask = std::function<void()>;
 
-    bool lock(int timeout_ms = -1);
+    /**
+     * @brief Upper limits of the histogram buckets of the profiler, the last bucket holds the longer times
+     */
+    static constexpr std::array<uint32_t, 6> PROFILE_BUCKET_LIMITS_US = {100, 1000, 5000, 10000, 30000, 100000};
+    static constexpr size_t PROFILE_BUCKET_NUM = PROFILE_BUCKET_LIMITS_US.size() + 1;
+
+    struct ProfileOffender {
+        std::string tag;            /*!< Call site, the function which takes the lock if not given */
+        std::string thread_name;
+        size_t count;
+        uint64_t total_hold_us;
+        uint32_t max_hold_us;
+        uint64_t total_wait_us;
+        uint32_t max_wait_us;
+    };
+
+    struct ProfileReport {
+        size_t record_count;
+        std::array<size_t, PROFILE_BUCKET_NUM> wait_histogram;
+        std::array<size_t, PROFILE_BUCKET_NUM> hold_histogram;
+        std::vector<ProfileOffender> offenders; /*!< Sorted by the total hold time */
+    };
+
+    /**
+     * @param tag Call site recorded by the profiler, only the pointer is kept so it should be a string literal
+     */
+    bool lock(int timeout_ms = -1, const char *tag = __builtin_FUNCTION());
+    /**
+     * @brief Take the lock only if it is free, never wait for the LVGL task to release it. The lock callback is
+     *        called with a `timeout_ms` of 0, and should not report a busy lock as an error
+     */
+    bool tryLock(const char *tag = __builtin_FUNCTION());
     bool unlock();
 
     static LvLock &getInstance();
     static void registerCallbacks(LockCallback lock_cb, UnlockCallback unlock_cb);
 
+    /**
+     * @brief Queue a task to run in the LVGL task, the caller does not wait for the lock.
+     *        The queued tasks are run in order once per frame, at most
+     *        `CONFIG_ESP_BROOKESIA_LVGL_LOCK_UI_TASK_BATCH_NUM` tasks per frame (0 means all of them).
+     *
+     * @note  Fails if the timer running the tasks is not created by `beginUiTaskTimer()`
+     */
+    static bool runOnUiThread(UiTask task);
+    /**
+     * @brief Create the timer running the tasks of `runOnUiThread()`, call it once LVGL and the lock callbacks are
+     *        ready
+     */
+    static bool beginUiTaskTimer();
+    /**
+     * @brief Delete the timer and drop the tasks not run yet, call it before LVGL is deinitialized
+     */
+    static bool delUiTaskTimer();
+    /**
+     * @brief Check if the timer is created, callers which may run without it should take the lock themselves instead
+     *        of `runOnUiThread()`
+     */
+    static bool isUiTaskTimerRunning();
+
+    /**
+     * @brief Profiler of the lock, only available if `CONFIG_ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER` is enabled.
+     *        The latest `CONFIG_ESP_BROOKESIA_LVGL_LOCK_PROFILER_RECORD_NUM` locks are kept in a lock-free ring buffer.
+     *
+     * @note  Only the locks taken through `LvLock` are recorded, not the direct calls to the lock of the display port
+     *        (e.g. `bsp_display_lock()`), so their hold time shows up as the wait time of the others.
+     */
+    static bool getProfileReport(ProfileReport &report, size_t top_num = 5);
+    static bool dumpProfile(size_t top_num = 5);
+    static void resetProfile();
+
 private:
     LvLock() = default;
     ~LvLock() = default;
     LvLock(const LvLock &) = delete;
     LvLock &operator=(const LvLock &) = delete;
 
+    static void onUiTaskTimer(lv_timer_t *t);
+
     LockCallback lock_cb_;
     UnlockCallback unlock_cb_;
     std::atomic<size_t> lock_count_ = 0;
+
+    std::mutex ui_task_mutex_;
+    std::deque<UiTask> ui_tasks_;
+    lv_timer_t *ui_task_timer_ = nullptr;
 };
 
 class LvLockGuard {
 public:
-    LvLockGuard();
+    LvLockGuard(const char *tag = __builtin_FUNCTION());
     ~LvLockGuard();
 
     LvLockGuard(const LvLockGuard &) = delete;
@@ -44,4 +123,19 @@ private:
     bool locked_ = false;
 };
 
+/**
+ * @brief Forbid the current thread to take the lock while the guard exists. It is used in a thread which another
+ *        thread waits for while holding the lock, where `lock()` would deadlock, so it fails with an error instead.
+ */
+class LvLockForbidGuard {
+public:
+    LvLockForbidGuard();
+    ~LvLockForbidGuard();
+
+    LvLockForbidGuard(const LvLockForbidGuard &) = delete;
+    LvLockForbidGuard &operator=(const LvLockForbidGuard &) = delete;
+
+    static bool checkForbidden();
+};
+
 } // namespace esp_brookesia::gui
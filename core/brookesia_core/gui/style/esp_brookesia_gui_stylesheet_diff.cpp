@@ -0,0 +1,98 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <algorithm>
+#include <cstring>
+#include "private/esp_brookesia_gui_style_utils.hpp"
+#include "esp_brookesia_gui_stylesheet_diff.hpp"
+
+namespace esp_brookesia::gui {
+
+StylesheetDiff::StylesheetDiff(const void *old_data, const void *new_data, size_t size):
+    _data(static_cast<const uint8_t *>(new_data)),
+    _size(size),
+    _is_shared_changed(false),
+    _touched_num(0),
+    _skipped_num(0)
+{
+    const uint8_t *old_bytes = static_cast<const uint8_t *>(old_data);
+
+    for (size_t offset = 0; offset < size; offset += sizeof(uint32_t)) {
+        size_t word_size = std::min(sizeof(uint32_t), size - offset);
+        if (memcmp(old_bytes + offset, _data + offset, word_size) == 0) {
+            continue;
+        }
+
+        // Merge the adjacent changed words
+        if (!_changed_ranges.empty()) {
+            Range &last = _changed_ranges.back();
+            if (last.offset + last.size == offset) {
+                last.size += word_size;
+                continue;
+            }
+        }
+        _changed_ranges.push_back({offset, word_size});
+    }
+}
+
+void StylesheetDiff::addSharedField(const void *field, size_t size)
+{
+    _is_shared_changed = _is_shared_changed || checkFieldChanged(field, size);
+}
+
+bool StylesheetDiff::checkFieldChanged(const void *field, size_t size) const
+{
+    const uint8_t *begin = static_cast<const uint8_t *>(field);
+
+    if ((begin < _data) || (begin + size > _data + _size)) {
+        return true;
+    }
+
+    return checkRangeChanged(begin - _data, size);
+}
+
+size_t StylesheetDiff::getChangedSize(void) const
+{
+    size_t changed_size = 0;
+
+    for (auto &range : _changed_ranges) {
+        changed_size += range.size;
+    }
+
+    return changed_size;
+}
+
+void StylesheetDiff::dump(void) const
+{
+    ESP_UTILS_LOGI(
+        "Stylesheet diff: changed(%d bytes in %d ranges of %d bytes), shared changed(%d), touched(%d), skipped(%d)",
+        static_cast<int>(getChangedSize()), static_cast<int>(_changed_ranges.size()), static_cast<int>(_size),
+        _is_shared_changed, static_cast<int>(_touched_num), static_cast<int>(_skipped_num)
+    );
+}
+
+bool StylesheetDiff::countUpdate(const void *data, size_t size)
+{
+    if (_is_shared_changed || checkFieldChanged(data, size)) {
+        _touched_num++;
+        return true;
+    }
+    _skipped_num++;
+
+    return false;
+}
+
+bool StylesheetDiff::checkRangeChanged(size_t offset, size_t size) const
+{
+    // The ranges are sorted by offset, find the first one which ends after the field begins
+    auto range_end_before = [](const Range & range, size_t value) {
+        return range.offset + range.size <= value;
+    };
+    auto it = std::lower_bound(_changed_ranges.begin(), _changed_ranges.end(), offset, range_end_before);
+
+    return (it != _changed_ranges.end()) && (it->offset < offset + size);
+}
+
+} // namespace esp_brookesia::gui
@@ -0,0 +1,110 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esp_brookesia::gui {
+
+/**
+ * @brief Difference between the old and new calibrated data of a stylesheet, it is sent as the parameter of the data
+ *        update event, so the widgets can skip the update if their own data is not changed.
+ *
+ *        The data is compared word by word in the layout of the stylesheet, the changed words are merged into ranges.
+ *        Since the data only has plain fields, a changed field always changes its words, and a different padding
+ *        only causes an extra update.
+ */
+class StylesheetDiff {
+public:
+    struct Range {
+        size_t offset;
+        size_t size;
+    };
+
+    /**
+     * @param old_data The data before the activation, it is only used in the constructor
+     * @param new_data The data after the activation, the widgets refer to the fields of it
+     */
+    StylesheetDiff(const void *old_data, const void *new_data, size_t size);
+
+    template <typename T>
+    static StylesheetDiff compare(const T &old_data, const T &new_data)
+    {
+        return StylesheetDiff(&old_data, &new_data, sizeof(T));
+    }
+
+    /**
+     * @brief Mark a part of the new data as shared by all widgets, such as the core data. All the widgets are updated
+     *        if it is changed.
+     */
+    void addSharedField(const void *field, size_t size);
+    template <typename T>
+    void addSharedField(const T &field)
+    {
+        addSharedField(&field, sizeof(T));
+    }
+
+    /**
+     * @brief Check if a field of the new data is changed. The fields outside the new data are always treated as
+     *        changed, since they are not compared.
+     */
+    bool checkFieldChanged(const void *field, size_t size) const;
+    template <typename T>
+    bool checkFieldChanged(const T &field) const
+    {
+        return checkFieldChanged(&field, sizeof(T));
+    }
+    bool checkChanged(void) const
+    {
+        return !_changed_ranges.empty();
+    }
+
+    /**
+     * @brief Called by the data update event callback of a widget, check if the widget needs to update by its data
+     *        and count the touched and skipped widgets.
+     *
+     * @param diff The parameter of the event, `nullptr` means the whole stylesheet is changed
+     * @param data The data referred by the widget
+     *
+     * @return true if the widget needs to update, otherwise false
+     */
+    template <typename T>
+    static bool checkUpdateNeeded(StylesheetDiff *diff, const T &data)
+    {
+        return (diff == nullptr) || diff->countUpdate(&data, sizeof(T));
+    }
+
+    const std::vector<Range> &getChangedRanges(void) const
+    {
+        return _changed_ranges;
+    }
+    size_t getChangedSize(void) const;
+    size_t getTouchedNum(void) const
+    {
+        return _touched_num;
+    }
+    size_t getSkippedNum(void) const
+    {
+        return _skipped_num;
+    }
+
+    void dump(void) const;
+
+private:
+    bool countUpdate(const void *data, size_t size);
+    bool checkRangeChanged(size_t offset, size_t size) const;
+
+    const uint8_t *_data;
+    size_t _size;
+    bool _is_shared_changed;
+    std::vector<Range> _changed_ranges;
+    size_t _touched_num;
+    size_t _skipped_num;
+};
+
+} // namespace esp_brookesia::gui
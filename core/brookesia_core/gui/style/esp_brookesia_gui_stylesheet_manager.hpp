@@ -10,11 +10,13 @@
 
 #pragma once
 
+#include <cstring>
 #include <memory>
 #include <string>
 #include <list>
 #include <map>
 #include <unordered_map>
+#include <utility>
 // #include "private/esp_brookesia_base_utils.hpp"
 #include "style/esp_brookesia_gui_style.hpp"
 
@@ -26,6 +28,9 @@ using NameStylesheetMap = std::unordered_map<std::string, std::shared_ptr<T>>;
 template <typename T>
 using ResolutionNameStylesheetMap = std::map<uint32_t, NameStylesheetMap<T>>;
 
+template <typename T>
+using CalibratedStylesheetMap = std::map<std::pair<std::string, uint32_t>, std::shared_ptr<const T>>;
+
 // *INDENT-OFF*
 template <typename T>
 class StylesheetManager {
@@ -35,8 +40,23 @@ public:
 
     virtual bool calibrateScreenSize(StyleSize &size) = 0;
 
+    /**
+     * @brief Add a copy of the stylesheet, or replace the one with the same name and screen size
+     *
+     * @note  Only the screen size is checked here. The stylesheet is calibrated when it is first fetched or activated,
+     *        so an invalid one fails there and is removed then
+     *
+     * @return true if the screen size is valid, false otherwise
+     *
+     */
     bool addStylesheet(const char *name, const StyleSize &screen_size, const T &stylesheet);
-    bool activateStylesheet(const StyleSize &screen_size, const T &stylesheet);
+    /**
+     * @brief Activate the stylesheet, it is added first if there is none with the same name and screen size, or if
+     *        the added one has different data. The same data is recognized both as it was added and as it was
+     *        calibrated (e.g. the active stylesheet passed back), so it is not calibrated again
+     *
+     */
+    bool activateStylesheet(const char *name, const StyleSize &screen_size, const T &stylesheet);
     bool activateStylesheet(const char *name, const StyleSize &screen_size);
 
     size_t getStylesheetCount(void) const;
@@ -46,13 +66,24 @@ public:
     /**
      * @brief Get the active stylesheet
      *
+     * @note  The widgets are bound to this copy when they are constructed, so each activation of another stylesheet
+     *        copies it here once. Use `getStylesheetHandle()` to keep a stylesheet without copying it
+     *
      * @return stylesheet
      *
      */
     const T *getStylesheet(void) const { return &_active_stylesheet; }
 
     /**
-     * @brief Get the stylesheet by name and screen size
+     * @brief Get the shared handle of the active stylesheet, it is never modified after the activation
+     *
+     * @return handle, or `nullptr` if no stylesheet is activated
+     *
+     */
+    std::shared_ptr<const T> getStylesheetHandle(void) const { return _active_stylesheet_handle; }
+
+    /**
+     * @brief Get the stylesheet by name and screen size, it is calibrated on the first call
      *
      * @param name The name of the stylesheet
      * @param screen_size The screen size of the stylesheet
@@ -63,7 +94,7 @@ public:
     const T *getStylesheet(const char *name, const StyleSize &screen_size);
 
     /**
-     * @brief Get the first stylesheet which matches the screen size
+     * @brief Get the first stylesheet which matches the screen size, it is calibrated on the first call
      *
      * @param screen_size The screen size of the stylesheet
      *
@@ -80,12 +111,23 @@ protected:
     bool del(void);
 
 private:
+    std::shared_ptr<const T> getCalibratedStylesheet(const std::string &name, const StyleSize &calibrate_size);
+
     ResolutionNameStylesheetMap<T> _resolution_name_stylesheet_map;
+    // Stylesheets are calibrated lazily, only the ones in this map are calibrated
+    CalibratedStylesheetMap<T> _calibrated_stylesheet_map;
+    std::shared_ptr<const T> _active_stylesheet_handle;
 
     uint32_t getResolution(const StyleSize &screen_size)
     {
         return (screen_size.width << 16) | screen_size.height;
     }
+
+    // The stylesheets only have plain fields, so a different padding only causes an extra calibration
+    static bool checkSameData(const T &a, const T &b)
+    {
+        return (&a == &b) || (memcmp(&a, &b, sizeof(T)) == 0);
+    }
 };
 // *INDENT-ON*
 
@@ -109,11 +151,9 @@ bool StylesheetManager<T>::addStylesheet(const char *name, const StyleSize &scre
 {
     uint32_t resolution = 0;
     StyleSize calibrate_size = screen_size;
-    std::shared_ptr<T> calibration_stylesheet = std::make_shared<T>(stylesheet);
 
     // ESP_UTILS_CHECK_NULL_RETURN(name, false, "Invalid name");
-    // ESP_UTILS_CHECK_NULL_RETURN(calibration_stylesheet, false, "Create stylesheet failed");
-    if (name == nullptr || calibration_stylesheet == nullptr) {
+    if (name == nullptr) {
         return false;
     }
 
@@ -123,66 +163,62 @@ bool StylesheetManager<T>::addStylesheet(const char *name, const StyleSize &scre
         return false;
     }
 
-    // ESP_UTILS_CHECK_FALSE_RETURN(calibrateStylesheet(calibrate_size, *calibration_stylesheet), false, "Invalid stylesheet");
-    if (!calibrateStylesheet(calibrate_size, *calibration_stylesheet)) {
+    // The stylesheet is calibrated on its first use, so the ones which are never used cost no calibration
+    std::shared_ptr<T> new_stylesheet = std::make_shared<T>(stylesheet);
+    // ESP_UTILS_CHECK_NULL_RETURN(new_stylesheet, false, "Create stylesheet failed");
+    if (new_stylesheet == nullptr) {
         return false;
     }
 
-    // Check if the resolution is already exist
+    // Add it, or overwrite the one with the same name and resolution
     resolution = getResolution(calibrate_size);
-    auto it_resolution_map = _resolution_name_stylesheet_map.find(resolution);
-    // If not exist, create a new map which contains the name and data
-    if (it_resolution_map == _resolution_name_stylesheet_map.end()) {
-        _resolution_name_stylesheet_map[resolution][std::string(name)] = calibration_stylesheet;
-        return true;
-    }
-
-    // If exist, check if the name is already exist
-    auto it_name_map = it_resolution_map->second.find(name);
-    // If exist, overwrite it, else add it
-    if (it_name_map != it_resolution_map->second.end()) {
-        // ESP_UTILS_LOGW("Stylesheet(%s) already exist, overwrite it", it_name_map->first.c_str());
-        it_name_map->second = calibration_stylesheet;
-    } else {
-        it_resolution_map->second[name] = calibration_stylesheet;
-    }
+    _resolution_name_stylesheet_map[resolution][std::string(name)] = new_stylesheet;
+    _calibrated_stylesheet_map.erase({std::string(name), resolution});
 
     return true;
 }
 
 template <typename T>
-bool StylesheetManager<T>::activateStylesheet(const StyleSize &screen_size,
-        const T &stylesheet)
+bool StylesheetManager<T>::activateStylesheet(const char *name, const StyleSize &screen_size, const T &stylesheet)
 {
     StyleSize calibrate_size = screen_size;
+
+    // ESP_UTILS_CHECK_NULL_RETURN(name, false, "Invalid name");
+    if (name == nullptr) {
+        return false;
+    }
+
     // ESP_UTILS_CHECK_FALSE_RETURN(calibrateScreenSize(calibrate_size), false, "Invalid screen size");
     if (!calibrateScreenSize(calibrate_size)) {
         return false;
     }
-    // ESP_UTILS_LOGD("Activate stylesheet(%dx%d)", calibrate_size.width, calibrate_size.height);
 
-    std::shared_ptr<T> calibration_stylesheet = std::make_shared<T>(stylesheet);
-    // ESP_UTILS_CHECK_NULL_RETURN(calibration_stylesheet, false, "Create stylesheet failed");
-    if (calibration_stylesheet == nullptr) {
-        return false;
+    // Reuse the added one if it has the same data, so it is not calibrated again. Otherwise add or replace it
+    uint32_t resolution = getResolution(calibrate_size);
+    auto &name_map = _resolution_name_stylesheet_map[resolution];
+    auto it_stylesheet = name_map.find(name);
+    bool is_same = false;
+    if (it_stylesheet != name_map.end()) {
+        auto it_calibrated = _calibrated_stylesheet_map.find({std::string(name), resolution});
+        is_same = checkSameData(*it_stylesheet->second, stylesheet) || (
+                      (it_calibrated != _calibrated_stylesheet_map.end()) &&
+                      checkSameData(*it_calibrated->second, stylesheet)
+                  );
     }
-    // ESP_UTILS_CHECK_FALSE_RETURN(
-    //     calibrateStylesheet(calibrate_size, *calibration_stylesheet), false, "Invalid stylesheet"
-    // );
-    if (!calibrateStylesheet(calibrate_size, *calibration_stylesheet)) {
-        return false;
+    if (!is_same) {
+        // ESP_UTILS_CHECK_FALSE_RETURN(addStylesheet(name, screen_size, stylesheet), false, "Add stylesheet failed");
+        if (!addStylesheet(name, screen_size, stylesheet)) {
+            return false;
+        }
     }
 
-    _active_stylesheet = *calibration_stylesheet;
-
-    return true;
+    return activateStylesheet(name, screen_size);
 }
 
 template <typename T>
 bool StylesheetManager<T>::activateStylesheet(const char *name, const StyleSize &screen_size)
 {
     StyleSize calibrate_size = screen_size;
-    const T *stylesheet = nullptr;
 
     // ESP_UTILS_CHECK_NULL_RETURN(name, false, "Invalid name");
     if (name == nullptr) {
@@ -195,13 +231,19 @@ bool StylesheetManager<T>::activateStylesheet(const char *name, const StyleSize
     }
     // ESP_UTILS_LOGD("Activate stylesheet(%s - %dx%d)", name, calibrate_size.width, calibrate_size.height);
 
-    stylesheet = getStylesheet(name, screen_size);
+    auto stylesheet = getCalibratedStylesheet(name, calibrate_size);
     // ESP_UTILS_CHECK_NULL_RETURN(stylesheet, false, "Get stylesheet failed");
     if (stylesheet == nullptr) {
         return false;
     }
 
+    // Skip the copy if the stylesheet is already active
+    if (stylesheet == _active_stylesheet_handle) {
+        return true;
+    }
+    // The widgets are bound to `_active_stylesheet`, so switching still copies the stylesheet into it once
     _active_stylesheet = *stylesheet;
+    _active_stylesheet_handle = std::move(stylesheet);
 
     return true;
 }
@@ -251,7 +293,6 @@ typename NameStylesheetMap<T>::iterator StylesheetManager<T>::getNameStylesheetM
 template <typename T>
 const T *StylesheetManager<T>::getStylesheet(const char *name, const StyleSize &screen_size)
 {
-    uint32_t resolution = 0;
     StyleSize calibrate_size = screen_size;
 
     // ESP_UTILS_CHECK_NULL_RETURN(name, nullptr, "Invalid name");
@@ -264,20 +305,7 @@ const T *StylesheetManager<T>::getStylesheet(const char *name, const StyleSize &
         return nullptr;
     }
 
-    // Check if the resolution is already exist
-    resolution = getResolution(calibrate_size);
-    auto it_resolution_map = _resolution_name_stylesheet_map.find(resolution);
-    if (it_resolution_map == _resolution_name_stylesheet_map.end()) {
-        return nullptr;
-    }
-
-    // If exist, check if the name is already exist
-    auto it_name_map = it_resolution_map->second.find(name);
-    if (it_name_map == it_resolution_map->second.end()) {
-        return nullptr;
-    }
-
-    return it_name_map->second.get();
+    return getCalibratedStylesheet(name, calibrate_size).get();
 }
 
 template <typename T>
@@ -299,19 +327,57 @@ const T *StylesheetManager<T>::getStylesheet(const StyleSize &screen_size)
         return nullptr;
     }
 
-    auto name_map = it_resolution_map->second;
+    auto &name_map = it_resolution_map->second;
     if (name_map.empty()) {
         return nullptr;
     }
 
-    return name_map.begin()->second.get();
+    return getCalibratedStylesheet(name_map.begin()->first, calibrate_size).get();
+}
+
+template <typename T>
+std::shared_ptr<const T> StylesheetManager<T>::getCalibratedStylesheet(
+    const std::string &name, const StyleSize &calibrate_size
+)
+{
+    uint32_t resolution = getResolution(calibrate_size);
+    auto key = std::make_pair(name, resolution);
+
+    auto it_calibrated = _calibrated_stylesheet_map.find(key);
+    if (it_calibrated != _calibrated_stylesheet_map.end()) {
+        return it_calibrated->second;
+    }
+
+    auto it_resolution_map = _resolution_name_stylesheet_map.find(resolution);
+    if (it_resolution_map == _resolution_name_stylesheet_map.end()) {
+        return nullptr;
+    }
+    auto it_name_map = it_resolution_map->second.find(name);
+    if (it_name_map == it_resolution_map->second.end()) {
+        return nullptr;
+    }
+
+    // Calibrate a copy, so the stylesheet as added is kept to recognize it when it is activated by value again
+    // ESP_UTILS_LOGD("Calibrate stylesheet(%s - %dx%d)", name.c_str(), calibrate_size.width, calibrate_size.height);
+    std::shared_ptr<T> calibrated_stylesheet = std::make_shared<T>(*it_name_map->second);
+    // ESP_UTILS_CHECK_FALSE_RETURN(calibrateStylesheet(calibrate_size, *calibrated_stylesheet), nullptr, "Invalid stylesheet");
+    if (!calibrateStylesheet(calibrate_size, *calibrated_stylesheet)) {
+        // It would fail on every use, so it is removed
+        it_resolution_map->second.erase(it_name_map);
+        return nullptr;
+    }
+    _calibrated_stylesheet_map[key] = calibrated_stylesheet;
+
+    return calibrated_stylesheet;
 }
 
 template <typename T>
 bool StylesheetManager<T>::del(void)
 {
     _active_stylesheet = {};
+    _active_stylesheet_handle.reset();
     _resolution_name_stylesheet_map.clear();
+    _calibrated_stylesheet_map.clear();
 
     return true;
 }
@@ -30,4 +30,12 @@
 #           define ESP_BROOKESIA_STORAGE_NVS_ENABLE_DEBUG_LOG  (0)
 #       endif
 #   endif
+
+#   if !defined(ESP_BROOKESIA_STORAGE_NVS_WRITE_BACK_WINDOW_MS)
+#       if defined(CONFIG_ESP_BROOKESIA_STORAGE_NVS_WRITE_BACK_WINDOW_MS)
+#           define ESP_BROOKESIA_STORAGE_NVS_WRITE_BACK_WINDOW_MS  CONFIG_ESP_BROOKESIA_STORAGE_NVS_WRITE_BACK_WINDOW_MS
+#       else
+#           define ESP_BROOKESIA_STORAGE_NVS_WRITE_BACK_WINDOW_MS  (1000)
+#       endif
+#   endif
 #endif
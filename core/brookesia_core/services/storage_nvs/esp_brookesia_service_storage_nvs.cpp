@@ -3,11 +3,14 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #include <map>
 #include <chrono>
-#include "nvs_flash.h"
-#include "nvs.h"
 #include "private/esp_brookesia_service_storage_nvs_utils.hpp"
+#include "esp_brookesia_service_storage_nvs_flash_backend.hpp"
 #include "esp_brookesia_service_storage_nvs.hpp"
 
 #define STORAGE_NVS_PARTITION_NAME          NVS_DEFAULT_PART_NAME
@@ -20,35 +23,34 @@
 
 namespace esp_brookesia::services {
 
-static const std::map<nvs_type_t, const char *> type_str_pair = {
-    { NVS_TYPE_I8, "i8" },
-    { NVS_TYPE_U8, "u8" },
-    { NVS_TYPE_U16, "u16" },
-    { NVS_TYPE_I16, "i16" },
-    { NVS_TYPE_U32, "u32" },
-    { NVS_TYPE_I32, "i32" },
-    { NVS_TYPE_U64, "u64" },
-    { NVS_TYPE_I64, "i64" },
-    { NVS_TYPE_STR, "str" },
-    { NVS_TYPE_BLOB, "blob" },
-    { NVS_TYPE_ANY, "any" },
-};
-
 void StorageNVS::Event::dump() const
 {
     ESP_UTILS_LOGI(
         "{Event}:\n"
         "\t-Operation(%d)\n"
-        "\t-Key(%s)\n",
+        "\t-Key(%s)\n"
+        "\t-Keys(%d)\n",
         static_cast<int>(operation),
-        key.empty() ? "None" : key.c_str()
+        key.empty() ? "None" : key.c_str(),
+        static_cast<int>(keys.size())
     );
 }
 
-bool StorageNVS::begin()
+bool StorageNVS::begin(std::shared_ptr<StorageNVSBackend> backend)
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
 
+    ESP_UTILS_CHECK_FALSE_RETURN(_backend == nullptr, false, "Already begun");
+
+    if (backend == nullptr) {
+        ESP_UTILS_CHECK_EXCEPTION_RETURN(
+            backend = std::make_shared<StorageNVSFlashBackend>(STORAGE_NVS_PARTITION_NAME, STORAGE_NVS_NAMESPACE), false,
+            "Make NVS flash backend failed"
+        );
+    }
+    _backend = backend;
+    ESP_UTILS_LOGI("Use backend(%s)", _backend->getName());
+
     {
         esp_utils::thread_config_guard thread_config(esp_utils::ThreadConfig{
             .name = EVENT_THREAD_NAME,
@@ -58,32 +60,23 @@ bool StorageNVS::begin()
         _event_thread = boost::thread([this]() {
             ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
 
-            // Initialize NVS flash
-            esp_err_t ret = nvs_flash_init();
-            if ((ret == ESP_ERR_NVS_NO_FREE_PAGES) || (ret == ESP_ERR_NVS_NEW_VERSION_FOUND)) {
-                ESP_UTILS_CHECK_FALSE_RETURN(nvs_flash_erase() == ESP_OK, false, "Erase NVS flash failed");
-                ESP_UTILS_CHECK_FALSE_RETURN(nvs_flash_init() == ESP_OK, false, "Init NVS flash failed");
-            } else {
-                ESP_UTILS_CHECK_ERROR_RETURN(ret, false, "Initialize NVS flash failed");
-            }
-
-            // Create NVS namespace if not exists
-            {
-                nvs_handle_t nvs_handle;
-                ESP_UTILS_CHECK_ERROR_RETURN(
-                    nvs_open(STORAGE_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle), false, "Open NVS namespace failed"
-                );
-                esp_utils::function_guard nvs_close_guard([&]() {
-                    nvs_close(nvs_handle);
-                });
-                ESP_UTILS_CHECK_ERROR_RETURN(nvs_commit(nvs_handle), false, "Commit NVS failed");
-            }
+            ESP_UTILS_CHECK_FALSE_RETURN(_backend->init(), false, "Init backend(%s) failed", _backend->getName());
 
             while (true) {
                 std::unique_lock<std::mutex> lock(_event_mutex);
-                _event_cv.wait(lock, [this] {
-                    return !_event_queue.empty();
-                });
+                auto has_event = [this] {
+                    return !_event_queue.empty() || _is_event_thread_stopping;
+                };
+                if (_dirty_keys.empty()) {
+                    _event_cv.wait(lock, has_event);
+                } else if (!_event_cv.wait_until(lock, _dirty_flush_deadline, has_event)) {
+                    // The write-back window is over, write all the dirty keys with one commit
+                    lock.unlock();
+                    if (!doEventOperationFlushNVS()) {
+                        ESP_UTILS_LOGE("Flush NVS failed");
+                    }
+                    continue;
+                }
 
                 while (!_event_queue.empty()) {
                     auto event_wrapper = _event_queue.front();
@@ -91,13 +84,28 @@ bool StorageNVS::begin()
 
                     lock.unlock();
                     auto ret = processEvent(event_wrapper.event);
+                    // The caller is waiting for the result, so write back the dirty keys right now
+                    if ((event_wrapper.promise != nullptr) && !_dirty_keys.empty()) {
+                        ret = doEventOperationFlushNVS() && ret;
+                    }
                     lock.lock();
 
                     if (event_wrapper.promise != nullptr) {
                         event_wrapper.promise->set_value(ret);
                     }
                 }
+
+                if (_is_event_thread_stopping) {
+                    // The queued events are done, write back the pending keys before exiting
+                    lock.unlock();
+                    if (!doEventOperationFlushNVS()) {
+                        ESP_UTILS_LOGE("Flush NVS failed");
+                    }
+                    break;
+                }
             }
+
+            return true;
         });
     }
 
@@ -114,6 +122,56 @@ bool StorageNVS::begin()
     return true;
 }
 
+bool StorageNVS::begin(const std::vector<Key> &float_keys)
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    std::shared_ptr<StorageNVSBackend> backend = nullptr;
+    ESP_UTILS_CHECK_EXCEPTION_RETURN(
+        backend = std::make_shared<StorageNVSFlashBackend>(
+                      STORAGE_NVS_PARTITION_NAME, STORAGE_NVS_NAMESPACE, float_keys
+                  ), false, "Make NVS flash backend failed"
+    );
+
+    return begin(backend);
+}
+
+bool StorageNVS::del()
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    if (_backend == nullptr) {
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_event_mutex);
+        _is_event_thread_stopping = true;
+        _event_cv.notify_one();
+    }
+    ESP_UTILS_CHECK_EXCEPTION_RETURN(_event_thread.join(), false, "Join event thread failed");
+    _is_event_thread_stopping = false;
+
+    _backend = nullptr;
+    _dirty_keys.clear();
+    _local_params.update([](StorageNVSParams::Map & params) {
+        params.clear();
+    });
+    _event_signal.disconnect_all_slots();
+    {
+        std::lock_guard<std::mutex> lock(_key_mutex);
+        _key_ids.clear();
+        _key_subscriptions.clear();
+    }
+    _writes_requested = 0;
+    _writes_issued = 0;
+    _writes_coalesced = 0;
+    _writes_failed = 0;
+    _commits = 0;
+
+    return true;
+}
+
 bool StorageNVS::sendEvent(const Event &event, EventFuture *future)
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
@@ -147,14 +205,19 @@ bool StorageNVS::setLocalParam(const Key &key, const Value &value, const void *s
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
 
     ESP_UTILS_LOGD(
-        "Param: key(%s), value(%s), future(%p)", key.c_str(), std::holds_alternative<int>(value) ?
-        std::to_string(std::get<int>(value)).c_str() : std::get<std::string>(value).c_str(), future
+        "Param: key(%s), value(%s), future(%p)", key.c_str(), StorageNVSBackend::getValueString(value).c_str(), future
     );
 
-    {
-        std::lock_guard<std::mutex> lock(_params_mutex);
-        _local_params[key] = value;
-    }
+    // Rejected here, otherwise the value would be accepted in memory and only fail at the write-back
+    auto backend = _backend;
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        (backend == nullptr) || backend->checkValueSupported(key, value), false,
+        "Value of key(%s) is not supported by backend(%s)", key.c_str(), backend->getName()
+    );
+
+    _local_params.update([&](StorageNVSParams::Map &params) {
+        params[key] = value;
+    });
 
     ESP_UTILS_CHECK_FALSE_RETURN(sendEvent({
         .sender = sender,
@@ -167,15 +230,93 @@ bool StorageNVS::setLocalParam(const Key &key, const Value &value, const void *s
 
 bool StorageNVS::getLocalParam(const Key &key, Value &value)
 {
-    std::lock_guard<std::mutex> lock(_params_mutex);
+    auto snapshot = _local_params.acquire();
 
-    auto it = _local_params.find(key);
-    if (it == _local_params.end()) {
+    auto param = snapshot.find(key);
+    if (param == nullptr) {
         ESP_UTILS_LOGW("NVS key(%s) not found", key.c_str());
         return false;
     }
 
-    value = it->second;
+    value = *param;
+
+    return true;
+}
+
+bool StorageNVS::migrateLocalParam(
+    const Key &key, const ValueParser &parser, const void *sender, EventFuture *future
+)
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    ESP_UTILS_LOGD("Param: key(%s), future(%p)", key.c_str(), future);
+
+    Value value;
+    {
+        auto snapshot = _local_params.acquire();
+        auto param = snapshot.find(key);
+        ESP_UTILS_CHECK_NULL_RETURN(param, false, "NVS key(%s) not found", key.c_str());
+
+        if (!std::holds_alternative<std::string>(*param)) {
+            ESP_UTILS_LOGD("NVS key(%s) is already migrated", key.c_str());
+            return true;
+        }
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            parser(std::get<std::string>(*param), value), false, "Parse NVS key(%s) value(%s) failed", key.c_str(),
+            std::get<std::string>(*param).c_str()
+        );
+    }
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        setLocalParam(key, value, sender, future), false, "Set NVS key(%s) failed", key.c_str()
+    );
+
+    ESP_UTILS_LOGI("Migrated NVS key(%s) to value(%s)", key.c_str(), StorageNVSBackend::getValueString(value).c_str());
+
+    return true;
+}
+
+bool StorageNVS::parseIntString(const std::string &str, Value &value)
+{
+    char *end = nullptr;
+    errno = 0;
+    long value_long = strtol(str.c_str(), &end, 0);
+    if (str.empty() || (*end != '\0') || (errno != 0) || (value_long < INT_MIN) || (value_long > INT_MAX)) {
+        return false;
+    }
+    value = static_cast<int>(value_long);
+
+    return true;
+}
+
+bool StorageNVS::parseFloatString(const std::string &str, Value &value)
+{
+    char *end = nullptr;
+    errno = 0;
+    float value_float = strtof(str.c_str(), &end);
+    if (str.empty() || (*end != '\0') || (errno != 0)) {
+        return false;
+    }
+    value = value_float;
+
+    return true;
+}
+
+bool StorageNVS::parseInt64String(const std::string &str, Value &value)
+{
+    char *end = nullptr;
+    errno = 0;
+    long long value_long = strtoll(str.c_str(), &end, 0);
+    if (str.empty() || (*end != '\0') || (errno != 0)) {
+        return false;
+    }
+    value = static_cast<int64_t>(value_long);
+
+    return true;
+}
+
+bool StorageNVS::parseBlobString(const std::string &str, Value &value)
+{
+    value = Blob(str.begin(), str.end());
 
     return true;
 }
@@ -194,6 +335,36 @@ bool StorageNVS::eraseNVS(const void *sender, EventFuture *future)
     return true;
 }
 
+bool StorageNVS::flushNVS(const void *sender, EventFuture *future)
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    ESP_UTILS_LOGD("Param: future(%p)", future);
+
+    ESP_UTILS_CHECK_FALSE_RETURN(sendEvent({
+        .sender = sender,
+        .operation = Operation::FlushNVS,
+    }, future), false, "Send flush NVS event failed");
+
+    return true;
+}
+
+StorageNVSParams::Snapshot StorageNVS::getParamsSnapshot() const
+{
+    return _local_params.acquire();
+}
+
+StorageNVS::WriteStats StorageNVS::getWriteStats() const
+{
+    return {
+        .writes_requested = _writes_requested.load(),
+        .writes_issued = _writes_issued.load(),
+        .writes_coalesced = _writes_coalesced.load(),
+        .writes_failed = _writes_failed.load(),
+        .commits = _commits.load(),
+    };
+}
+
 boost::signals2::connection StorageNVS::connectEventSignal(EventSignal::slot_type slot)
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
@@ -201,6 +372,95 @@ boost::signals2::connection StorageNVS::connectEventSignal(EventSignal::slot_typ
     return _event_signal.connect(slot);
 }
 
+boost::signals2::connection StorageNVS::connectKeyEventSignal(const std::vector<Key> &keys, EventSignal::slot_type slot)
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    KeySubscriptionPtr subscription = nullptr;
+    ESP_UTILS_CHECK_EXCEPTION_RETURN(
+        subscription = std::make_shared<KeySubscription>(), boost::signals2::connection(), "Make subscription failed"
+    );
+    for (auto &key : keys) {
+        subscription->key_ids.push_back(internKey(key));
+    }
+    auto connection = subscription->signal.connect(slot);
+
+    std::lock_guard<std::mutex> lock(_key_mutex);
+    for (auto key_id : subscription->key_ids) {
+        _key_subscriptions[key_id].push_back(subscription);
+    }
+
+    return connection;
+}
+
+StorageNVS::KeyID StorageNVS::internKey(const Key &key)
+{
+    std::lock_guard<std::mutex> lock(_key_mutex);
+
+    auto it = _key_ids.find(key);
+    if (it != _key_ids.end()) {
+        return it->second;
+    }
+
+    KeyID key_id = static_cast<KeyID>(_key_subscriptions.size());
+    _key_ids.emplace(key, key_id);
+    _key_subscriptions.emplace_back();
+    ESP_UTILS_LOGD("Intern key(%s) as ID(%d)", key.c_str(), static_cast<int>(key_id));
+
+    return key_id;
+}
+
+void StorageNVS::emitKeyEventSignal(const Event &event)
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    // Collect the subscriptions to notify with the changed keys they care about, each one is notified only once
+    std::vector<std::pair<KeySubscriptionPtr, std::vector<Key>>> targets;
+    {
+        std::lock_guard<std::mutex> lock(_key_mutex);
+        auto collect_subscriptions = [&](const Key & key) {
+            auto key_it = _key_ids.find(key);
+            if (key_it == _key_ids.end()) {
+                return;
+            }
+
+            auto &subscriptions = _key_subscriptions[key_it->second];
+            subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(), [](auto & subscription) {
+                return subscription->signal.empty();
+            }), subscriptions.end());
+
+            for (auto &subscription : subscriptions) {
+                auto target_it = std::find_if(targets.begin(), targets.end(), [&](auto & target) {
+                    return target.first == subscription;
+                });
+                if (target_it == targets.end()) {
+                    targets.emplace_back(subscription, std::vector<Key>{key});
+                } else {
+                    target_it->second.push_back(key);
+                }
+            }
+        };
+
+        if (event.operation == Operation::UpdateNVS) {
+            collect_subscriptions(event.key);
+        } else if (event.operation == Operation::UpdateParam) {
+            for (auto &key : event.keys) {
+                collect_subscriptions(key);
+            }
+        }
+    }
+
+    for (auto &[subscription, keys] : targets) {
+        if (event.operation == Operation::UpdateNVS) {
+            subscription->signal(event);
+        } else {
+            Event batched_event = event;
+            batched_event.keys = std::move(keys);
+            subscription->signal(batched_event);
+        }
+    }
+}
+
 bool StorageNVS::processEvent(const Event &event)
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
@@ -216,18 +476,27 @@ bool StorageNVS::processEvent(const Event &event)
         break;
     }
     case Operation::UpdateParam: {
-        ESP_UTILS_CHECK_FALSE_RETURN(doEventOperationUpdateParam(), false, "Update param failed");
-        break;
+        // Notify the reloaded keys at once instead of one event per key
+        Event batched_event = event;
+        ESP_UTILS_CHECK_FALSE_RETURN(doEventOperationUpdateParam(batched_event.keys), false, "Update param failed");
+        _event_signal(batched_event);
+        emitKeyEventSignal(batched_event);
+        return true;
     }
     case Operation::EraseNVS: {
         ESP_UTILS_CHECK_FALSE_RETURN(doEventOperationEraseNVS(), false, "Erase NVS failed");
         break;
     }
+    case Operation::FlushNVS: {
+        ESP_UTILS_CHECK_FALSE_RETURN(doEventOperationFlushNVS(), false, "Flush NVS failed");
+        break;
+    }
     default:
         ESP_UTILS_CHECK_FALSE_RETURN(false, false, "Invalid operation(%d)", static_cast<int>(event.operation));
     }
 
     _event_signal(event);
+    emitKeyEventSignal(event);
 
     return true;
 }
@@ -238,142 +507,112 @@ bool StorageNVS::doEventOperationUpdateNVS(const Key &key)
 
     ESP_UTILS_LOGD("Param: key(%s)", key.c_str());
 
-    std::lock_guard<std::mutex> lock(_params_mutex);
-
-    auto it = _local_params.find(key);
     ESP_UTILS_CHECK_FALSE_RETURN(
-        it != _local_params.end(), false, "Invalid NVS key(%s)", key.c_str()
-    );
-    ESP_UTILS_LOGD("Update key(%s) NVS parameter", key.c_str());
-
-    nvs_handle_t nvs_handle;
-    ESP_UTILS_CHECK_ERROR_RETURN(
-        nvs_open(STORAGE_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle), false, "Open NVS namespace failed"
+        _local_params.acquire().find(key) != nullptr, false, "Invalid NVS key(%s)", key.c_str()
     );
 
-    esp_utils::function_guard nvs_close_guard([&]() {
-        nvs_close(nvs_handle);
-    });
-
-    auto &value = it->second;
-    const char *key_str = key.c_str();
-
-    if (std::holds_alternative<int>(value)) {
-        auto value_int = std::get<int>(value);
-        ESP_UTILS_LOGD("Set key(%s) value(%d)", key_str, value_int);
-
-        ESP_UTILS_CHECK_ERROR_RETURN(
-            nvs_set_i32(nvs_handle, key_str, static_cast<int32_t>(value_int)), false, "Set NVS parameter failed"
-        );
-    } else if (std::holds_alternative<std::string>(value)) {
-        auto value_str = std::get<std::string>(value);
-        ESP_UTILS_LOGD("Set key(%s) value(%s)", key_str, value_str.c_str());
-
-        ESP_UTILS_CHECK_ERROR_RETURN(
-            nvs_set_str(nvs_handle, key_str, value_str.c_str()), false, "Set NVS parameter failed"
-        );
-    } else {
-        ESP_UTILS_CHECK_FALSE_RETURN(false, false, "Invalid NVS key(%s) value type", key_str);
+    _writes_requested++;
+    if (_dirty_keys.empty()) {
+        _dirty_flush_deadline = std::chrono::steady_clock::now() +
+                                std::chrono::milliseconds(ESP_BROOKESIA_STORAGE_NVS_WRITE_BACK_WINDOW_MS);
+    }
+    if (!_dirty_keys.insert(key).second) {
+        ESP_UTILS_LOGD("Coalesce key(%s) into the pending write", key.c_str());
+        _writes_coalesced++;
     }
 
-    ESP_UTILS_CHECK_ERROR_RETURN(nvs_commit(nvs_handle), false, "Commit NVS failed");
+#if ESP_BROOKESIA_STORAGE_NVS_WRITE_BACK_WINDOW_MS == 0
+    ESP_UTILS_CHECK_FALSE_RETURN(doEventOperationFlushNVS(), false, "Flush NVS failed");
+#endif
 
     return true;
 }
 
-bool StorageNVS::doEventOperationUpdateParam()
+bool StorageNVS::doEventOperationUpdateParam(std::vector<Key> &changed_keys)
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
 
-    std::lock_guard<std::mutex> lock(_params_mutex);
+    // Write back the pending keys first, otherwise the reload would overwrite them with the stale stored values
+    ESP_UTILS_CHECK_FALSE_RETURN(doEventOperationFlushNVS(), false, "Flush NVS failed");
 
-    nvs_handle_t nvs_handle;
-    ESP_UTILS_CHECK_ERROR_RETURN(
-        nvs_open(STORAGE_NVS_NAMESPACE, NVS_READONLY, &nvs_handle), false, "Open NVS namespace failed"
-    );
+    StorageNVSBackend::Params params;
+    ESP_UTILS_CHECK_FALSE_RETURN(_backend->load(params), false, "Load parameters from backend failed");
 
-    esp_utils::function_guard nvs_close_guard([&]() {
-        nvs_close(nvs_handle);
+    _local_params.update([&](StorageNVSParams::Map &local_params) {
+        for (auto &[key, value] : params) {
+            auto it = local_params.find(key);
+            if ((it != local_params.end()) && (it->second == value)) {
+                continue;
+            }
+            changed_keys.push_back(key);
+            local_params[key] = std::move(value);
+        }
     });
 
-    ESP_UTILS_LOGI("Finding keys in NVS...");
+    return true;
+}
 
-    nvs_iterator_t it = NULL;
-    esp_err_t res = nvs_entry_find(STORAGE_NVS_PARTITION_NAME, STORAGE_NVS_NAMESPACE, NVS_TYPE_ANY, &it);
-    while (res == ESP_OK) {
-        nvs_entry_info_t info;
-        res = nvs_entry_info(it, &info);
-        if (res != ESP_OK) {
-            ESP_UTILS_LOGE("Get key info failed");
-            break;
-        }
+bool StorageNVS::doEventOperationEraseNVS()
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
 
-        auto type_str_it = type_str_pair.find(info.type);
-        if (type_str_it == type_str_pair.end()) {
-            ESP_UTILS_LOGE("\t- Invalid NVS key(%s) type(%d)", info.key, static_cast<int>(info.type));
-            res = nvs_entry_next(&it);
-            continue;
-        }
+    ESP_UTILS_LOGI("Erase NVS...");
 
-        esp_err_t ret = ESP_OK;
-        switch (info.type) {
-        case NVS_TYPE_I32: {
-            int32_t value_int;
-            ret = nvs_get_i32(nvs_handle, info.key, &value_int);
-            if (ret != ESP_OK) {
-                ESP_UTILS_LOGE("\t- Get key(%s) value failed", info.key);
-            } else {
-                ESP_UTILS_LOGI(
-                    "\t- Found key(%s): type(%s), value(%d)", info.key, type_str_it->second, static_cast<int>(value_int)
-                );
-                _local_params[info.key] = Value(static_cast<int>(value_int));
-            }
-            break;
-        }
-        case NVS_TYPE_STR: {
-            size_t len = NVS_VALUE_STR_MAX_LEN;
-            std::unique_ptr<char[]> value_str(new char[len]);
-            ret = nvs_get_str(nvs_handle, info.key, value_str.get(), &len);
-            if (ret != ESP_OK) {
-                ESP_UTILS_LOGE("\t- Get key(%s) value failed", info.key);
-            } else {
-                ESP_UTILS_LOGI(
-                    "\t- Found key(%s): type(%s), value(%s)", info.key, type_str_it->second, value_str.get()
-                );
-                _local_params[info.key] = Value(std::string(value_str.get()));
-            }
-            break;
-        }
-        default:
-            ESP_UTILS_LOGI("\t- Skip key(%s): type(%s)", info.key, type_str_it->second);
-            break;
-        }
-        res = nvs_entry_next(&it);
-    }
-    nvs_release_iterator(it);
+    // The pending writes would be erased anyway
+    _dirty_keys.clear();
 
-    ESP_UTILS_LOGI("Found %d keys in NVS", static_cast<int>(_local_params.size()));
+    ESP_UTILS_CHECK_FALSE_RETURN(_backend->eraseAll(), false, "Erase backend failed");
 
     return true;
 }
 
-bool StorageNVS::doEventOperationEraseNVS()
+bool StorageNVS::doEventOperationFlushNVS()
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
 
-    ESP_UTILS_LOGI("Erase NVS...");
+    if (_dirty_keys.empty()) {
+        return true;
+    }
 
-    nvs_handle_t nvs_handle;
-    ESP_UTILS_CHECK_ERROR_RETURN(
-        nvs_open(STORAGE_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle), false, "Open NVS namespace failed"
-    );
+    // Re-arm the deadline first, so a failed write is retried in the next window instead of immediately
+    _dirty_flush_deadline = std::chrono::steady_clock::now() +
+                            std::chrono::milliseconds(ESP_BROOKESIA_STORAGE_NVS_WRITE_BACK_WINDOW_MS);
 
-    esp_utils::function_guard nvs_close_guard([&]() {
-        nvs_close(nvs_handle);
-    });
+    // The snapshot keeps the values alive without blocking the readers and writers during the flash write
+    auto snapshot = _local_params.acquire();
+
+    ESP_UTILS_LOGD("Flush %d dirty keys to NVS", static_cast<int>(_dirty_keys.size()));
+
+    // A key which the backend fails to write is dropped, so it does not keep the others from being written
+    size_t written_num = 0;
+    size_t failed_num = 0;
+    for (auto it = _dirty_keys.begin(); it != _dirty_keys.end();) {
+        auto value = snapshot.find(*it);
+        if (value == nullptr) {
+            ESP_UTILS_LOGW("Skip removed NVS key(%s)", it->c_str());
+            it = _dirty_keys.erase(it);
+            continue;
+        }
+        if (!_backend->set(*it, *value)) {
+            ESP_UTILS_LOGE("Set key(%s) failed, drop it", it->c_str());
+            failed_num++;
+            it = _dirty_keys.erase(it);
+            continue;
+        }
+        written_num++;
+        it++;
+    }
+    _writes_failed += failed_num;
+
+    if (written_num > 0) {
+        // The written keys stay dirty if the commit fails, so they are retried in the next window
+        ESP_UTILS_CHECK_FALSE_RETURN(_backend->commit(), false, "Commit backend failed");
+        _writes_issued += written_num;
+        _commits++;
+    }
+    _dirty_keys.clear();
 
-    ESP_UTILS_CHECK_ERROR_RETURN(nvs_erase_all(nvs_handle), false, "Erase NVS failed");
-    ESP_UTILS_CHECK_ERROR_RETURN(nvs_commit(nvs_handle), false, "Commit NVS failed");
+    ESP_UTILS_CHECK_FALSE_RETURN(failed_num == 0, false, "Failed to write %d keys", static_cast<int>(failed_num));
 
     return true;
 }
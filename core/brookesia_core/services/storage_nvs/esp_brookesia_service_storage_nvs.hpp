@@ -6,12 +6,19 @@
 #pragma once
 
 #include <bitset>
+#include <atomic>
+#include <chrono>
 #include <queue>
+#include <set>
+#include <functional>
 #include <future>
 #include <variant>
 #include <string>
+#include <vector>
 #include "boost/thread.hpp"
 #include "boost/signals2.hpp"
+#include "esp_brookesia_service_storage_nvs_backend.hpp"
+#include "esp_brookesia_service_storage_nvs_params.hpp"
 
 namespace esp_brookesia::services {
 
@@ -19,13 +26,17 @@ constexpr size_t NVS_VALUE_STR_MAX_LEN = 128;
 
 class StorageNVS {
 public:
-    using Key = std::string;
-    using Value = std::variant<int, std::string>;
+    using Key = StorageNVSBackend::Key;
+    using Value = StorageNVSBackend::Value;
+    using Blob = StorageNVSBackend::Blob;
+    using KeyID = uint32_t;
+    using ValueParser = std::function<bool(const std::string &str, Value &value)>;
 
     enum class Operation {
         UpdateNVS,
         UpdateParam,
         EraseNVS,
+        FlushNVS,
         Max,
     };
 
@@ -35,10 +46,22 @@ public:
         const void *sender;
         Operation operation;
         Key key;
+        std::vector<Key> keys;  /*!< Keys changed by an `UpdateParam` reload, the notification is batched */
     };
     using EventFuture = std::future<bool>;
     using EventSignal = boost::signals2::signal<void(const Event &event)>;
 
+    /**
+     * @brief Statistics of the write-back to NVS
+     */
+    struct WriteStats {
+        size_t writes_requested;    /*!< Number of `UpdateNVS` requests */
+        size_t writes_issued;       /*!< Number of keys actually written to NVS */
+        size_t writes_coalesced;    /*!< Number of requests merged into a pending write of the same key */
+        size_t writes_failed;       /*!< Number of keys dropped because the backend failed to write them */
+        size_t commits;             /*!< Number of NVS commits */
+    };
+
     StorageNVS(const StorageNVS &) = delete;
     StorageNVS(StorageNVS &&) = delete;
     ~StorageNVS() = default;
@@ -46,15 +69,97 @@ public:
     StorageNVS &operator=(const StorageNVS &) = delete;
     StorageNVS &operator=(StorageNVS &&) = delete;
 
-    bool begin();
+    /**
+     * @brief Start the storage thread and load all the parameters from the backend
+     *
+     * @param backend The persistence layer, use `StorageNVSFlashBackend` if it is `nullptr`
+     *
+     * @return true if success, otherwise false
+     */
+    bool begin(std::shared_ptr<StorageNVSBackend> backend = nullptr);
+    /**
+     * @brief Start with the default `StorageNVSFlashBackend`, whose keys in `float_keys` may hold a float
+     *
+     * @param float_keys The keys which may hold a float, see `StorageNVSFlashBackend`
+     *
+     * @return true if success, otherwise false
+     */
+    bool begin(const std::vector<Key> &float_keys);
+    /**
+     * @brief Write back the pending keys, stop the storage thread and release the backend, so `begin()` can be
+     *        called again. The local parameters are cleared and all the slots are disconnected.
+     *
+     * @return true if success, otherwise false
+     */
+    bool del();
 
     bool sendEvent(const Event &event, EventFuture *future = nullptr);
 
+    /**
+     * @brief Update a parameter in memory, it is written back to the backend in the next write-back window
+     *
+     * @return false if the backend does not support the value (e.g. a float on a key which is not a float key of
+     *         `StorageNVSFlashBackend`), the parameter is left unchanged in this case
+     */
     bool setLocalParam(const Key &key, const Value &value, const void *sender = nullptr, EventFuture *future = nullptr);
     bool getLocalParam(const Key &key, Value &value);
+    /**
+     * @brief Pin the current version of the local parameters without locking. The references (e.g. the
+     *        `std::string_view` from `getString()`) stay valid while the snapshot is alive, even if the parameters are
+     *        updated in the meantime. Keep a snapshot only as long as needed, since its version can not be freed.
+     *
+     * @return The snapshot of the local parameters
+     */
+    StorageNVSParams::Snapshot getParamsSnapshot() const;
+    /**
+     * @brief Convert a key which was stored as a string (e.g. "3.5") to its native type. The converted value
+     *        replaces the string in the backend with the next write-back. A key which is not a string is considered
+     *        to be migrated already. A key migrated to a float must be supported by the backend, e.g.
+     *        one of the `float_keys` given to `begin()`, otherwise the migration fails and the string is kept.
+     *
+     * @param key The key to migrate
+     * @param parser The function to parse the string, e.g. `parseFloatString()`
+     * @param sender The sender of the `UpdateNVS` event
+     * @param future The future to wait for the write-back
+     *
+     * @return true if success or already migrated, otherwise false
+     */
+    bool migrateLocalParam(
+        const Key &key, const ValueParser &parser, const void *sender = nullptr, EventFuture *future = nullptr
+    );
     bool eraseNVS(const void *sender = nullptr, EventFuture *future = nullptr);
+    bool flushNVS(const void *sender = nullptr, EventFuture *future = nullptr);
+
+    WriteStats getWriteStats() const;
+
+    std::shared_ptr<StorageNVSBackend> getBackend() const
+    {
+        return _backend;
+    }
 
     boost::signals2::connection connectEventSignal(EventSignal::slot_type slot);
+    /**
+     * @brief Connect a slot which is only called when one of the given keys changes, i.e. an `UpdateNVS` event of
+     *        the key or an `UpdateParam` reload which changes it. A reload is delivered once per slot with
+     *        `Event::keys` set to the changed keys among the subscribed ones.
+     *
+     * @param keys The keys to subscribe to
+     * @param slot The slot to connect
+     *
+     * @return The connection of the slot
+     */
+    boost::signals2::connection connectKeyEventSignal(const std::vector<Key> &keys, EventSignal::slot_type slot);
+    boost::signals2::connection connectKeyEventSignal(const Key &key, EventSignal::slot_type slot)
+    {
+        return connectKeyEventSignal(std::vector<Key>{key}, slot);
+    }
+
+    KeyID internKey(const Key &key);
+
+    static bool parseIntString(const std::string &str, Value &value);
+    static bool parseFloatString(const std::string &str, Value &value);
+    static bool parseInt64String(const std::string &str, Value &value);
+    static bool parseBlobString(const std::string &str, Value &value);
 
     static StorageNVS &requestInstance()
     {
@@ -69,21 +174,47 @@ private:
         std::shared_ptr<EventPromise> promise;
     };
 
+    struct KeySubscription {
+        std::vector<KeyID> key_ids;
+        EventSignal signal;
+    };
+    using KeySubscriptionPtr = std::shared_ptr<KeySubscription>;
+
     StorageNVS() = default;
 
     bool processEvent(const Event &event);
     bool doEventOperationUpdateNVS(const Key &key);
-    bool doEventOperationUpdateParam();
+    bool doEventOperationUpdateParam(std::vector<Key> &changed_keys);
     bool doEventOperationEraseNVS();
+    bool doEventOperationFlushNVS();
+
+    std::shared_ptr<StorageNVSBackend> _backend;
 
-    std::map<Key, Value> _local_params;
-    std::mutex _params_mutex;
+    StorageNVSParams _local_params;
 
     std::queue<EventWrapper> _event_queue;
     std::mutex _event_mutex;
     std::condition_variable _event_cv;
     boost::thread _event_thread;
+    bool _is_event_thread_stopping = false;
     EventSignal _event_signal;
+
+    void emitKeyEventSignal(const Event &event);
+
+    // Keys are interned to small IDs, the subscriptions of a key are found by indexing with its ID
+    std::mutex _key_mutex;
+    std::map<Key, KeyID, std::less<>> _key_ids;
+    std::vector<std::vector<KeySubscriptionPtr>> _key_subscriptions;
+
+    // Only accessed by the event thread
+    std::set<Key> _dirty_keys;
+    std::chrono::steady_clock::time_point _dirty_flush_deadline;
+
+    std::atomic<size_t> _writes_requested = 0;
+    std::atomic<size_t> _writes_issued = 0;
+    std::atomic<size_t> _writes_coalesced = 0;
+    std::atomic<size_t> _writes_failed = 0;
+    std::atomic<size_t> _commits = 0;
 };
 
 } // namespace esp_brookesia::services
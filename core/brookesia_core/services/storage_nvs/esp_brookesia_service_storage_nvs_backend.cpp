@@ -0,0 +1,134 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <algorithm>
+#include <cstdio>
+#include "private/esp_brookesia_service_storage_nvs_utils.hpp"
+#include "esp_brookesia_service_storage_nvs_backend.hpp"
+
+namespace esp_brookesia::services {
+
+bool StorageNVSBackend::init()
+{
+    return measureOperation(Operation::Init, [this]() {
+        return doInit();
+    });
+}
+
+bool StorageNVSBackend::load(Params &params)
+{
+    return measureOperation(Operation::Load, [&]() {
+        return doLoad(params);
+    });
+}
+
+bool StorageNVSBackend::set(const Key &key, const Value &value)
+{
+    return measureOperation(Operation::Set, [&]() {
+        return doSet(key, value);
+    });
+}
+
+bool StorageNVSBackend::commit()
+{
+    return measureOperation(Operation::Commit, [this]() {
+        return doCommit();
+    });
+}
+
+bool StorageNVSBackend::eraseAll()
+{
+    return measureOperation(Operation::EraseAll, [this]() {
+        return doEraseAll();
+    });
+}
+
+StorageNVSBackend::Stats StorageNVSBackend::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_stats_mutex);
+
+    return _stats;
+}
+
+void StorageNVSBackend::resetStats()
+{
+    std::lock_guard<std::mutex> lock(_stats_mutex);
+
+    _stats = {};
+}
+
+void StorageNVSBackend::dumpStats() const
+{
+    auto stats = getStats();
+
+    ESP_UTILS_LOGI("Backend(%s) operation latency:", getName());
+    for (size_t i = 0; i < stats.size(); i++) {
+        auto &operation_stats = stats[i];
+        if (operation_stats.count == 0) {
+            continue;
+        }
+        ESP_UTILS_LOGI(
+            "\t- %s: count(%d), fail(%d), avg(%d us), max(%d us)", getOperationName(static_cast<Operation>(i)),
+            static_cast<int>(operation_stats.count), static_cast<int>(operation_stats.fail_count),
+            static_cast<int>(operation_stats.total_us / operation_stats.count), static_cast<int>(operation_stats.max_us)
+        );
+    }
+}
+
+const char *StorageNVSBackend::getOperationName(Operation operation)
+{
+    switch (operation) {
+    case Operation::Init:
+        return "Init";
+    case Operation::Load:
+        return "Load";
+    case Operation::Set:
+        return "Set";
+    case Operation::Commit:
+        return "Commit";
+    case Operation::EraseAll:
+        return "EraseAll";
+    case Operation::Compact:
+        return "Compact";
+    default:
+        return "Unknown";
+    }
+}
+
+std::string StorageNVSBackend::getValueString(const Value &value)
+{
+    if (std::holds_alternative<int>(value)) {
+        return std::to_string(std::get<int>(value));
+    } else if (std::holds_alternative<std::string>(value)) {
+        return std::get<std::string>(value);
+    } else if (std::holds_alternative<float>(value)) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(std::get<float>(value)));
+        return buffer;
+    } else if (std::holds_alternative<int64_t>(value)) {
+        return std::to_string(std::get<int64_t>(value));
+    } else if (std::holds_alternative<Blob>(value)) {
+        return "blob(" + std::to_string(std::get<Blob>(value).size()) + " bytes)";
+    }
+
+    return "unknown";
+}
+
+void StorageNVSBackend::recordOperation(Operation operation, uint64_t elapsed_us, bool success)
+{
+    ESP_UTILS_CHECK_FALSE_EXIT(operation < Operation::Max, "Invalid operation(%d)", static_cast<int>(operation));
+
+    std::lock_guard<std::mutex> lock(_stats_mutex);
+
+    auto &operation_stats = _stats[static_cast<size_t>(operation)];
+    operation_stats.count++;
+    if (!success) {
+        operation_stats.fail_count++;
+    }
+    operation_stats.total_us += elapsed_us;
+    operation_stats.max_us = std::max(operation_stats.max_us, static_cast<uint32_t>(elapsed_us));
+}
+
+} // namespace esp_brookesia::services
@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace esp_brookesia::services {
+
+/**
+ * @brief Persistence layer of `StorageNVS`. All the operations are called from the storage thread only, a flush writes
+ *        several keys with `set()` and then makes them durable with a single `commit()`.
+ *
+ *        The public functions measure the latency of each call and forward it to the `do*()` implementation.
+ */
+class StorageNVSBackend {
+public:
+    using Key = std::string;
+    using Blob = std::vector<uint8_t>;
+    /**
+     * @brief Keep the existing alternatives first, so the indexes of `int` and `std::string` never change
+     */
+    using Value = std::variant<int, std::string, float, int64_t, Blob>;
+    using Params = std::map<Key, Value>;
+
+    enum class Operation {
+        Init,
+        Load,
+        Set,
+        Commit,
+        EraseAll,
+        Compact,
+        Max,
+    };
+
+    struct OperationStats {
+        size_t count;
+        size_t fail_count;
+        uint64_t total_us;
+        uint32_t max_us;
+    };
+    using Stats = std::array<OperationStats, static_cast<size_t>(Operation::Max)>;
+
+    StorageNVSBackend() = default;
+    virtual ~StorageNVSBackend() = default;
+
+    StorageNVSBackend(const StorageNVSBackend &) = delete;
+    StorageNVSBackend &operator=(const StorageNVSBackend &) = delete;
+
+    bool init();
+    bool load(Params &params);
+    bool set(const Key &key, const Value &value);
+    bool commit();
+    bool eraseAll();
+
+    Stats getStats() const;
+    void resetStats();
+    void dumpStats() const;
+
+    virtual const char *getName() const = 0;
+    /**
+     * @brief Check if the value can be stored under the key, it is called before the value is accepted in memory, so
+     *        the caller gets the error instead of a failed write-back
+     */
+    virtual bool checkValueSupported(const Key &key, const Value &value) const
+    {
+        return true;
+    }
+
+    static const char *getOperationName(Operation operation);
+    static std::string getValueString(const Value &value);
+
+protected:
+    /**
+     * @brief Run `func` and record its latency as `operation`, also used by the subclasses for extra operations
+     */
+    template <typename Func>
+    bool measureOperation(Operation operation, Func &&func)
+    {
+        auto start = std::chrono::steady_clock::now();
+        bool ret = func();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        recordOperation(
+            operation, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(), ret
+        );
+        return ret;
+    }
+
+    virtual bool doInit() = 0;
+    virtual bool doLoad(Params &params) = 0;
+    virtual bool doSet(const Key &key, const Value &value) = 0;
+    virtual bool doCommit() = 0;
+    virtual bool doEraseAll() = 0;
+
+private:
+    void recordOperation(Operation operation, uint64_t elapsed_us, bool success);
+
+    mutable std::mutex _stats_mutex;
+    Stats _stats = {};
+};
+
+} // namespace esp_brookesia::services
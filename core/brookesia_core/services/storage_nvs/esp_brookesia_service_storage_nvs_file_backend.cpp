@@ -0,0 +1,467 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <cstring>
+#include <vector>
+#include <unistd.h>
+#include "private/esp_brookesia_service_storage_nvs_utils.hpp"
+#include "esp_brookesia_service_storage_nvs_file_backend.hpp"
+
+/**
+ * Log layout, all integers are stored in the native byte order (little-endian on all supported targets):
+ *
+ *   header: magic(4) version(1) reserved(3)
+ *   record: type(1) reserved(1) key_len(2) value_len(4) key(key_len) value(value_len)
+ */
+#define LOG_MAGIC                   "BSKV"
+#define LOG_MAGIC_SIZE              (4)
+#define LOG_VERSION                 (1)
+#define LOG_HEADER_SIZE             (8)
+#define LOG_RECORD_HEADER_SIZE      (8)
+
+#define LOG_RECORD_TYPE_INT         (1)
+#define LOG_RECORD_TYPE_STR         (2)
+#define LOG_RECORD_TYPE_FLOAT       (3)
+#define LOG_RECORD_TYPE_INT64       (4)
+#define LOG_RECORD_TYPE_BLOB        (5)
+#define LOG_RECORD_TYPE_COMMIT      (0xC0)
+
+#define LOG_COMPACT_TEMP_SUFFIX     ".tmp"
+
+namespace esp_brookesia::services {
+
+static void append_log_header(std::string &log)
+{
+    char header[LOG_HEADER_SIZE] = {};
+    memcpy(header, LOG_MAGIC, LOG_MAGIC_SIZE);
+    header[LOG_MAGIC_SIZE] = LOG_VERSION;
+    log.append(header, sizeof(header));
+}
+
+static uint8_t get_record_type(const StorageNVSBackend::Value &value)
+{
+    if (std::holds_alternative<int>(value)) {
+        return LOG_RECORD_TYPE_INT;
+    } else if (std::holds_alternative<std::string>(value)) {
+        return LOG_RECORD_TYPE_STR;
+    } else if (std::holds_alternative<float>(value)) {
+        return LOG_RECORD_TYPE_FLOAT;
+    } else if (std::holds_alternative<int64_t>(value)) {
+        return LOG_RECORD_TYPE_INT64;
+    }
+
+    return LOG_RECORD_TYPE_BLOB;
+}
+
+static size_t get_value_size(const StorageNVSBackend::Value &value)
+{
+    if (std::holds_alternative<int>(value)) {
+        return sizeof(int32_t);
+    } else if (std::holds_alternative<std::string>(value)) {
+        return std::get<std::string>(value).size();
+    } else if (std::holds_alternative<float>(value)) {
+        return sizeof(float);
+    } else if (std::holds_alternative<int64_t>(value)) {
+        return sizeof(int64_t);
+    }
+
+    return std::get<StorageNVSBackend::Blob>(value).size();
+}
+
+static bool write_log_file(FILE *file, const std::string &log, bool sync)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        fwrite(log.data(), 1, log.size(), file) == log.size(), false, "Write log file failed"
+    );
+    ESP_UTILS_CHECK_FALSE_RETURN(fflush(file) == 0, false, "Flush log file failed");
+    if (sync) {
+        ESP_UTILS_CHECK_FALSE_RETURN(fsync(fileno(file)) == 0, false, "Sync log file failed");
+    }
+
+    return true;
+}
+
+StorageNVSFileBackend::StorageNVSFileBackend(const Config &config):
+    _config(config)
+{
+}
+
+StorageNVSFileBackend::~StorageNVSFileBackend()
+{
+    closeLog();
+}
+
+bool StorageNVSFileBackend::compact()
+{
+    return measureOperation(Operation::Compact, [this]() {
+        return doCompact();
+    });
+}
+
+bool StorageNVSFileBackend::doInit()
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    ESP_UTILS_CHECK_FALSE_RETURN(_file == nullptr, false, "Already initialized");
+    ESP_UTILS_CHECK_FALSE_RETURN(!_config.path.empty(), false, "Invalid log path");
+
+    // A compaction was interrupted after the log was removed, the temporary file holds all the live keys
+    std::string temp_path = _config.path + LOG_COMPACT_TEMP_SUFFIX;
+    if ((access(_config.path.c_str(), F_OK) != 0) && (access(temp_path.c_str(), F_OK) == 0)) {
+        ESP_UTILS_LOGW("Restore log file(%s) from the interrupted compaction", _config.path.c_str());
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            rename(temp_path.c_str(), _config.path.c_str()) == 0, false, "Restore log file failed"
+        );
+    }
+
+    if (!readLog()) {
+        ESP_UTILS_LOGW("Log file(%s) is missing or invalid, create a new one", _config.path.c_str());
+        ESP_UTILS_CHECK_FALSE_RETURN(resetLog(), false, "Reset log file failed");
+    }
+    ESP_UTILS_CHECK_FALSE_RETURN(openLog(), false, "Open log file failed");
+
+    return true;
+}
+
+bool StorageNVSFileBackend::doLoad(Params &params)
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    ESP_UTILS_CHECK_FALSE_RETURN(_file != nullptr, false, "Not initialized");
+
+    for (auto &[key, value] : _params) {
+        params[key] = value;
+    }
+
+    ESP_UTILS_LOGI("Found %d keys in log file(%s)", static_cast<int>(_params.size()), _config.path.c_str());
+
+    return true;
+}
+
+bool StorageNVSFileBackend::doSet(const Key &key, const Value &value)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(_file != nullptr, false, "Not initialized");
+    ESP_UTILS_CHECK_FALSE_RETURN(key.size() <= UINT16_MAX, false, "Key(%s) is too long", key.c_str());
+
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        get_value_size(value) <= UINT32_MAX, false, "Value of key(%s) is too large", key.c_str()
+    );
+
+    appendRecord(_pending_log, get_record_type(value), key, &value);
+    _pending_params[key] = value;
+
+    return true;
+}
+
+bool StorageNVSFileBackend::doCommit()
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(_file != nullptr, false, "Not initialized");
+
+    if (_pending_log.empty()) {
+        return true;
+    }
+
+    size_t pending_log_size = _pending_log.size();
+    appendRecord(_pending_log, LOG_RECORD_TYPE_COMMIT, Key(), nullptr);
+    if (!write_log_file(_file, _pending_log, _config.sync_on_commit)) {
+        ESP_UTILS_LOGE("Write log file failed, roll back to the last commit");
+        // Keep the records pending so the next commit retries them, and drop the torn bytes from the file, otherwise
+        // the next commit is appended after them and the replay stops there
+        _pending_log.resize(pending_log_size);
+        ESP_UTILS_CHECK_FALSE_RETURN(rollbackLog(), false, "Roll back log file failed");
+        return false;
+    }
+    _log_size += _pending_log.size();
+    _pending_log.clear();
+
+    for (auto &[key, value] : _pending_params) {
+        _params[key] = std::move(value);
+    }
+    _pending_params.clear();
+
+    if ((_log_size > _config.compact_min_size) && (_log_size > _config.compact_ratio * getLiveSize())) {
+        ESP_UTILS_LOGD("Log size(%d) exceeds the threshold, compact it", static_cast<int>(_log_size));
+        if (!compact()) {
+            ESP_UTILS_LOGE("Compact log file failed");
+        }
+    }
+
+    return true;
+}
+
+bool StorageNVSFileBackend::doEraseAll()
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(_file != nullptr, false, "Not initialized");
+
+    _pending_log.clear();
+    _pending_params.clear();
+    _params.clear();
+
+    closeLog();
+    ESP_UTILS_CHECK_FALSE_RETURN(resetLog(), false, "Reset log file failed");
+    ESP_UTILS_CHECK_FALSE_RETURN(openLog(), false, "Open log file failed");
+
+    return true;
+}
+
+bool StorageNVSFileBackend::doCompact()
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    ESP_UTILS_CHECK_FALSE_RETURN(_file != nullptr, false, "Not initialized");
+
+    std::string log;
+    log.reserve(LOG_HEADER_SIZE + getLiveSize() + LOG_RECORD_HEADER_SIZE);
+    append_log_header(log);
+    for (auto &[key, value] : _params) {
+        appendRecord(log, get_record_type(value), key, &value);
+    }
+    appendRecord(log, LOG_RECORD_TYPE_COMMIT, Key(), nullptr);
+
+    // Write the live keys to a temporary file and atomically replace the log with it
+    std::string temp_path = _config.path + LOG_COMPACT_TEMP_SUFFIX;
+    {
+        FILE *temp_file = fopen(temp_path.c_str(), "wb");
+        ESP_UTILS_CHECK_NULL_RETURN(temp_file, false, "Open temporary file(%s) failed", temp_path.c_str());
+        esp_utils::function_guard close_guard([&]() {
+            fclose(temp_file);
+        });
+        ESP_UTILS_CHECK_FALSE_RETURN(write_log_file(temp_file, log, true), false, "Write temporary file failed");
+    }
+
+    closeLog();
+    if (rename(temp_path.c_str(), _config.path.c_str()) != 0) {
+        // FAT refuses to rename onto an existing file, so remove the log first
+        if (remove(_config.path.c_str()) != 0) {
+            ESP_UTILS_LOGE("Remove log file(%s) failed", _config.path.c_str());
+            remove(temp_path.c_str());
+            ESP_UTILS_CHECK_FALSE_RETURN(openLog(), false, "Reopen log file failed");
+            return false;
+        }
+        // Keep the temporary file if it fails, `doInit()` restores the log from it
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            rename(temp_path.c_str(), _config.path.c_str()) == 0, false, "Rename temporary file(%s) failed",
+            temp_path.c_str()
+        );
+    }
+    ESP_UTILS_CHECK_FALSE_RETURN(openLog(), false, "Reopen log file failed");
+
+    ESP_UTILS_LOGD(
+        "Compact log file(%s): %d -> %d bytes", _config.path.c_str(), static_cast<int>(_log_size),
+        static_cast<int>(log.size())
+    );
+    _log_size = log.size();
+
+    return true;
+}
+
+bool StorageNVSFileBackend::readLog()
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    std::vector<uint8_t> log;
+    {
+        FILE *file = fopen(_config.path.c_str(), "rb");
+        if (file == nullptr) {
+            return false;
+        }
+        esp_utils::function_guard close_guard([&]() {
+            fclose(file);
+        });
+
+        uint8_t buffer[256];
+        size_t read_size = 0;
+        while ((read_size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            log.insert(log.end(), buffer, buffer + read_size);
+        }
+    }
+
+    ESP_UTILS_CHECK_FALSE_RETURN(log.size() >= LOG_HEADER_SIZE, false, "Log file is too small");
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        (memcmp(log.data(), LOG_MAGIC, LOG_MAGIC_SIZE) == 0) && (log[LOG_MAGIC_SIZE] == LOG_VERSION), false,
+        "Invalid log header"
+    );
+
+    // Replay the records, only the ones followed by a commit marker are applied
+    Params params;
+    Params pending_params;
+    size_t offset = LOG_HEADER_SIZE;
+    size_t committed_size = LOG_HEADER_SIZE;
+    while (offset + LOG_RECORD_HEADER_SIZE <= log.size()) {
+        uint8_t type = log[offset];
+        uint16_t key_len = 0;
+        uint32_t value_len = 0;
+        memcpy(&key_len, &log[offset + 2], sizeof(key_len));
+        memcpy(&value_len, &log[offset + 4], sizeof(value_len));
+
+        size_t record_size = LOG_RECORD_HEADER_SIZE + key_len + value_len;
+        if (offset + record_size > log.size()) {
+            break;
+        }
+
+        const char *key_data = reinterpret_cast<const char *>(&log[offset + LOG_RECORD_HEADER_SIZE]);
+        const char *value_data = key_data + key_len;
+        bool is_valid = true;
+        switch (type) {
+        case LOG_RECORD_TYPE_INT: {
+            int32_t value_int = 0;
+            if (value_len != sizeof(value_int)) {
+                is_valid = false;
+                break;
+            }
+            memcpy(&value_int, value_data, sizeof(value_int));
+            pending_params[Key(key_data, key_len)] = Value(static_cast<int>(value_int));
+            break;
+        }
+        case LOG_RECORD_TYPE_STR:
+            pending_params[Key(key_data, key_len)] = Value(std::string(value_data, value_len));
+            break;
+        case LOG_RECORD_TYPE_FLOAT: {
+            float value_float = 0;
+            if (value_len != sizeof(value_float)) {
+                is_valid = false;
+                break;
+            }
+            memcpy(&value_float, value_data, sizeof(value_float));
+            pending_params[Key(key_data, key_len)] = Value(value_float);
+            break;
+        }
+        case LOG_RECORD_TYPE_INT64: {
+            int64_t value_int64 = 0;
+            if (value_len != sizeof(value_int64)) {
+                is_valid = false;
+                break;
+            }
+            memcpy(&value_int64, value_data, sizeof(value_int64));
+            pending_params[Key(key_data, key_len)] = Value(value_int64);
+            break;
+        }
+        case LOG_RECORD_TYPE_BLOB:
+            pending_params[Key(key_data, key_len)] = Value(Blob(value_data, value_data + value_len));
+            break;
+        case LOG_RECORD_TYPE_COMMIT:
+            for (auto &[key, value] : pending_params) {
+                params[key] = std::move(value);
+            }
+            pending_params.clear();
+            committed_size = offset + record_size;
+            break;
+        default:
+            is_valid = false;
+            break;
+        }
+        if (!is_valid) {
+            ESP_UTILS_LOGW("Invalid record(type: %d) at offset(%d)", type, static_cast<int>(offset));
+            break;
+        }
+        offset += record_size;
+    }
+
+    // Drop the uncommitted or broken tail, so the next commit is appended right after the last valid one
+    if (committed_size < log.size()) {
+        ESP_UTILS_LOGW(
+            "Drop %d bytes of uncommitted records in log file(%s)", static_cast<int>(log.size() - committed_size),
+            _config.path.c_str()
+        );
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            truncate(_config.path.c_str(), committed_size) == 0, false, "Truncate log file failed"
+        );
+    }
+
+    _params = std::move(params);
+    _log_size = committed_size;
+
+    return true;
+}
+
+bool StorageNVSFileBackend::resetLog()
+{
+    std::string log;
+    append_log_header(log);
+
+    FILE *file = fopen(_config.path.c_str(), "wb");
+    ESP_UTILS_CHECK_NULL_RETURN(file, false, "Create log file(%s) failed", _config.path.c_str());
+    esp_utils::function_guard close_guard([&]() {
+        fclose(file);
+    });
+    ESP_UTILS_CHECK_FALSE_RETURN(write_log_file(file, log, true), false, "Write log header failed");
+
+    _params.clear();
+    _log_size = log.size();
+
+    return true;
+}
+
+bool StorageNVSFileBackend::rollbackLog()
+{
+    closeLog();
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        truncate(_config.path.c_str(), _log_size) == 0, false, "Truncate log file(%s) failed", _config.path.c_str()
+    );
+    ESP_UTILS_CHECK_FALSE_RETURN(openLog(), false, "Reopen log file failed");
+
+    return true;
+}
+
+bool StorageNVSFileBackend::openLog()
+{
+    _file = fopen(_config.path.c_str(), "ab");
+    ESP_UTILS_CHECK_NULL_RETURN(_file, false, "Open log file(%s) failed", _config.path.c_str());
+
+    return true;
+}
+
+void StorageNVSFileBackend::closeLog()
+{
+    if (_file != nullptr) {
+        fclose(_file);
+        _file = nullptr;
+    }
+}
+
+size_t StorageNVSFileBackend::getLiveSize() const
+{
+    size_t live_size = 0;
+    for (auto &[key, value] : _params) {
+        live_size += LOG_RECORD_HEADER_SIZE + key.size() + get_value_size(value);
+    }
+
+    return live_size;
+}
+
+void StorageNVSFileBackend::appendRecord(std::string &log, uint8_t type, const Key &key, const Value *value)
+{
+    uint16_t key_len = static_cast<uint16_t>(key.size());
+    uint32_t value_len = 0;
+    int32_t value_int = 0;
+    const char *value_data = nullptr;
+    if (value != nullptr) {
+        value_len = static_cast<uint32_t>(get_value_size(*value));
+        if (std::holds_alternative<int>(*value)) {
+            value_int = static_cast<int32_t>(std::get<int>(*value));
+            value_data = reinterpret_cast<const char *>(&value_int);
+        } else if (std::holds_alternative<std::string>(*value)) {
+            value_data = std::get<std::string>(*value).data();
+        } else if (std::holds_alternative<float>(*value)) {
+            value_data = reinterpret_cast<const char *>(&std::get<float>(*value));
+        } else if (std::holds_alternative<int64_t>(*value)) {
+            value_data = reinterpret_cast<const char *>(&std::get<int64_t>(*value));
+        } else {
+            value_data = reinterpret_cast<const char *>(std::get<Blob>(*value).data());
+        }
+    }
+
+    char header[LOG_RECORD_HEADER_SIZE] = {};
+    header[0] = static_cast<char>(type);
+    memcpy(&header[2], &key_len, sizeof(key_len));
+    memcpy(&header[4], &value_len, sizeof(value_len));
+    log.append(header, sizeof(header));
+    log.append(key.data(), key_len);
+    if ((value_data != nullptr) && (value_len > 0)) {
+        log.append(value_data, value_len);
+    }
+}
+
+} // namespace esp_brookesia::services
@@ -0,0 +1,72 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include "esp_brookesia_service_storage_nvs_backend.hpp"
+
+namespace esp_brookesia::services {
+
+/**
+ * @brief Backend based on an append-only log file, which works on any POSIX file system (e.g. a Linux host or a
+ *        mounted FAT/LittleFS partition).
+ *
+ *        Each `set()` is appended as a record and each `commit()` appends a commit marker, so records after the last
+ *        marker (e.g. a write torn by power loss) are dropped when the file is loaded. The log is rewritten with only
+ *        the live keys once it grows beyond `compact_ratio` times their size.
+ */
+class StorageNVSFileBackend: public StorageNVSBackend {
+public:
+    struct Config {
+        std::string path;
+        size_t compact_min_size = 16 * 1024;    /*!< Never compact a log smaller than this size */
+        size_t compact_ratio = 2;               /*!< Compact when the log size exceeds this ratio of the live size */
+        bool sync_on_commit = true;             /*!< Call `fsync()` on every commit */
+    };
+
+    StorageNVSFileBackend(const Config &config);
+    ~StorageNVSFileBackend() override;
+
+    bool compact();
+
+    size_t getLogSize() const
+    {
+        return _log_size;
+    }
+
+    const char *getName() const override
+    {
+        return "file";
+    }
+
+protected:
+    bool doInit() override;
+    bool doLoad(Params &params) override;
+    bool doSet(const Key &key, const Value &value) override;
+    bool doCommit() override;
+    bool doEraseAll() override;
+
+private:
+    bool doCompact();
+    bool readLog();
+    bool resetLog();
+    bool rollbackLog();
+    bool openLog();
+    void closeLog();
+    size_t getLiveSize() const;
+
+    static void appendRecord(std::string &log, uint8_t type, const Key &key, const Value *value);
+
+    Config _config;
+    FILE *_file = nullptr;
+    size_t _log_size = 0;
+    Params _params;
+    Params _pending_params;
+    std::string _pending_log;
+};
+
+} // namespace esp_brookesia::services
@@ -0,0 +1,270 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <cstring>
+#include <map>
+#include "nvs_flash.h"
+#include "private/esp_brookesia_service_storage_nvs_utils.hpp"
+#include "esp_brookesia_service_storage_nvs_flash_backend.hpp"
+
+namespace esp_brookesia::services {
+
+static const std::map<nvs_type_t, const char *> type_str_pair = {
+    { NVS_TYPE_I8, "i8" },
+    { NVS_TYPE_U8, "u8" },
+    { NVS_TYPE_U16, "u16" },
+    { NVS_TYPE_I16, "i16" },
+    { NVS_TYPE_U32, "u32" },
+    { NVS_TYPE_I32, "i32" },
+    { NVS_TYPE_U64, "u64" },
+    { NVS_TYPE_I64, "i64" },
+    { NVS_TYPE_STR, "str" },
+    { NVS_TYPE_BLOB, "blob" },
+    { NVS_TYPE_ANY, "any" },
+};
+
+StorageNVSFlashBackend::StorageNVSFlashBackend(
+    const char *partition, const char *name_space, const std::vector<Key> &float_keys
+):
+    _partition(partition),
+    _name_space(name_space),
+    _float_keys(float_keys.begin(), float_keys.end())
+{
+}
+
+StorageNVSFlashBackend::~StorageNVSFlashBackend()
+{
+    if (_is_opened) {
+        nvs_close(_nvs_handle);
+    }
+}
+
+bool StorageNVSFlashBackend::doInit()
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    ESP_UTILS_CHECK_FALSE_RETURN(!_is_opened, false, "Already initialized");
+
+    // Initialize NVS flash
+    esp_err_t ret = nvs_flash_init_partition(_partition.c_str());
+    if ((ret == ESP_ERR_NVS_NO_FREE_PAGES) || (ret == ESP_ERR_NVS_NEW_VERSION_FOUND)) {
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            nvs_flash_erase_partition(_partition.c_str()) == ESP_OK, false, "Erase NVS flash failed"
+        );
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            nvs_flash_init_partition(_partition.c_str()) == ESP_OK, false, "Init NVS flash failed"
+        );
+    } else {
+        ESP_UTILS_CHECK_ERROR_RETURN(ret, false, "Initialize NVS flash failed");
+    }
+
+    // Create NVS namespace if not exists
+    ESP_UTILS_CHECK_ERROR_RETURN(
+        nvs_open_from_partition(_partition.c_str(), _name_space.c_str(), NVS_READWRITE, &_nvs_handle), false,
+        "Open NVS namespace failed"
+    );
+    _is_opened = true;
+    ESP_UTILS_CHECK_ERROR_RETURN(nvs_commit(_nvs_handle), false, "Commit NVS failed");
+
+    return true;
+}
+
+bool StorageNVSFlashBackend::doLoad(Params &params)
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    ESP_UTILS_CHECK_FALSE_RETURN(_is_opened, false, "Not initialized");
+
+    ESP_UTILS_LOGI("Finding keys in NVS...");
+
+    nvs_iterator_t it = NULL;
+    esp_err_t res = nvs_entry_find(_partition.c_str(), _name_space.c_str(), NVS_TYPE_ANY, &it);
+    while (res == ESP_OK) {
+        nvs_entry_info_t info;
+        res = nvs_entry_info(it, &info);
+        if (res != ESP_OK) {
+            ESP_UTILS_LOGE("Get key info failed");
+            break;
+        }
+
+        auto type_str_it = type_str_pair.find(info.type);
+        if (type_str_it == type_str_pair.end()) {
+            ESP_UTILS_LOGE("\t- Invalid NVS key(%s) type(%d)", info.key, static_cast<int>(info.type));
+            res = nvs_entry_next(&it);
+            continue;
+        }
+
+        Value value;
+        if (getValue(info.key, info.type, value)) {
+            ESP_UTILS_LOGI(
+                "\t- Found key(%s): type(%s), value(%s)", info.key, type_str_it->second, getValueString(value).c_str()
+            );
+            params[info.key] = std::move(value);
+            _key_types[info.key] = info.type;
+        }
+        res = nvs_entry_next(&it);
+    }
+    nvs_release_iterator(it);
+
+    ESP_UTILS_LOGI("Found %d keys in NVS", static_cast<int>(params.size()));
+
+    return true;
+}
+
+bool StorageNVSFlashBackend::getValue(const char *key, nvs_type_t type, Value &value)
+{
+    esp_err_t ret = ESP_OK;
+    switch (type) {
+    case NVS_TYPE_I32: {
+        int32_t value_int = 0;
+        ret = nvs_get_i32(_nvs_handle, key, &value_int);
+        value = static_cast<int>(value_int);
+        break;
+    }
+    case NVS_TYPE_U32: {
+        // NVS has no floating point type, a float is stored as its bit pattern. Only the declared keys are floats, the
+        // others are left to their writers
+        if (_float_keys.find(key) == _float_keys.end()) {
+            ESP_UTILS_LOGI("\t- Skip key(%s): u32 which is not a float key", key);
+            return false;
+        }
+        uint32_t value_bits = 0;
+        float value_float = 0;
+        ret = nvs_get_u32(_nvs_handle, key, &value_bits);
+        static_assert(sizeof(value_float) == sizeof(value_bits), "Unexpected float size");
+        memcpy(&value_float, &value_bits, sizeof(value_float));
+        value = value_float;
+        break;
+    }
+    case NVS_TYPE_I64: {
+        int64_t value_int64 = 0;
+        ret = nvs_get_i64(_nvs_handle, key, &value_int64);
+        value = value_int64;
+        break;
+    }
+    case NVS_TYPE_STR: {
+        // Query the length first, so the string is not limited by `NVS_VALUE_STR_MAX_LEN`
+        size_t len = 0;
+        ret = nvs_get_str(_nvs_handle, key, nullptr, &len);
+        if ((ret == ESP_OK) && (len > 0)) {
+            std::string value_str(len, '\0');
+            ret = nvs_get_str(_nvs_handle, key, value_str.data(), &len);
+            value_str.resize(len - 1);
+            value = std::move(value_str);
+        }
+        break;
+    }
+    case NVS_TYPE_BLOB: {
+        size_t len = 0;
+        ret = nvs_get_blob(_nvs_handle, key, nullptr, &len);
+        if (ret == ESP_OK) {
+            Blob value_blob(len);
+            ret = nvs_get_blob(_nvs_handle, key, value_blob.data(), &len);
+            value = std::move(value_blob);
+        }
+        break;
+    }
+    default:
+        ESP_UTILS_LOGI("\t- Skip key(%s): type(%d)", key, static_cast<int>(type));
+        return false;
+    }
+    ESP_UTILS_CHECK_ERROR_RETURN(ret, false, "\t- Get key(%s) value failed", key);
+
+    return true;
+}
+
+bool StorageNVSFlashBackend::checkValueSupported(const Key &key, const Value &value) const
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(
+        !std::holds_alternative<float>(value) || (_float_keys.find(key) != _float_keys.end()), false,
+        "Key(%s) is not a float key, it could not be loaded as a float", key.c_str()
+    );
+
+    return true;
+}
+
+bool StorageNVSFlashBackend::doSet(const Key &key, const Value &value)
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(_is_opened, false, "Not initialized");
+    ESP_UTILS_CHECK_FALSE_RETURN(checkValueSupported(key, value), false, "Unsupported value of key(%s)", key.c_str());
+
+    const char *key_str = key.c_str();
+    ESP_UTILS_LOGD("Set key(%s) value(%s)", key_str, getValueString(value).c_str());
+
+    nvs_type_t type = getValueType(value);
+    auto type_it = _key_types.find(key);
+    if ((type_it != _key_types.end()) && (type_it->second != type)) {
+        // The type of the key is changed (e.g. migrated from a string), erase the old entry first
+        ESP_UTILS_LOGW("Type of key(%s) is changed, erase the old one", key_str);
+        esp_err_t ret = nvs_erase_key(_nvs_handle, key_str);
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            (ret == ESP_OK) || (ret == ESP_ERR_NVS_NOT_FOUND), false, "Erase NVS key(%s) failed", key_str
+        );
+    }
+    ESP_UTILS_CHECK_ERROR_RETURN(setValue(key_str, value), false, "Set NVS parameter failed");
+    _key_types[key] = type;
+
+    return true;
+}
+
+esp_err_t StorageNVSFlashBackend::setValue(const char *key, const Value &value)
+{
+    if (std::holds_alternative<int>(value)) {
+        return nvs_set_i32(_nvs_handle, key, static_cast<int32_t>(std::get<int>(value)));
+    } else if (std::holds_alternative<std::string>(value)) {
+        return nvs_set_str(_nvs_handle, key, std::get<std::string>(value).c_str());
+    } else if (std::holds_alternative<float>(value)) {
+        uint32_t value_bits = 0;
+        float value_float = std::get<float>(value);
+        memcpy(&value_bits, &value_float, sizeof(value_bits));
+        return nvs_set_u32(_nvs_handle, key, value_bits);
+    } else if (std::holds_alternative<int64_t>(value)) {
+        return nvs_set_i64(_nvs_handle, key, std::get<int64_t>(value));
+    } else if (std::holds_alternative<Blob>(value)) {
+        auto &value_blob = std::get<Blob>(value);
+        return nvs_set_blob(_nvs_handle, key, value_blob.data(), value_blob.size());
+    }
+
+    ESP_UTILS_LOGE("Invalid NVS key(%s) value type", key);
+
+    return ESP_ERR_INVALID_ARG;
+}
+
+nvs_type_t StorageNVSFlashBackend::getValueType(const Value &value)
+{
+    if (std::holds_alternative<int>(value)) {
+        return NVS_TYPE_I32;
+    } else if (std::holds_alternative<std::string>(value)) {
+        return NVS_TYPE_STR;
+    } else if (std::holds_alternative<float>(value)) {
+        return NVS_TYPE_U32;
+    } else if (std::holds_alternative<int64_t>(value)) {
+        return NVS_TYPE_I64;
+    }
+
+    return NVS_TYPE_BLOB;
+}
+
+bool StorageNVSFlashBackend::doCommit()
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(_is_opened, false, "Not initialized");
+
+    ESP_UTILS_CHECK_ERROR_RETURN(nvs_commit(_nvs_handle), false, "Commit NVS failed");
+
+    return true;
+}
+
+bool StorageNVSFlashBackend::doEraseAll()
+{
+    ESP_UTILS_CHECK_FALSE_RETURN(_is_opened, false, "Not initialized");
+
+    ESP_UTILS_CHECK_ERROR_RETURN(nvs_erase_all(_nvs_handle), false, "Erase NVS failed");
+    ESP_UTILS_CHECK_ERROR_RETURN(nvs_commit(_nvs_handle), false, "Commit NVS failed");
+    _key_types.clear();
+
+    return true;
+}
+
+} // namespace esp_brookesia::services
@@ -0,0 +1,59 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "nvs.h"
+#include "esp_brookesia_service_storage_nvs_backend.hpp"
+
+namespace esp_brookesia::services {
+
+/**
+ * @brief Backend based on the `nvs_flash` component, the NVS handle stays open for the lifetime of the backend
+ *
+ *        NVS has no floating point type, so a float is stored as a u32. Only the keys given in `float_keys` may hold a
+ *        float, and only their u32 entries are loaded as floats, the u32 entries of other keys are skipped.
+ */
+class StorageNVSFlashBackend: public StorageNVSBackend {
+public:
+    StorageNVSFlashBackend(
+        const char *partition = NVS_DEFAULT_PART_NAME, const char *name_space = "storage",
+        const std::vector<Key> &float_keys = {}
+    );
+    ~StorageNVSFlashBackend() override;
+
+    const char *getName() const override
+    {
+        return "nvs_flash";
+    }
+    bool checkValueSupported(const Key &key, const Value &value) const override;
+
+protected:
+    bool doInit() override;
+    bool doLoad(Params &params) override;
+    bool doSet(const Key &key, const Value &value) override;
+    bool doCommit() override;
+    bool doEraseAll() override;
+
+private:
+    bool getValue(const char *key, nvs_type_t type, Value &value);
+    esp_err_t setValue(const char *key, const Value &value);
+
+    static nvs_type_t getValueType(const Value &value);
+
+    std::string _partition;
+    std::string _name_space;
+    std::set<Key, std::less<>> _float_keys;
+    nvs_handle_t _nvs_handle = 0;
+    bool _is_opened = false;
+    // NVS may keep entries of different types under the same key, so the old entry is erased when the type changes
+    std::map<Key, nvs_type_t> _key_types;
+};
+
+} // namespace esp_brookesia::services
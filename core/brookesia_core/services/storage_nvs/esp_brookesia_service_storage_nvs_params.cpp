@@ -0,0 +1,210 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <chrono>
+#include <thread>
+#include "private/esp_brookesia_service_storage_nvs_utils.hpp"
+#include "esp_brookesia_service_storage_nvs_params.hpp"
+
+#define GRACE_PERIOD_SPIN_COUNT     (64)
+#define GRACE_PERIOD_SLEEP_MS       (1)
+
+namespace esp_brookesia::services {
+
+StorageNVSParams::Snapshot::Snapshot(Snapshot &&other) noexcept:
+    _version(other._version)
+{
+    other._version = nullptr;
+}
+
+StorageNVSParams::Snapshot::~Snapshot()
+{
+    release();
+}
+
+StorageNVSParams::Snapshot &StorageNVSParams::Snapshot::operator=(Snapshot &&other) noexcept
+{
+    if (this != &other) {
+        release();
+        _version = other._version;
+        other._version = nullptr;
+    }
+
+    return *this;
+}
+
+const StorageNVSParams::Value *StorageNVSParams::Snapshot::find(std::string_view key) const
+{
+    ESP_UTILS_CHECK_NULL_RETURN(_version, nullptr, "Invalid snapshot");
+
+    auto it = _version->params.find(key);
+    if (it == _version->params.end()) {
+        return nullptr;
+    }
+
+    return &it->second;
+}
+
+bool StorageNVSParams::Snapshot::getInt(std::string_view key, int &value) const
+{
+    auto param = find(key);
+    if ((param == nullptr) || !std::holds_alternative<int>(*param)) {
+        return false;
+    }
+    value = std::get<int>(*param);
+
+    return true;
+}
+
+bool StorageNVSParams::Snapshot::getString(std::string_view key, std::string_view &value) const
+{
+    auto param = find(key);
+    if ((param == nullptr) || !std::holds_alternative<std::string>(*param)) {
+        return false;
+    }
+    value = std::get<std::string>(*param);
+
+    return true;
+}
+
+bool StorageNVSParams::Snapshot::getFloat(std::string_view key, float &value) const
+{
+    auto param = find(key);
+    if ((param == nullptr) || !std::holds_alternative<float>(*param)) {
+        return false;
+    }
+    value = std::get<float>(*param);
+
+    return true;
+}
+
+bool StorageNVSParams::Snapshot::getInt64(std::string_view key, int64_t &value) const
+{
+    auto param = find(key);
+    if ((param == nullptr) || !std::holds_alternative<int64_t>(*param)) {
+        return false;
+    }
+    value = std::get<int64_t>(*param);
+
+    return true;
+}
+
+bool StorageNVSParams::Snapshot::getBlob(std::string_view key, const uint8_t *&data, size_t &size) const
+{
+    auto param = find(key);
+    if ((param == nullptr) || !std::holds_alternative<Blob>(*param)) {
+        return false;
+    }
+    auto &blob = std::get<Blob>(*param);
+    data = blob.data();
+    size = blob.size();
+
+    return true;
+}
+
+const StorageNVSParams::Map &StorageNVSParams::Snapshot::getParams() const
+{
+    static const Map empty_params;
+
+    return (_version != nullptr) ? _version->params : empty_params;
+}
+
+uint32_t StorageNVSParams::Snapshot::getVersion() const
+{
+    return (_version != nullptr) ? _version->number : 0;
+}
+
+void StorageNVSParams::Snapshot::release()
+{
+    if (_version != nullptr) {
+        _version->ref_count.fetch_sub(1, std::memory_order_release);
+        _version = nullptr;
+    }
+}
+
+StorageNVSParams::StorageNVSParams():
+    _current_version(new Version()),
+    _epoch(0),
+    _epoch_readers{}
+{
+}
+
+StorageNVSParams::~StorageNVSParams()
+{
+    // All the snapshots must be released before the table is destroyed
+    for (auto version : _retired_versions) {
+        delete version;
+    }
+    delete _current_version.load();
+}
+
+StorageNVSParams::Snapshot StorageNVSParams::acquire() const
+{
+    // Register as a reader of the current epoch, so the writer can not free the version which is being pinned
+    size_t epoch = 0;
+    while (true) {
+        epoch = _epoch.load();
+        _epoch_readers[epoch & 1]++;
+        if (_epoch.load() == epoch) {
+            break;
+        }
+        _epoch_readers[epoch & 1]--;
+    }
+
+    const Version *version = _current_version.load();
+    version->ref_count.fetch_add(1, std::memory_order_relaxed);
+
+    _epoch_readers[epoch & 1]--;
+
+    return Snapshot(version);
+}
+
+void StorageNVSParams::update(const std::function<void(Map &params)> &modifier)
+{
+    std::lock_guard<std::mutex> lock(_writer_mutex);
+
+    Version *old_version = _current_version.load();
+    Version *new_version = new Version();
+    new_version->params = old_version->params;
+    new_version->number = old_version->number + 1;
+    modifier(new_version->params);
+
+    _current_version.store(new_version);
+    _retired_versions.push_back(old_version);
+
+    waitGracePeriod();
+    reclaimRetiredVersions();
+}
+
+void StorageNVSParams::waitGracePeriod()
+{
+    // Readers entering after the flip see the new version, wait for the ones registered in the previous epoch
+    size_t old_epoch = _epoch.fetch_add(1);
+    auto &old_readers = _epoch_readers[old_epoch & 1];
+    for (int i = 0; old_readers.load() != 0; i++) {
+        if (i < GRACE_PERIOD_SPIN_COUNT) {
+            std::this_thread::yield();
+        } else {
+            // Let a preempted reader with lower priority finish its registration
+            std::this_thread::sleep_for(std::chrono::milliseconds(GRACE_PERIOD_SLEEP_MS));
+        }
+    }
+}
+
+void StorageNVSParams::reclaimRetiredVersions()
+{
+    auto it = _retired_versions.begin();
+    while (it != _retired_versions.end()) {
+        if ((*it)->ref_count.load(std::memory_order_acquire) == 0) {
+            ESP_UTILS_LOGD("Reclaim params version(%d)", static_cast<int>((*it)->number));
+            delete *it;
+            it = _retired_versions.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+} // namespace esp_brookesia::services
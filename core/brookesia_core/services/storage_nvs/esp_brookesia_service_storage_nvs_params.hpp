@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include "esp_brookesia_service_storage_nvs_backend.hpp"
+
+namespace esp_brookesia::services {
+
+/**
+ * @brief Versioned, read-mostly table of parameters.
+ *
+ *        Readers pin the current version with `acquire()` without taking any lock and can keep references into it
+ *        (e.g. `std::string_view`) for as long as the snapshot lives. Writers are serialized, copy the current
+ *        version, modify the copy and publish it. A replaced version is freed once the grace period of the readers
+ *        which may still be acquiring it is over and no snapshot refers to it anymore.
+ */
+class StorageNVSParams {
+private:
+    struct Version;
+
+public:
+    using Key = StorageNVSBackend::Key;
+    using Value = StorageNVSBackend::Value;
+    using Blob = StorageNVSBackend::Blob;
+    using Map = std::map<Key, Value, std::less<>>;
+
+    class Snapshot {
+    public:
+        Snapshot() = default;
+        Snapshot(Snapshot &&other) noexcept;
+        ~Snapshot();
+
+        Snapshot(const Snapshot &) = delete;
+        Snapshot &operator=(const Snapshot &) = delete;
+        Snapshot &operator=(Snapshot &&other) noexcept;
+
+        const Value *find(std::string_view key) const;
+        bool getInt(std::string_view key, int &value) const;
+        bool getString(std::string_view key, std::string_view &value) const;
+        bool getFloat(std::string_view key, float &value) const;
+        bool getInt64(std::string_view key, int64_t &value) const;
+        /**
+         * @brief Get a blob without copying it, `data` stays valid as long as the snapshot lives
+         */
+        bool getBlob(std::string_view key, const uint8_t *&data, size_t &size) const;
+
+        const Map &getParams() const;
+        uint32_t getVersion() const;
+
+        bool isValid() const
+        {
+            return (_version != nullptr);
+        }
+
+    private:
+        friend class StorageNVSParams;
+
+        explicit Snapshot(const Version *version):
+            _version(version)
+        {
+        }
+        void release();
+
+        const Version *_version = nullptr;
+    };
+
+    StorageNVSParams();
+    ~StorageNVSParams();
+
+    StorageNVSParams(const StorageNVSParams &) = delete;
+    StorageNVSParams &operator=(const StorageNVSParams &) = delete;
+
+    Snapshot acquire() const;
+    void update(const std::function<void(Map &params)> &modifier);
+
+private:
+    struct Version {
+        Map params;
+        uint32_t number = 0;
+        mutable std::atomic<size_t> ref_count = 0;
+    };
+
+    void waitGracePeriod();
+    void reclaimRetiredVersions();
+
+    std::atomic<Version *> _current_version;
+    mutable std::atomic<size_t> _epoch;
+    mutable std::array<std::atomic<size_t>, 2> _epoch_readers;
+
+    std::mutex _writer_mutex;
+    std::vector<Version *> _retired_versions;
+};
+
+} // namespace esp_brookesia::services
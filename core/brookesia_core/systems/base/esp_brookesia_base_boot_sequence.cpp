@@ -0,0 +1,277 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include "esp_timer.h"
+#include "boost/thread.hpp"
+#include "esp_brookesia_systems_internal.h"
+#if !ESP_BROOKESIA_BASE_BOOT_SEQUENCE_ENABLE_DEBUG_LOG
+#   define ESP_BROOKESIA_UTILS_DISABLE_DEBUG_LOG
+#endif
+#include "private/esp_brookesia_base_utils.hpp"
+#include "gui/lvgl/esp_brookesia_lv_lock.hpp"
+#include "esp_brookesia_base_boot_sequence.hpp"
+
+#define WORKER_THREAD_STACK_SIZE        (10 * 1024)
+#define WORKER_THREAD_STACK_CAPS_EXT    (true)
+
+namespace esp_brookesia::systems::base {
+
+bool BootSequence::addStage(
+    const std::string &name, Runner runner, Function function, const std::vector<std::string> &dependencies,
+    Function cleanup
+)
+{
+    ESP_UTILS_LOGD("Param: name(%s), runner(%d), dependencies(%d)", name.c_str(), static_cast<int>(runner),
+                   static_cast<int>(dependencies.size()));
+    ESP_UTILS_CHECK_FALSE_RETURN(!checkStageExist(name), false, "Stage(%s) already exists", name.c_str());
+    ESP_UTILS_CHECK_FALSE_RETURN(function != nullptr, false, "Invalid function of stage(%s)", name.c_str());
+
+    Stage stage = {};
+    stage.function = std::move(function);
+    stage.cleanup = std::move(cleanup);
+    stage.critical_prev = -1;
+    for (auto &dependency : dependencies) {
+        auto it = std::find_if(_infos.begin(), _infos.end(), [&dependency](const StageInfo & info) {
+            return info.name == dependency;
+        });
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            it != _infos.end(), false, "Dependency(%s) of stage(%s) is not added", dependency.c_str(), name.c_str()
+        );
+        stage.dependencies.push_back(it - _infos.begin());
+    }
+
+    StageInfo info = {};
+    info.name = name;
+    info.runner = runner;
+
+    ESP_UTILS_CHECK_EXCEPTION_RETURN(_stages.push_back(std::move(stage)), false, "Add stage failed");
+    ESP_UTILS_CHECK_EXCEPTION_RETURN(_infos.push_back(std::move(info)), false, "Add stage info failed");
+
+    return true;
+}
+
+bool BootSequence::checkStageExist(const std::string &name) const
+{
+    return std::any_of(_infos.begin(), _infos.end(), [&name](const StageInfo & info) {
+        return info.name == name;
+    });
+}
+
+bool BootSequence::run(void)
+{
+    ESP_UTILS_LOGD("Run %d stages", static_cast<int>(_stages.size()));
+
+    size_t stage_num = _stages.size();
+    std::vector<size_t> waiting_nums(stage_num);
+    std::vector<std::vector<size_t>> dependents(stage_num);
+    for (size_t i = 0; i < stage_num; i++) {
+        waiting_nums[i] = _stages[i].dependencies.size();
+        for (auto dependency : _stages[i].dependencies) {
+            dependents[dependency].push_back(i);
+        }
+        _stages[i].critical_prev = -1;
+        _infos[i].is_done = false;
+        _infos[i].is_failed = false;
+        _infos[i].is_critical = false;
+        _infos[i].ready_time_us = _infos[i].start_time_us = _infos[i].end_time_us = 0;
+    }
+
+    // The workers only touch their own `StageInfo` and report to the caller through this queue
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<size_t> finished_workers;
+    std::vector<boost::thread> worker_threads;
+    std::deque<size_t> caller_ready_stages;
+    std::vector<size_t> started_stages;
+    size_t running_worker_num = 0;
+    size_t done_num = 0;
+    bool is_failed = false;
+    int last_caller_stage = -1;
+    int64_t begin_time_us = esp_timer_get_time();
+    worker_threads.reserve(stage_num);
+    started_stages.reserve(stage_num);
+    auto get_time_us = [begin_time_us]() {
+        return esp_timer_get_time() - begin_time_us;
+    };
+
+    auto start_worker = [&](size_t index) {
+        esp_utils::thread_config_guard thread_config(esp_utils::ThreadConfig{
+            .name = _infos[index].name.c_str(),
+            .stack_size = WORKER_THREAD_STACK_SIZE,
+            .stack_in_ext = WORKER_THREAD_STACK_CAPS_EXT,
+        });
+        ESP_UTILS_CHECK_EXCEPTION_RETURN(
+            worker_threads.emplace_back([&, index]() {
+                auto &info = _infos[index];
+                info.start_time_us = get_time_us();
+                bool ret = false;
+                {
+                    // The caller holds the LVGL lock while it waits for the workers
+                    gui::LvLockForbidGuard lock_forbid_guard;
+                    ret = _stages[index].function();
+                }
+                info.end_time_us = get_time_us();
+
+                std::lock_guard lock(mutex);
+                info.is_failed = !ret;
+                finished_workers.push_back(index);
+                cv.notify_one();
+            }), false, "Start worker of stage(%s) failed", _infos[index].name.c_str()
+        );
+        running_worker_num++;
+        started_stages.push_back(index);
+
+        return true;
+    };
+    auto set_ready = [&](size_t index) {
+        auto &info = _infos[index];
+        info.ready_time_us = get_time_us();
+        // The dependency which is done last decides when the stage is ready
+        for (auto dependency : _stages[index].dependencies) {
+            auto prev = _stages[index].critical_prev;
+            if ((prev < 0) || (_infos[dependency].end_time_us > _infos[prev].end_time_us)) {
+                _stages[index].critical_prev = static_cast<int>(dependency);
+            }
+        }
+
+        if (info.runner == Runner::CALLER) {
+            caller_ready_stages.push_back(index);
+        } else if (!start_worker(index)) {
+            info.is_failed = true;
+            is_failed = true;
+        }
+    };
+    auto set_done = [&](size_t index) {
+        auto &info = _infos[index];
+        if (info.is_failed) {
+            ESP_UTILS_LOGE("Stage(%s) failed", info.name.c_str());
+            is_failed = true;
+            return;
+        }
+        info.is_done = true;
+        done_num++;
+        ESP_UTILS_LOGD("Stage(%s) done in %d us", info.name.c_str(),
+                       static_cast<int>(info.end_time_us - info.start_time_us));
+
+        for (auto dependent : dependents[index]) {
+            if ((--waiting_nums[dependent] == 0) && !is_failed) {
+                set_ready(dependent);
+            }
+        }
+    };
+
+    for (size_t i = 0; i < stage_num; i++) {
+        if (waiting_nums[i] == 0) {
+            set_ready(i);
+        }
+    }
+
+    while (true) {
+        std::vector<size_t> finished;
+        {
+            std::lock_guard lock(mutex);
+            finished.swap(finished_workers);
+        }
+        for (auto index : finished) {
+            running_worker_num--;
+            set_done(index);
+        }
+
+        if (!is_failed && !caller_ready_stages.empty()) {
+            auto index = caller_ready_stages.front();
+            caller_ready_stages.pop_front();
+
+            auto &info = _infos[index];
+            auto &stage = _stages[index];
+            // If the caller was busy with another stage, the stage waited for it instead of its dependencies
+            if ((last_caller_stage >= 0) && (_infos[last_caller_stage].end_time_us > info.ready_time_us)) {
+                stage.critical_prev = last_caller_stage;
+            }
+            started_stages.push_back(index);
+            info.start_time_us = get_time_us();
+            info.is_failed = !stage.function();
+            info.end_time_us = get_time_us();
+            last_caller_stage = static_cast<int>(index);
+            set_done(index);
+            continue;
+        }
+        if (running_worker_num == 0) {
+            break;
+        }
+
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [&finished_workers]() {
+            return !finished_workers.empty();
+        });
+    }
+
+    for (auto &thread : worker_threads) {
+        thread.join();
+    }
+    _total_time_us = get_time_us();
+    markCriticalPath();
+
+    if (is_failed) {
+        for (auto it = started_stages.rbegin(); it != started_stages.rend(); it++) {
+            auto &cleanup = _stages[*it].cleanup;
+            if ((cleanup != nullptr) && !cleanup()) {
+                ESP_UTILS_LOGE("Cleanup stage(%s) failed", _infos[*it].name.c_str());
+            }
+        }
+    }
+    ESP_UTILS_CHECK_FALSE_RETURN(!is_failed, false, "Boot sequence failed");
+    ESP_UTILS_CHECK_FALSE_RETURN(done_num == stage_num, false, "Not all stages are done");
+
+    return true;
+}
+
+void BootSequence::dumpTimeline(void) const
+{
+    int64_t critical_time_us = 0;
+    std::string critical_path;
+
+    ESP_UTILS_LOGI("Boot timeline: total(%d us), stages(%d), '*' is on the critical path",
+                   static_cast<int>(_total_time_us), static_cast<int>(_infos.size()));
+    for (auto &info : _infos) {
+        ESP_UTILS_LOGI(
+            "  %c %-20s %-6s ready(%8d) start(%8d) end(%8d) wait(%8d) time(%8d)%s",
+            info.is_critical ? '*' : ' ', info.name.c_str(), (info.runner == Runner::CALLER) ? "caller" : "worker",
+            static_cast<int>(info.ready_time_us), static_cast<int>(info.start_time_us),
+            static_cast<int>(info.end_time_us), static_cast<int>(info.start_time_us - info.ready_time_us),
+            static_cast<int>(info.end_time_us - info.start_time_us),
+            info.is_failed ? " failed" : (info.is_done ? "" : " not run")
+        );
+    }
+    for (auto index : _critical_path) {
+        auto &info = _infos[index];
+        critical_time_us += info.end_time_us - info.start_time_us;
+        critical_path += critical_path.empty() ? info.name : (" -> " + info.name);
+    }
+    ESP_UTILS_LOGI("Critical path: %s (%d us in stages)", critical_path.c_str(), static_cast<int>(critical_time_us));
+}
+
+void BootSequence::markCriticalPath(void)
+{
+    int index = -1;
+    for (size_t i = 0; i < _infos.size(); i++) {
+        if (_infos[i].is_done && ((index < 0) || (_infos[i].end_time_us > _infos[index].end_time_us))) {
+            index = static_cast<int>(i);
+        }
+    }
+
+    // Walk back from the stage which ends last
+    _critical_path.clear();
+    while (index >= 0) {
+        _infos[index].is_critical = true;
+        _critical_path.insert(_critical_path.begin(), index);
+        index = _stages[index].critical_prev;
+    }
+}
+
+} // namespace esp_brookesia::systems::base
@@ -0,0 +1,107 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace esp_brookesia::systems::base {
+
+/**
+ * @brief Boot of a system as a dependency graph of stages. A stage starts as soon as all its dependencies are done, so
+ *        the independent stages overlap, and the time of each stage is recorded for a timeline report.
+ *
+ *        The stages on `Runner::CALLER` run one by one on the thread which calls `run()`, which usually holds the LVGL
+ *        lock, so they can use LVGL. The stages on `Runner::WORKER` run on their own threads and must not use LVGL,
+ *        because the caller keeps the lock while waiting for them. They run with a `gui::LvLockForbidGuard`, so
+ *        `gui::LvLock` fails in them instead of a deadlock. The lock of the display port (e.g. `bsp_display_lock()`)
+ *        is not checked.
+ */
+class BootSequence {
+public:
+    enum class Runner {
+        CALLER,
+        WORKER,
+    };
+    using Function = std::function<bool (void)>;
+
+    struct StageInfo {
+        std::string name;
+        Runner runner;
+        bool is_done;
+        bool is_failed;
+        bool is_critical;       /*!< On the path which decides the total time */
+        int64_t ready_time_us;  /*!< When all the dependencies are done, relative to the beginning of `run()` */
+        int64_t start_time_us;
+        int64_t end_time_us;
+    };
+
+    BootSequence() = default;
+    ~BootSequence() = default;
+
+    BootSequence(const BootSequence &) = delete;
+    BootSequence &operator=(const BootSequence &) = delete;
+
+    /**
+     * @brief Add a stage, its dependencies must be added before it, so the graph has no cycle
+     *
+     * @param cleanup Undo the stage if `run()` fails, it is called on the caller even for a stage on the worker, see
+     *                `run()`
+     */
+    bool addStage(
+        const std::string &name, Runner runner, Function function, const std::vector<std::string> &dependencies = {},
+        Function cleanup = nullptr
+    );
+    bool checkStageExist(const std::string &name) const;
+
+    /**
+     * @brief Run all the stages. If a stage fails, no more stages are started and the running ones are waited. Then
+     *        the cleanups of all the started stages (including the failed one) are called on the caller, in the
+     *        reverse order of their starts.
+     *
+     * @return true if all the stages succeed
+     */
+    bool run(void);
+
+    /**
+     * @brief Print the time of each stage and the critical path of the last `run()`
+     */
+    void dumpTimeline(void) const;
+
+    const std::vector<StageInfo> &getTimeline(void) const
+    {
+        return _infos;
+    }
+    int64_t getTotalTimeUs(void) const
+    {
+        return _total_time_us;
+    }
+    const std::vector<size_t> &getCriticalPath(void) const
+    {
+        return _critical_path;
+    }
+
+private:
+    struct Stage {
+        Function function;
+        Function cleanup;
+        std::vector<size_t> dependencies;
+        // The dependency (or the previous stage on the caller) which the stage waited for last
+        int critical_prev;
+    };
+
+    void markCriticalPath(void);
+
+    std::vector<Stage> _stages;
+    std::vector<StageInfo> _infos;
+    // Indexes of the stages on the critical path, in the order they run
+    std::vector<size_t> _critical_path;
+    int64_t _total_time_us = 0;
+};
+
+} // namespace esp_brookesia::systems::base
@@ -30,6 +30,7 @@ Context::Context(
     _touch_device(nullptr),
     _free_event_code(_LV_EVENT_LAST),
     _event_obj(nullptr),
+    _event_post_timer(nullptr),
     _data_update_event_code(_LV_EVENT_LAST),
     _navigate_event_code(_LV_EVENT_LAST),
     _app_event_code(_LV_EVENT_LAST)
@@ -182,6 +183,7 @@ bool Context::unlockLv()
 bool Context::begin(void)
 {
     gui::LvObjSharedPtr event_obj = nullptr;
+    gui::LvTimerSharedPtr event_post_timer = nullptr;
     lv_event_code_t data_update_event_code = _LV_EVENT_LAST;
     lv_event_code_t navigate_event_code = _LV_EVENT_LAST;
     lv_event_code_t app_event_code = _LV_EVENT_LAST;
@@ -214,8 +216,13 @@ bool Context::begin(void)
     ESP_UTILS_CHECK_FALSE_RETURN(esp_brookesia_core_utils_check_event_code_valid(app_event_code), false,
                                  "Create app event code failed");
 
+    // Drain the events posted from other threads once per refresh period of the LVGL task
+    event_post_timer = ESP_BROOKESIA_LV_TIMER(onEventPostTimerCallback, LV_DEF_REFR_PERIOD, this);
+    ESP_UTILS_CHECK_NULL_RETURN(event_post_timer, false, "Create event post timer failed");
+
     // Save data
     _event_obj = event_obj;
+    _event_post_timer = event_post_timer;
     _data_update_event_code = data_update_event_code;
     _navigate_event_code = navigate_event_code;
     _app_event_code = app_event_code;
@@ -260,6 +267,7 @@ bool Context::del(void)
     _touch_device = nullptr;
     _free_event_code = _LV_EVENT_LAST;
     _event_obj.reset();
+    _event_post_timer.reset();
     _data_update_event_code = _LV_EVENT_LAST;
     _navigate_event_code = _LV_EVENT_LAST;
     _app_event_code = _LV_EVENT_LAST;
@@ -287,6 +295,18 @@ bool Context::calibrateCoreData(Data &data)
     return true;
 }
 
+void Context::onEventPostTimerCallback(struct _lv_timer_t *t)
+{
+    Context *core = nullptr;
+
+    ESP_UTILS_CHECK_NULL_EXIT(t, "Invalid timer");
+
+    core = (Context *)lv_timer_get_user_data(t);
+    ESP_UTILS_CHECK_NULL_EXIT(core, "Invalid core object");
+
+    core->_event.dispatchPostedEvents();
+}
+
 void Context::onCoreDataUpdateEventCallback(lv_event_t *event)
 {
     Context *core = nullptr;
@@ -297,6 +317,12 @@ void Context::onCoreDataUpdateEventCallback(lv_event_t *event)
     core = (Context *)lv_event_get_user_data(event);
     ESP_UTILS_CHECK_NULL_EXIT(core, "Invalid core object");
 
+    auto diff = static_cast<gui::StylesheetDiff *>(lv_event_get_param(event));
+    if (!gui::StylesheetDiff::checkUpdateNeeded(diff, core->_data)) {
+        ESP_UTILS_LOGD("Data is not changed, skip");
+        return;
+    }
+
     ESP_UTILS_CHECK_FALSE_EXIT(core->_display.updateByNewData(), "Context display update failed");
 }
 
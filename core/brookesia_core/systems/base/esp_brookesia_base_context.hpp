@@ -7,6 +7,7 @@
 
 #include <memory>
 #include "style/esp_brookesia_gui_style.hpp"
+#include "style/esp_brookesia_gui_stylesheet_diff.hpp"
 #include "esp_brookesia_base_display.hpp"
 #include "esp_brookesia_base_manager.hpp"
 #include "esp_brookesia_base_event.hpp"
@@ -89,6 +90,9 @@ public:
     // Data Update
     bool registerDateUpdateEventCallback(lv_event_cb_t callback, void *user_data);
     bool unregisterDateUpdateEventCallback(lv_event_cb_t callback, void *user_data);
+    /**
+     * @param param `gui::StylesheetDiff` between the old and new data, `nullptr` means all the data is changed
+     */
     bool sendDataUpdateEvent(void *param = nullptr);
     lv_event_code_t getDataUpdateEventCode(void) const
     {
@@ -170,10 +174,12 @@ protected:
 private:
     static void onCoreDataUpdateEventCallback(lv_event_t *event);
     static void onCoreNavigateEventCallback(lv_event_t *event);
+    static void onEventPostTimerCallback(struct _lv_timer_t *t);
 
     // Event
     uint32_t _free_event_code;
     esp_brookesia::gui::LvObjSharedPtr _event_obj;
+    esp_brookesia::gui::LvTimerSharedPtr _event_post_timer;
     lv_event_code_t _data_update_event_code;
     lv_event_code_t _navigate_event_code;
     lv_event_code_t _app_event_code;
@@ -16,8 +16,17 @@ using namespace std;
 namespace esp_brookesia::systems::base {
 
 Event::Event():
-    _free_event_id(ID::CUSTOM)
+    _free_event_id(ID::CUSTOM),
+    _dispatch_depth(0),
+    _has_tombstones(false),
+    _posted_event_enqueue_pos(0),
+    _posted_event_dequeue_pos(0)
 {
+    static_assert((POST_QUEUE_SIZE & (POST_QUEUE_SIZE - 1)) == 0, "`POST_QUEUE_SIZE` must be a power of two");
+
+    for (size_t i = 0; i < _posted_event_slots.size(); i++) {
+        _posted_event_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
 }
 
 Event::~Event()
@@ -42,8 +51,23 @@ Event::ID operator++(Event::ID &id, int)
 void Event::reset(void)
 {
     _free_event_id = ID::CUSTOM;
-    _event_handlers.clear();
+    _pending_handlers.clear();
+    if (_dispatch_depth > 0) {
+        for (auto &entry : _event_handlers) {
+            entry.handler = nullptr;
+        }
+        _has_tombstones = true;
+    } else {
+        _event_handlers.clear();
+        _has_tombstones = false;
+    }
+    _event_id_states.clear();
     _available_event_ids.clear();
+
+    // Drop the events which are posted but not dispatched yet
+    PostedEvent posted_event = {};
+    while (popPostedEvent(posted_event)) {
+    }
 }
 
 bool Event::registerEvent(void *object, Handler handler, ID id, void *user_data)
@@ -52,8 +76,14 @@ bool Event::registerEvent(void *object, Handler handler, ID id, void *user_data)
                    handler, user_data);
     ESP_UTILS_CHECK_NULL_RETURN(handler, false, "Invalid handler");
 
-    auto &handlers_for_object = _event_handlers[object];
-    handlers_for_object[id].emplace_back(handler, user_data);
+    HandlerEntry entry = {object, id, handler, user_data};
+    if (_dispatch_depth > 0) {
+        ESP_UTILS_LOGD("Dispatching, defer the registration");
+        _pending_handlers.push_back(entry);
+    } else {
+        insertHandler(entry);
+    }
+    retainEventID(id);
 
     return true;
 }
@@ -62,32 +92,36 @@ bool Event::sendEvent(void *object, ID id, void *param) const
 {
     ESP_UTILS_LOGD("Send event for object(0x%p) ID(%d) param(0x%p)", object, static_cast<int>(id), param);
 
-    auto object_it = _event_handlers.find(object);
-    if (object_it == _event_handlers.end()) {
-        return true;
-    }
-
-    auto &handlers_for_object = object_it->second;
-    auto handler_it = handlers_for_object.find(id);
-    if (handler_it == handlers_for_object.end()) {
+    // The table is never resized while `_dispatch_depth > 0`, so indices stay valid even if handlers re-enter
+    size_t index = findHandlerSpanBegin(object, id) - _event_handlers.cbegin();
+    if ((index >= _event_handlers.size()) || (_event_handlers[index].object != object) ||
+            (_event_handlers[index].id != id)) {
         return true;
     }
 
     HandlerData data = {};
     bool ret = true;
-    for (auto &handler_data_pair : handler_it->second) {
-        auto &handler = handler_data_pair.first;
-        auto &user_data = handler_data_pair.second;
-        if (handler == nullptr) {
-            ESP_UTILS_LOGE("Handler is nullptr");
+    _dispatch_depth++;
+    for (; index < _event_handlers.size(); index++) {
+        const HandlerEntry &entry = _event_handlers[index];
+        if ((entry.object != object) || (entry.id != id)) {
+            break;
+        }
+        // Skip the handlers which are unregistered during the dispatch
+        if (entry.handler == nullptr) {
             continue;
         }
-        data = {id, object, param, user_data};
-        if (!handler(data)) {
+        data = {id, object, param, entry.user_data};
+        if (!entry.handler(data)) {
             ret = false;
             ESP_UTILS_LOGE("Do handler failed");
         }
     }
+    _dispatch_depth--;
+
+    if (_dispatch_depth == 0) {
+        applyPendingChanges();
+    }
 
     return ret;
 }
@@ -96,201 +130,337 @@ void Event::unregisterEvent(void *object)
 {
     ESP_UTILS_LOGD("Unregister event for object(0x%p)", object);
 
-    auto object_it = _event_handlers.find(object);
-    if (object_it == _event_handlers.end()) {
-        return;
-    }
+    // The handlers of an object are adjacent in the table, only the span needs to be visited
+    auto range = findObjectSpan(object);
+    [[maybe_unused]] size_t removed_count = removeHandlersIf(range.first, range.second, [&](const HandlerEntry & entry) {
+        return entry.object == object;
+    });
+    ESP_UTILS_LOGD("Remove %d event handlers", static_cast<int>(removed_count));
+}
 
-    // Save event IDs to be removed
-    std::unordered_set<ID> event_ids;
-    for (auto &id_handlers_pair : object_it->second) {
-        event_ids.insert(id_handlers_pair.first);
-    }
+void Event::unregisterEvent(void *object, ID id)
+{
+    ESP_UTILS_LOGD("Unregister event for object(0x%p) ID(%d)", object, static_cast<int>(id));
 
-    // Remove handlers for the given object
-    size_t handlers_count = getEventHandlersCount();
-    _event_handlers.erase(object_it);
-    ESP_UTILS_LOGD("Remove %d event handlers", (int)(handlers_count - getEventHandlersCount() ));
+    auto range = findHandlerSpan(object, id);
+    [[maybe_unused]] size_t removed_count = removeHandlersIf(range.first, range.second, [&](const HandlerEntry & entry) {
+        return (entry.object == object) && (entry.id == id);
+    });
+    ESP_UTILS_LOGD("Remove %d event handlers", static_cast<int>(removed_count));
+}
 
-    // Add removed event IDs to available event IDs
-    for (const auto &id : event_ids) {
-        if (!checkUsedEventID(id)) {
-            ESP_UTILS_LOGD("Recycle event ID(%d)", static_cast<int>(id));
-            _available_event_ids.insert(id);
-        }
-    }
+void Event::unregisterEvent(void *object, Handler handler, ID id)
+{
+    ESP_UTILS_LOGD("Unregister event for object(0x%p) ID(%d) handler(0x%p)", object, static_cast<int>(id), handler);
+
+    auto range = findHandlerSpan(object, id);
+    [[maybe_unused]] size_t removed_count = removeHandlersIf(range.first, range.second, [&](const HandlerEntry & entry) {
+        return (entry.object == object) && (entry.id == id) && (entry.handler == handler);
+    });
+    ESP_UTILS_LOGD("Remove %d event handlers", static_cast<int>(removed_count));
 }
 
-void Event::unregisterEvent(void *object, ID id)
+void Event::unregisterEvent(ID id)
 {
-    ESP_UTILS_LOGD("Unregister event for object(0x%p) ID(%d)", object, static_cast<int>(id));
+    ESP_UTILS_LOGD("Unregister event for ID(%d)", static_cast<int>(id));
 
-    auto object_it = _event_handlers.find(object);
-    if (object_it == _event_handlers.end()) {
-        return;
-    }
+    [[maybe_unused]] size_t removed_count = removeHandlersIf(0, _event_handlers.size(), [&](const HandlerEntry & entry) {
+        return entry.id == id;
+    });
+    ESP_UTILS_LOGD("Remove %d event handlers", static_cast<int>(removed_count));
 
-    auto &handlers_for_object = object_it->second;
-    size_t handlers_count = getEventHandlersCount();
-    if (handlers_for_object.erase(id) == 0) {
-        return;
-    }
-    if (handlers_for_object.empty()) {
-        _event_handlers.erase(object_it);
-    }
-    ESP_UTILS_LOGD("Remove %d event handlers", (int)(handlers_count - getEventHandlersCount() ));
+    // The ID is released explicitly by the owner, so recycle it even if it has never been registered
+    recycleEventID(id);
+}
 
-    // Add removed event IDs to available event IDs
-    if (!checkUsedEventID(id)) {
-        ESP_UTILS_LOGD("Recycle event ID(%d)", static_cast<int>(id));
-        _available_event_ids.insert(id);
-    }
+void Event::unregisterEvent(Handler handler)
+{
+    ESP_UTILS_LOGD("Unregister event for handler(0x%p)", handler);
+
+    [[maybe_unused]] size_t removed_count = removeHandlersIf(0, _event_handlers.size(), [&](const HandlerEntry & entry) {
+        return entry.handler == handler;
+    });
+    ESP_UTILS_LOGD("Remove %d event handlers", static_cast<int>(removed_count));
 }
 
-void Event::unregisterEvent(void *object, Handler handler, ID id)
+Event::ID Event::getFreeEventID()
 {
-    ESP_UTILS_LOGD("Unregister event for object(0x%p) ID(%d) handler(0x%p)", object, static_cast<int>(id), handler);
+    // An ID is removed from `_available_event_ids` once it is registered again, so every entry is available
+    if (!_available_event_ids.empty()) {
+        ID id = _available_event_ids.back();
+        removeAvailableEventID(id);
+        return id;
+    }
 
-    auto object_it = _event_handlers.find(object);
-    if (object_it == _event_handlers.end()) {
-        return;
+    return ++_free_event_id;
+}
+
+bool Event::postEvent(void *object, ID id, void *param, bool coalesce)
+{
+    ESP_UTILS_LOGD("Post event for object(0x%p) ID(%d) param(0x%p) coalesce(%d)", object, static_cast<int>(id), param,
+                   coalesce);
+
+    PostedEventSlot *slot = nullptr;
+    size_t pos = _posted_event_enqueue_pos.load(std::memory_order_relaxed);
+    while (true) {
+        slot = &_posted_event_slots[pos & (POST_QUEUE_SIZE - 1)];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            // The slot is free, try to claim it
+            if (_posted_event_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            ESP_UTILS_LOGE("Post queue is full, drop event for object(0x%p) ID(%d)", object, static_cast<int>(id));
+            return false;
+        } else {
+            // Another producer has claimed the slot, reload the position
+            pos = _posted_event_enqueue_pos.load(std::memory_order_relaxed);
+        }
     }
 
-    auto &handlers_for_object = object_it->second;
-    auto handler_it = handlers_for_object.find(id);
-    if (handler_it == handlers_for_object.end()) {
-        return;
+    slot->event = {object, id, param, coalesce, false};
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    return true;
+}
+
+size_t Event::dispatchPostedEvents(void)
+{
+    PostedEvent posted_event = {};
+    _posted_event_batch.clear();
+    while (popPostedEvent(posted_event)) {
+        _posted_event_batch.push_back(posted_event);
+    }
+    if (_posted_event_batch.empty()) {
+        return 0;
     }
 
-    auto &handlers = handler_it->second;
-    auto it = std::remove_if(handlers.begin(), handlers.end(),
-    [&](const std::pair<Handler, void *> &pair) {
-        return handler == pair.first;
-    });
-    if (it == handlers.end()) {
-        return;
+    // Walk backwards so that only the latest one of each coalesced (object, ID) survives
+    for (size_t i = _posted_event_batch.size(); i-- > 0;) {
+        auto &event = _posted_event_batch[i];
+        if (!event.coalesce) {
+            continue;
+        }
+        for (size_t j = i + 1; j < _posted_event_batch.size(); j++) {
+            auto &later = _posted_event_batch[j];
+            if (later.coalesce && !later.is_dropped && (later.object == event.object) && (later.id == event.id)) {
+                ESP_UTILS_LOGD("Coalesce event for object(0x%p) ID(%d)", event.object, static_cast<int>(event.id));
+                event.is_dropped = true;
+                break;
+            }
+        }
     }
 
-    size_t handlers_count = getEventHandlersCount();
-    handlers.erase(it, handlers.end());
-    if (handlers.empty()) {
-        handlers_for_object.erase(handler_it);
+    size_t dispatched_count = 0;
+    for (auto &event : _posted_event_batch) {
+        if (event.is_dropped) {
+            continue;
+        }
+        if (!sendEvent(event.object, event.id, event.param)) {
+            ESP_UTILS_LOGE("Send posted event for object(0x%p) ID(%d) failed", event.object, static_cast<int>(event.id));
+        }
+        dispatched_count++;
     }
-    if (handlers_for_object.empty()) {
-        _event_handlers.erase(object_it);
+    _posted_event_batch.clear();
+
+    return dispatched_count;
+}
+
+bool Event::compareEntryKey(const HandlerEntry &entry, const std::pair<void *, ID> &key)
+{
+    if (entry.object != key.first) {
+        return std::less<void *>()(entry.object, key.first);
     }
-    ESP_UTILS_LOGD("Remove %d event handlers", (int)(handlers_count - getEventHandlersCount() ));
+    return static_cast<int>(entry.id) < static_cast<int>(key.second);
+}
 
-    // Add removed event IDs to available event IDs
-    if (!checkUsedEventID(id)) {
-        _available_event_ids.insert(id);
+bool Event::compareKeyEntry(const std::pair<void *, ID> &key, const HandlerEntry &entry)
+{
+    if (key.first != entry.object) {
+        return std::less<void *>()(key.first, entry.object);
     }
+    return static_cast<int>(key.second) < static_cast<int>(entry.id);
 }
 
-void Event::unregisterEvent(ID id)
+Event::HandlerTable::const_iterator Event::findHandlerSpanBegin(void *object, ID id) const
 {
-    ESP_UTILS_LOGD("Unregister event for ID(%d)", static_cast<int>(id));
+    return std::lower_bound(
+               _event_handlers.cbegin(), _event_handlers.cend(), std::make_pair(object, id), compareEntryKey
+           );
+}
 
-    size_t handlers_count = getEventHandlersCount();
-    for (auto &object_handler_pair : _event_handlers) {
-        auto &handlers_for_object = object_handler_pair.second;
-        if (handlers_for_object.find(id) != handlers_for_object.end()) {
-            handlers_for_object.erase(id);
-        }
-    }
-    cleanEmptyHandlers();
-    ESP_UTILS_LOGD("Remove %d event handlers", (int)(handlers_count - getEventHandlersCount() ));
+std::pair<size_t, size_t> Event::findHandlerSpan(void *object, ID id) const
+{
+    auto range = std::equal_range(
+                     _event_handlers.cbegin(), _event_handlers.cend(), std::make_pair(object, id),
+                     EntryKeyComparator{}
+                 );
 
-    // Add removed event IDs to available event IDs
-    ESP_UTILS_LOGD("Recycle event ID(%d)", static_cast<int>(id));
-    _available_event_ids.insert(id);
+    return {range.first - _event_handlers.cbegin(), range.second - _event_handlers.cbegin()};
 }
 
-void Event::unregisterEvent(Handler handler)
+std::pair<size_t, size_t> Event::findObjectSpan(void *object) const
 {
-    ESP_UTILS_LOGD("Unregister event for handler(0x%p)", handler);
+    auto first = std::partition_point(_event_handlers.cbegin(), _event_handlers.cend(), [object](const HandlerEntry & entry) {
+        return std::less<void *>()(entry.object, object);
+    });
+    auto last = std::partition_point(first, _event_handlers.cend(), [object](const HandlerEntry & entry) {
+        return entry.object == object;
+    });
 
-    // Save event IDs to be removed
-    std::unordered_set<ID> event_ids;
-    size_t handlers_count = getEventHandlersCount();
-    for (auto &object_handler_pair : _event_handlers) {
-        auto &handlers_for_object = object_handler_pair.second;
-        for (auto &id_handlers_pair : handlers_for_object) {
-            auto &handlers = id_handlers_pair.second;
-            auto it = std::remove_if(handlers.begin(), handlers.end(),
-            [&](const std::pair<Handler, void *> &pair) {
-                return handler == pair.first;
-            });
-            if (it != handlers.end()) {
-                event_ids.insert(id_handlers_pair.first);
-                handlers.erase(it, handlers.end());
+    return {first - _event_handlers.cbegin(), last - _event_handlers.cbegin()};
+}
+
+void Event::insertHandler(const HandlerEntry &entry) const
+{
+    // Insert after the existing handlers of the same key to keep the registration order
+    auto it = std::upper_bound(
+                  _event_handlers.begin(), _event_handlers.end(), std::make_pair(entry.object, entry.id), compareKeyEntry
+              );
+    _event_handlers.insert(it, entry);
+}
+
+template <typename Predicate>
+size_t Event::removeHandlersIf(size_t first, size_t last, Predicate pred)
+{
+    size_t removed_count = 0;
+    auto on_removed = [&](const HandlerEntry & entry) {
+        releaseEventID(entry.id);
+        removed_count++;
+    };
+
+    // The pending handlers are not visible to the dispatch, so they can always be removed in place
+    auto pending_it = std::remove_if(_pending_handlers.begin(), _pending_handlers.end(), [&](const HandlerEntry & entry) {
+        if (!pred(entry)) {
+            return false;
+        }
+        on_removed(entry);
+        return true;
+    });
+    _pending_handlers.erase(pending_it, _pending_handlers.end());
+
+    auto begin = _event_handlers.begin() + first;
+    auto end = _event_handlers.begin() + last;
+    if (_dispatch_depth > 0) {
+        for (auto it = begin; it != end; it++) {
+            if ((it->handler != nullptr) && pred(*it)) {
+                on_removed(*it);
+                it->handler = nullptr;
+                _has_tombstones = true;
             }
         }
+    } else {
+        auto it = std::remove_if(begin, end, [&](const HandlerEntry & entry) {
+            if (!pred(entry)) {
+                return false;
+            }
+            on_removed(entry);
+            return true;
+        });
+        _event_handlers.erase(it, end);
     }
-    cleanEmptyHandlers();
-    ESP_UTILS_LOGD("Remove %d event handlers", (int)(handlers_count - getEventHandlersCount() ));
-
-    // Add removed event IDs to available event IDs
-    for (const auto &id : event_ids) {
-        if (!checkUsedEventID(id)) {
-            ESP_UTILS_LOGD("Recycle event ID(%d)", static_cast<int>(id));
-            _available_event_ids.insert(id);
+
+    return removed_count;
+}
+
+void Event::applyPendingChanges() const
+{
+    if (_has_tombstones) {
+        auto it = std::remove_if(_event_handlers.begin(), _event_handlers.end(), [](const HandlerEntry & entry) {
+            return entry.handler == nullptr;
+        });
+        ESP_UTILS_LOGD("Remove %d deferred event handlers", static_cast<int>(_event_handlers.end() - it));
+        _event_handlers.erase(it, _event_handlers.end());
+        _has_tombstones = false;
+    }
+
+    if (!_pending_handlers.empty()) {
+        ESP_UTILS_LOGD("Insert %d deferred event handlers", static_cast<int>(_pending_handlers.size()));
+        for (const auto &entry : _pending_handlers) {
+            insertHandler(entry);
         }
+        _pending_handlers.clear();
     }
 }
 
-bool Event::checkUsedEventID(ID id) const
+bool Event::popPostedEvent(PostedEvent &event)
 {
-    for (auto &object_handler_pair : _event_handlers) {
-        auto &handlers_for_object = object_handler_pair.second;
-        if (handlers_for_object.find(id) != handlers_for_object.end()) {
-            return true;
-        }
+    auto &slot = _posted_event_slots[_posted_event_dequeue_pos & (POST_QUEUE_SIZE - 1)];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(_posted_event_dequeue_pos + 1) < 0) {
+        return false;
     }
-    return false;
+
+    event = slot.event;
+    slot.sequence.store(_posted_event_dequeue_pos + POST_QUEUE_SIZE, std::memory_order_release);
+    _posted_event_dequeue_pos++;
+
+    return true;
 }
 
-Event::ID Event::getFreeEventID()
+void Event::retainEventID(ID id)
 {
-    if (!_available_event_ids.empty()) {
-        ID id = *_available_event_ids.begin();
-        _available_event_ids.erase(id);
+    size_t index = static_cast<size_t>(id);
+    if (index >= _event_id_states.size()) {
+        _event_id_states.resize(index + 1);
+    }
 
-        return id;
+    auto &state = _event_id_states[index];
+    state.ref_count++;
+    if (state.is_available) {
+        removeAvailableEventID(id);
     }
+}
 
-    return ++_free_event_id;
+void Event::releaseEventID(ID id)
+{
+    size_t index = static_cast<size_t>(id);
+    ESP_UTILS_CHECK_FALSE_EXIT(
+        (index < _event_id_states.size()) && (_event_id_states[index].ref_count > 0), "Event ID(%d) is not retained",
+        static_cast<int>(id)
+    );
+
+    auto &state = _event_id_states[index];
+    state.ref_count--;
+    if (state.ref_count == 0) {
+        recycleEventID(id);
+    }
 }
 
-size_t Event::getEventHandlersCount(void) const
+void Event::recycleEventID(ID id)
 {
-    size_t count = 0;
-    for (auto &object_handler_pair : _event_handlers) {
-        for (auto &id_handlers_pair : object_handler_pair.second) {
-            count += id_handlers_pair.second.size();
-        }
+    // Only the IDs allocated by `getFreeEventID()` can be recycled, the built-in ones are always reserved
+    if (static_cast<int>(id) <= static_cast<int>(ID::CUSTOM)) {
+        return;
+    }
+
+    size_t index = static_cast<size_t>(id);
+    if (index >= _event_id_states.size()) {
+        _event_id_states.resize(index + 1);
     }
 
-    return count;
+    auto &state = _event_id_states[index];
+    if ((state.ref_count > 0) || state.is_available) {
+        return;
+    }
+
+    ESP_UTILS_LOGD("Recycle event ID(%d)", static_cast<int>(id));
+    state.is_available = true;
+    state.available_index = _available_event_ids.size();
+    _available_event_ids.push_back(id);
 }
 
-void Event::cleanEmptyHandlers()
+void Event::removeAvailableEventID(ID id)
 {
-    for (auto it = _event_handlers.begin(); it != _event_handlers.end(); ) {
-        auto &id_map = it->second;
-        for (auto id_it = id_map.begin(); id_it != id_map.end(); ) {
-            if (id_it->second.empty()) {
-                id_it = id_map.erase(id_it);
-            } else {
-                ++id_it;
-            }
-        }
-        if (id_map.empty()) {
-            it = _event_handlers.erase(it);
-        } else {
-            ++it;
-        }
-    }
+    // Swap with the last one, so the removal is O(1)
+    auto &state = _event_id_states[static_cast<size_t>(id)];
+    ID last_id = _available_event_ids.back();
+    _available_event_ids[state.available_index] = last_id;
+    _event_id_states[static_cast<size_t>(last_id)].available_index = state.available_index;
+    _available_event_ids.pop_back();
+    state.is_available = false;
 }
 
 } // namespace esp_brookesia::systems::base
@@ -5,6 +5,8 @@
  */
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
@@ -29,6 +31,11 @@ public:
     };
     using Handler = bool (*)(const HandlerData &data);
 
+    /**
+     * @brief Capacity of the queue used by `postEvent()`, must be a power of two
+     */
+    static constexpr size_t POST_QUEUE_SIZE = 64;
+
     Event();
     ~Event();
 
@@ -43,16 +50,116 @@ public:
 
     ID getFreeEventID();
 
+    /**
+     * @brief Post an event from any thread, it will be dispatched later by `dispatchPostedEvents()` on the thread which
+     *        owns this object (the LVGL task for the event of a system context). This function is lock-free and never
+     *        blocks, so it can be called without holding the LVGL lock.
+     *
+     * @note  The `param` must stay valid until the event is dispatched.
+     *
+     * @param object   The object to send the event to
+     * @param id       The event ID
+     * @param param    The parameter passed to the handlers
+     * @param coalesce If true, only the latest posted event with the same (object, ID) and `coalesce` set is dispatched
+     *                 in one `dispatchPostedEvents()` pass, the earlier ones are dropped
+     *
+     * @return true if the event is queued, false if the queue is full
+     */
+    bool postEvent(void *object, ID id, void *param = nullptr, bool coalesce = false);
+
+    /**
+     * @brief Dispatch all the events posted by `postEvent()` so far. Must only be called on the thread which owns this
+     *        object.
+     *
+     * @return The number of events which are dispatched
+     */
+    size_t dispatchPostedEvents(void);
+
 private:
-    using HandlerList = std::vector<std::pair<Handler, void *>>;
+    /**
+     * @brief All handlers live in one contiguous table sorted by (object, ID). The handlers of the same key form a
+     *        span that keeps the registration order, so a dispatch is a binary search followed by a linear walk.
+     */
+    struct HandlerEntry {
+        void *object;
+        ID id;
+        Handler handler;
+        void *user_data;
+    };
+    using HandlerTable = std::vector<HandlerEntry>;
+
+    struct EntryKeyComparator {
+        bool operator()(const HandlerEntry &entry, const std::pair<void *, ID> &key) const
+        {
+            return compareEntryKey(entry, key);
+        }
+        bool operator()(const std::pair<void *, ID> &key, const HandlerEntry &entry) const
+        {
+            return compareKeyEntry(key, entry);
+        }
+    };
+    /**
+     * @brief Reference count of handlers per event ID, indexed by the ID value. An ID goes back to
+     *        `_available_event_ids` as soon as its count drops to zero, so recycling never scans the table.
+     *        `available_index` is its position there, so it is removed in O(1) when it is registered again.
+     */
+    struct EventIDState {
+        size_t ref_count = 0;
+        size_t available_index = 0;
+        bool is_available = false;
+    };
 
-    bool checkUsedEventID(ID id) const;
-    size_t getEventHandlersCount(void) const;
-    void cleanEmptyHandlers();
+    struct PostedEvent {
+        void *object;
+        ID id;
+        void *param;
+        bool coalesce;
+        bool is_dropped;
+    };
+    /**
+     * @brief Slot of the bounded MPSC ring used by `postEvent()`. The sequence number tells whether the slot is free
+     *        for the producer at a given position or filled for the consumer.
+     */
+    struct PostedEventSlot {
+        std::atomic<size_t> sequence;
+        PostedEvent event;
+    };
+
+    static bool compareEntryKey(const HandlerEntry &entry, const std::pair<void *, ID> &key);
+    static bool compareKeyEntry(const std::pair<void *, ID> &key, const HandlerEntry &entry);
+
+    HandlerTable::const_iterator findHandlerSpanBegin(void *object, ID id) const;
+    std::pair<size_t, size_t> findHandlerSpan(void *object, ID id) const;
+    std::pair<size_t, size_t> findObjectSpan(void *object) const;
+    void insertHandler(const HandlerEntry &entry) const;
+    template <typename Predicate>
+    size_t removeHandlersIf(size_t first, size_t last, Predicate pred);
+    void applyPendingChanges() const;
+
+    bool popPostedEvent(PostedEvent &event);
+
+    void retainEventID(ID id);
+    void releaseEventID(ID id);
+    void recycleEventID(ID id);
+    void removeAvailableEventID(ID id);
 
     ID _free_event_id;
-    std::unordered_map<void *, std::unordered_map<ID, HandlerList>> _event_handlers;
-    std::unordered_set<ID> _available_event_ids;
+    /**
+     * @brief The table is mutable because `sendEvent()` is const but handlers may register or unregister events while
+     *        being dispatched. Such changes are deferred (new entries are parked in `_pending_handlers`, removed entries
+     *        become tombstones with a null handler) and applied once the outermost dispatch returns.
+     */
+    mutable HandlerTable _event_handlers;
+    mutable HandlerTable _pending_handlers;
+    mutable int _dispatch_depth;
+    mutable bool _has_tombstones;
+    std::vector<EventIDState> _event_id_states;
+    std::vector<ID> _available_event_ids;
+
+    std::array<PostedEventSlot, POST_QUEUE_SIZE> _posted_event_slots;
+    std::atomic<size_t> _posted_event_enqueue_pos;
+    size_t _posted_event_dequeue_pos;
+    std::vector<PostedEvent> _posted_event_batch;
 };
 
 } // namespace esp_brookesia::systems::base
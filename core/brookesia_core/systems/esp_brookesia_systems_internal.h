@@ -58,6 +58,13 @@
 #           define ESP_BROOKESIA_BASE_CORE_ENABLE_DEBUG_LOG  (0)
 #       endif
 #   endif
+#   if !defined(ESP_BROOKESIA_BASE_BOOT_SEQUENCE_ENABLE_DEBUG_LOG)
+#       if defined(CONFIG_ESP_BROOKESIA_BASE_BOOT_SEQUENCE_ENABLE_DEBUG_LOG)
+#           define ESP_BROOKESIA_BASE_BOOT_SEQUENCE_ENABLE_DEBUG_LOG  CONFIG_ESP_BROOKESIA_BASE_BOOT_SEQUENCE_ENABLE_DEBUG_LOG
+#       else
+#           define ESP_BROOKESIA_BASE_BOOT_SEQUENCE_ENABLE_DEBUG_LOG  (0)
+#       endif
+#   endif
 #endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
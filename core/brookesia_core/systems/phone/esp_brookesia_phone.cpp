@@ -148,13 +148,29 @@ bool Phone::activateStylesheet(const Stylesheet &stylesheet)
 {
     ESP_UTILS_LOGD("Activate phone(0x%p) stylesheet", this);
 
+    // Keep the handle of the old data, it is immutable, so only the widgets whose data is changed are updated
+    std::shared_ptr<const Stylesheet> old_stylesheet;
+    if (checkCoreInitialized()) {
+        old_stylesheet = getStylesheetHandle();
+    }
+
     ESP_UTILS_CHECK_FALSE_RETURN(
         StylesheetManager::activateStylesheet(stylesheet.core.name, stylesheet.core.screen_size),
         false, "Failed to activate phone stylesheet"
     );
 
-    if (checkCoreInitialized() && !sendDataUpdateEvent()) {
-        ESP_UTILS_LOGE("Send update data event failed");
+    if (old_stylesheet == getStylesheetHandle()) {
+        ESP_UTILS_LOGD("Stylesheet is already active, skip update");
+    } else if (old_stylesheet != nullptr) {
+        auto diff = StylesheetDiff::compare(*old_stylesheet, _active_stylesheet);
+        diff.addSharedField(_active_stylesheet.core);
+        if (!diff.checkChanged()) {
+            ESP_UTILS_LOGD("Stylesheet is not changed, skip update");
+        } else if (!sendDataUpdateEvent(&diff)) {
+            ESP_UTILS_LOGE("Send update data event failed");
+        } else {
+            diff.dump();
+        }
     }
 
     return true;
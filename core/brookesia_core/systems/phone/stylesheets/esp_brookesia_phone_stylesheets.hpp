@@ -1,10 +1,12 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 #pragma once
 
+#include <string_view>
+
 /* Phone */
 #include "default/dark/stylesheet.hpp"
 #include "320_240/dark/stylesheet.hpp"
@@ -15,3 +17,70 @@
 #include "800_1280/dark/stylesheet.hpp"
 #include "1024_600/dark/stylesheet.hpp"
 #include "1280_800/dark/stylesheet.hpp"
+
+namespace esp_brookesia::systems::phone {
+
+struct BuiltinStylesheet {
+    int width;
+    int height;
+    const char *theme;
+    const char *name;       /*!< Expected `core.name` of the stylesheet */
+    const Stylesheet *stylesheet;
+};
+
+/**
+ * @brief Stylesheets of the known resolutions. They should be looked up with `getBuiltinStylesheet()` in a constant
+ *        expression, so only the stylesheet of the board is linked into the image.
+ */
+constexpr BuiltinStylesheet BUILTIN_STYLESHEETS[] = {
+    {320, 240, "dark", "320x240 Dark", &STYLESHEET_320_240_DARK},
+    {320, 480, "dark", "320x480 Dark", &STYLESHEET_320_480_DARK},
+    {480, 480, "dark", "480x480 Dark", &STYLESHEET_480_480_DARK},
+    {720, 1280, "dark", "720x1280 Dark", &STYLESHEET_720_1280_DARK},
+    {800, 480, "dark", "800x480 Dark", &STYLESHEET_800_480_DARK},
+    {800, 1280, "dark", "800x1280 Dark", &STYLESHEET_800_1280_DARK},
+    {1024, 600, "dark", "1024x600 Dark", &STYLESHEET_1024_600_DARK},
+    {1280, 800, "dark", "1280x800 Dark", &STYLESHEET_1280_800_DARK},
+};
+
+/**
+ * @brief Get the built-in stylesheet of the resolution and theme
+ *
+ * @return The stylesheet, or `nullptr` if there is none
+ */
+constexpr const Stylesheet *getBuiltinStylesheet(int width, int height, std::string_view theme = "dark")
+{
+    for (auto &builtin : BUILTIN_STYLESHEETS) {
+        if ((builtin.width == width) && (builtin.height == height) && (theme == builtin.theme)) {
+            return builtin.stylesheet;
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Check at compile time that each built-in stylesheet is the one of its entry, by its name and its screen size,
+ *        and that no two entries share a key. So a wrong entry fails the build instead of the calibration at boot
+ */
+constexpr bool checkBuiltinStylesheets()
+{
+    for (auto &builtin : BUILTIN_STYLESHEETS) {
+        const auto &core = builtin.stylesheet->core;
+        if ((core.name == nullptr) || (std::string_view(core.name) != builtin.name)) {
+            return false;
+        }
+        if (core.screen_size.flags.enable_width_percent || core.screen_size.flags.enable_height_percent ||
+                (core.screen_size.width != builtin.width) || (core.screen_size.height != builtin.height)) {
+            return false;
+        }
+        if (getBuiltinStylesheet(builtin.width, builtin.height, builtin.theme) != builtin.stylesheet) {
+            return false;
+        }
+    }
+
+    return true;
+}
+static_assert(checkBuiltinStylesheets(), "Invalid built-in phone stylesheet");
+
+} // namespace esp_brookesia::systems::phone
@@ -637,6 +637,12 @@ void AppLauncher::onDataUpdateEventCallback(lv_event_t *event)
     app_launcher = (AppLauncher *)lv_event_get_user_data(event);
     ESP_UTILS_CHECK_NULL_EXIT(app_launcher, "Invalid app launcher object");
 
+    auto diff = static_cast<gui::StylesheetDiff *>(lv_event_get_param(event));
+    if (!gui::StylesheetDiff::checkUpdateNeeded(diff, app_launcher->_data)) {
+        ESP_UTILS_LOGD("Data is not changed, skip");
+        return;
+    }
+
     ESP_UTILS_CHECK_FALSE_EXIT(app_launcher->updateByNewData(), "Update object style failed");
 }
 
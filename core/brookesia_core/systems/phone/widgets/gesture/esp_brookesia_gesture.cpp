@@ -468,6 +468,12 @@ void Gesture::onDataUpdateEventCallback(lv_event_t *event)
     gesture = (Gesture *)lv_event_get_user_data(event);
     ESP_UTILS_CHECK_NULL_EXIT(gesture, "Invalid gesture object");
 
+    auto diff = static_cast<gui::StylesheetDiff *>(lv_event_get_param(event));
+    if (!gui::StylesheetDiff::checkUpdateNeeded(diff, gesture->data)) {
+        ESP_UTILS_LOGD("Data is not changed, skip");
+        return;
+    }
+
     ESP_UTILS_CHECK_FALSE_EXIT(gesture->updateByNewData(), "Update gesture object style failed");
 }
 
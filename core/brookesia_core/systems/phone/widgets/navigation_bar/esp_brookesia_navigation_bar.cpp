@@ -528,6 +528,12 @@ void NavigationBar::onDataUpdateEventCallback(lv_event_t *event)
     navigation_bar = (NavigationBar *)lv_event_get_user_data(event);
     ESP_UTILS_CHECK_NULL_EXIT(navigation_bar, "Invalid navigation bar object");
 
+    auto diff = static_cast<gui::StylesheetDiff *>(lv_event_get_param(event));
+    if (!gui::StylesheetDiff::checkUpdateNeeded(diff, navigation_bar->_data)) {
+        ESP_UTILS_LOGD("Data is not changed, skip");
+        return;
+    }
+
     ESP_UTILS_CHECK_FALSE_EXIT(navigation_bar->updateByNewData(), "Update failed");
 }
 
@@ -583,6 +583,12 @@ void RecentsScreen::onDataUpdateEventCallback(lv_event_t *event)
     recents_screen = (RecentsScreen *)lv_event_get_user_data(event);
     ESP_UTILS_CHECK_NULL_EXIT(recents_screen, "Invalid app snapshot_table object");
 
+    auto diff = static_cast<gui::StylesheetDiff *>(lv_event_get_param(event));
+    if (!gui::StylesheetDiff::checkUpdateNeeded(diff, recents_screen->_data)) {
+        ESP_UTILS_LOGD("Data is not changed, skip");
+        return;
+    }
+
     ESP_UTILS_CHECK_FALSE_EXIT(recents_screen->updateByNewData(), "Update object style failed");
 }
 
@@ -716,9 +716,19 @@ void StatusBar::onDataUpdateEventCallback(lv_event_t *event)
     status_bar = (StatusBar *)lv_event_get_user_data(event);
     ESP_UTILS_CHECK_NULL_EXIT(status_bar, "Invalid status bar object");
 
+    auto diff = static_cast<gui::StylesheetDiff *>(lv_event_get_param(event));
+    if (!gui::StylesheetDiff::checkUpdateNeeded(diff, status_bar->_data)) {
+        ESP_UTILS_LOGD("Data is not changed, skip");
+        return;
+    }
+
     // Main
     ESP_UTILS_CHECK_FALSE_EXIT(status_bar->updateMainByNewData(), "Update main object style failed");
     for (auto &icon : status_bar->_id_icon_map) {
+        // The icons only use their own data
+        if (!gui::StylesheetDiff::checkUpdateNeeded(diff, icon.second->getData())) {
+            continue;
+        }
         if (!icon.second->updateByNewData()) {
             ESP_UTILS_LOGE("Update icon(%d) style failed", icon.first);
         }
@@ -45,6 +45,11 @@ public:
 
     bool updateByNewData(void);
 
+    const Data &getData(void) const
+    {
+        return _data;
+    }
+
 private:
     const Data &_data;
 
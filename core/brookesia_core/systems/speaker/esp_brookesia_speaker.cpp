@@ -95,24 +95,128 @@ bool Speaker::begin(void)
     }
     ESP_UTILS_CHECK_NULL_RETURN(_active_stylesheet.core.name, false, "Invalid active stylesheet");
 
-    ESP_UTILS_CHECK_FALSE_RETURN(base::Context::begin(), false, "Failed to begin core");
-    ESP_UTILS_CHECK_FALSE_RETURN(_display.begin(), false, "Failed to begin display");
+    ESP_UTILS_CHECK_EXCEPTION_RETURN(
+        _boot_sequence = std::make_unique<base::BootSequence>(), false, "Create boot sequence failed"
+    );
+    ESP_UTILS_CHECK_FALSE_RETURN(addBuiltinBootStages(), false, "Add built-in boot stages failed");
+    for (auto &stage : _extra_boot_stages) {
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            _boot_sequence->addStage(stage.name, stage.runner, stage.function, stage.dependencies, stage.cleanup),
+            false, "Add boot stage(%s) failed", stage.name.c_str()
+        );
+    }
 
-    // Initialize agent before boot animation to prevent waiting for boot animation if crash happens
-    auto agent = ai_framework::Agent::requestInstance();
-    ESP_UTILS_CHECK_NULL_RETURN(agent, false, "Failed to request agent instance");
-    ESP_UTILS_CHECK_FALSE_RETURN(agent->begin(), false, "Agent begin failed");
+    bool ret = _boot_sequence->run();
+    _boot_sequence->dumpTimeline();
+    // The stages may refer to the state of the caller, which is gone once `begin()` returns
+    _extra_boot_stages.clear();
+    ESP_UTILS_CHECK_FALSE_RETURN(ret, false, "Run boot sequence failed");
 
-    // Show boot animation after agent begin
-    ESP_UTILS_CHECK_FALSE_RETURN(_display.processDummyDraw(true), false, "Process dummy draw failed");
-    ESP_UTILS_CHECK_FALSE_RETURN(_display.startBootAnimation(), false, "Start boot animation failed");
-    audio_prompt_play_with_block(MUSIC_FILE_BOOT, -1);
-    ESP_UTILS_CHECK_FALSE_RETURN(_display.waitBootAnimationStop(), false, "Wait boot animation stop failed");
+    return true;
+}
+
+bool Speaker::addBootStage(
+    const std::string &name, base::BootSequence::Runner runner, base::BootSequence::Function function,
+    const std::vector<std::string> &dependencies, base::BootSequence::Function cleanup
+)
+{
+    ESP_UTILS_LOGD("Add boot stage(%s)", name.c_str());
+    ESP_UTILS_CHECK_FALSE_RETURN(!checkCoreInitialized(), false, "Should be called before begin");
 
+    ESP_UTILS_CHECK_EXCEPTION_RETURN(
+        _extra_boot_stages.push_back({name, runner, std::move(function), dependencies, std::move(cleanup)}), false,
+        "Add boot stage failed"
+    );
+
+    return true;
+}
+
+bool Speaker::addBuiltinBootStages(void)
+{
+    using Runner = base::BootSequence::Runner;
+
+    auto agent = ai_framework::Agent::requestInstance();
+    ESP_UTILS_CHECK_NULL_RETURN(agent, false, "Failed to request agent instance");
     auto ai_buddy = AI_Buddy::requestInstance();
     ESP_UTILS_CHECK_NULL_RETURN(ai_buddy, false, "Failed to request ai buddy instance");
-    ESP_UTILS_CHECK_FALSE_RETURN(ai_buddy->begin(_active_stylesheet.ai_buddy), false, "Failed to begin ai buddy");
-    ESP_UTILS_CHECK_FALSE_RETURN(_manager.begin(), false, "Failed to begin manager");
+
+    // The stages on the caller use LVGL, so they run one by one while the boot animation and jingle play. The other
+    // stages only wait for the animation and audio, or load the assets of the expression.
+    std::vector<BootStage> stages = {
+        {
+            BOOT_STAGE_CORE, Runner::CALLER, [this]() {
+                ESP_UTILS_CHECK_FALSE_RETURN(base::Context::begin(), false, "Failed to begin core");
+                return true;
+            }, {}
+        },
+        {
+            BOOT_STAGE_DISPLAY, Runner::CALLER, [this]() {
+                ESP_UTILS_CHECK_FALSE_RETURN(_display.begin(), false, "Failed to begin display");
+                return true;
+            }, {BOOT_STAGE_CORE}
+        },
+        // Initialize agent before boot animation to prevent waiting for boot animation if crash happens
+        {
+            BOOT_STAGE_AGENT, Runner::CALLER, [agent]() {
+                ESP_UTILS_CHECK_FALSE_RETURN(agent->begin(), false, "Agent begin failed");
+                return true;
+            }, {}
+        },
+        {
+            BOOT_STAGE_BOOT_ANIMATION, Runner::CALLER, [this]() {
+                ESP_UTILS_CHECK_FALSE_RETURN(_display.processDummyDraw(true), false, "Process dummy draw failed");
+                ESP_UTILS_CHECK_FALSE_RETURN(_display.startBootAnimation(), false, "Start boot animation failed");
+                return true;
+            }, {BOOT_STAGE_DISPLAY, BOOT_STAGE_AGENT}
+        },
+        {
+            BOOT_STAGE_BOOT_JINGLE, Runner::WORKER, []() {
+                audio_prompt_play_with_block(MUSIC_FILE_BOOT, -1);
+                return true;
+            }, {BOOT_STAGE_BOOT_ANIMATION}
+        },
+        {
+            BOOT_STAGE_BOOT_ANIMATION_STOP, Runner::WORKER, [this]() {
+                ESP_UTILS_CHECK_FALSE_RETURN(
+                    _display.waitBootAnimationStop(), false, "Wait boot animation stop failed"
+                );
+                return true;
+            }, {BOOT_STAGE_BOOT_ANIMATION}
+        },
+        // Load the expression assets and register the WiFi and IP event handlers. It is deleted by the cleanup on the
+        // caller if the boot fails, not on the worker
+        {
+            BOOT_STAGE_AI_BUDDY, Runner::WORKER, [this, ai_buddy]() {
+                ESP_UTILS_CHECK_FALSE_RETURN(
+                    ai_buddy->begin(_active_stylesheet.ai_buddy, false), false, "Failed to begin ai buddy"
+                );
+                return true;
+            }, {BOOT_STAGE_AGENT}, [ai_buddy]() {
+                ESP_UTILS_CHECK_FALSE_RETURN(ai_buddy->del(), false, "Failed to delete ai buddy");
+                return true;
+            }
+        },
+        {
+            BOOT_STAGE_MANAGER, Runner::CALLER, [this]() {
+                ESP_UTILS_CHECK_FALSE_RETURN(_manager.begin(), false, "Failed to begin manager");
+                return true;
+            }, {BOOT_STAGE_DISPLAY}
+        },
+        // The expression is drawn on the ai_buddy screen, so load it after the boot animation and jingle
+        {
+            BOOT_STAGE_DEFAULT_SCREEN, Runner::CALLER, [this]() {
+                ESP_UTILS_CHECK_FALSE_RETURN(_manager.loadDefaultScreen(), false, "Load default screen failed");
+                return true;
+            }, {BOOT_STAGE_MANAGER, BOOT_STAGE_AI_BUDDY, BOOT_STAGE_BOOT_ANIMATION_STOP, BOOT_STAGE_BOOT_JINGLE}
+        },
+    };
+    for (auto &stage : stages) {
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            _boot_sequence->addStage(
+                stage.name, stage.runner, std::move(stage.function), stage.dependencies, std::move(stage.cleanup)
+            ), false, "Add boot stage(%s) failed", stage.name.c_str()
+        );
+    }
 
     return true;
 }
@@ -121,6 +225,7 @@ bool Speaker::del(void)
 {
     ESP_UTILS_LOGD("Delete(@0x%p)", this);
 
+    _extra_boot_stages.clear();
     if (!checkCoreInitialized()) {
         return true;
     }
@@ -166,13 +271,29 @@ bool Speaker::activateStylesheet(const Stylesheet &stylesheet)
 {
     ESP_UTILS_LOGD("Activate speaker(0x%p) stylesheet", this);
 
+    // Keep the handle of the old data, it is immutable, so only the widgets whose data is changed are updated
+    std::shared_ptr<const Stylesheet> old_stylesheet;
+    if (checkCoreInitialized()) {
+        old_stylesheet = getStylesheetHandle();
+    }
+
     ESP_UTILS_CHECK_FALSE_RETURN(
         StylesheetManager::activateStylesheet(stylesheet.core.name, stylesheet.core.screen_size),
         false, "Failed to activate speaker stylesheet"
     );
 
-    if (checkCoreInitialized() && !sendDataUpdateEvent()) {
-        ESP_UTILS_LOGE("Send update data event failed");
+    if (old_stylesheet == getStylesheetHandle()) {
+        ESP_UTILS_LOGD("Stylesheet is already active, skip update");
+    } else if (old_stylesheet != nullptr) {
+        auto diff = gui::StylesheetDiff::compare(*old_stylesheet, _active_stylesheet);
+        diff.addSharedField(_active_stylesheet.core);
+        if (!diff.checkChanged()) {
+            ESP_UTILS_LOGD("Stylesheet is not changed, skip update");
+        } else if (!sendDataUpdateEvent(&diff)) {
+            ESP_UTILS_LOGE("Send update data event failed");
+        } else {
+            diff.dump();
+        }
     }
 
     return true;
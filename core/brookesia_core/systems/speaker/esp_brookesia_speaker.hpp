@@ -6,7 +6,11 @@
 #pragma once
 
 #include <list>
+#include <memory>
+#include <string>
+#include <vector>
 #include "systems/base/esp_brookesia_base_context.hpp"
+#include "systems/base/esp_brookesia_base_boot_sequence.hpp"
 #include "gui/style/esp_brookesia_gui_stylesheet_manager.hpp"
 #include "esp_brookesia_speaker_ai_buddy.hpp"
 #include "esp_brookesia_speaker_display.hpp"
@@ -26,6 +30,19 @@ using StylesheetManager = gui::StylesheetManager<Stylesheet>;
 
 class Speaker: public base::Context, public StylesheetManager {
 public:
+    /**
+     * @brief Names of the boot stages of `begin()`, which the extra stages can depend on
+     */
+    static constexpr const char *BOOT_STAGE_CORE = "core";
+    static constexpr const char *BOOT_STAGE_DISPLAY = "display";
+    static constexpr const char *BOOT_STAGE_AGENT = "agent";
+    static constexpr const char *BOOT_STAGE_BOOT_ANIMATION = "boot_animation";
+    static constexpr const char *BOOT_STAGE_BOOT_JINGLE = "boot_jingle";
+    static constexpr const char *BOOT_STAGE_BOOT_ANIMATION_STOP = "boot_animation_stop";
+    static constexpr const char *BOOT_STAGE_AI_BUDDY = "ai_buddy";
+    static constexpr const char *BOOT_STAGE_MANAGER = "manager";
+    static constexpr const char *BOOT_STAGE_DEFAULT_SCREEN = "default_screen";
+
     Speaker(lv_disp_t *display_device = nullptr);
     ~Speaker();
 
@@ -40,6 +57,18 @@ public:
     bool uninstallApp(App *app);
     bool uninstallApp(int id);
 
+    /**
+     * @brief Add an extra stage to the boot sequence of `begin()`, such as installing the apps. It should be called
+     *        before `begin()`, and it runs after the built-in stages it depends on.
+     *
+     * @note  The stages on `Runner::CALLER` run on the thread which calls `begin()` with the LVGL lock, so they can use
+     *        LVGL. The ones on `Runner::WORKER` must not, `gui::LvLock` fails in them. The cleanup is called on the
+     *        caller if the boot fails, see `base::BootSequence::run()`.
+     */
+    bool addBootStage(
+        const std::string &name, base::BootSequence::Runner runner, base::BootSequence::Function function,
+        const std::vector<std::string> &dependencies, base::BootSequence::Function cleanup = nullptr
+    );
     bool begin(void);
     bool del(void);
     bool addStylesheet(const Stylesheet &stylesheet);
@@ -57,12 +86,31 @@ public:
     {
         return _manager;
     }
+    /**
+     * @brief Get the boot sequence of the last `begin()`, which has the timeline of the stages
+     */
+    const base::BootSequence *getBootSequence(void) const
+    {
+        return _boot_sequence.get();
+    }
 
 private:
     bool calibrateStylesheet(const gui::StyleSize &screen_size, Stylesheet &sheetstyle) override;
 
+    struct BootStage {
+        std::string name;
+        base::BootSequence::Runner runner;
+        base::BootSequence::Function function;
+        std::vector<std::string> dependencies;
+        base::BootSequence::Function cleanup;
+    };
+
+    bool addBuiltinBootStages(void);
+
     Display _display;
     Manager _manager;
+    std::vector<BootStage> _extra_boot_stages;
+    std::unique_ptr<base::BootSequence> _boot_sequence;
 
     // static const Stylesheet _default_stylesheet_dark;
 };
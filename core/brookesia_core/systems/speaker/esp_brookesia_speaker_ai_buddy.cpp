@@ -38,7 +38,7 @@ AI_Buddy::~AI_Buddy()
     ESP_UTILS_CHECK_FALSE_EXIT(!_flags.is_begun || del(), "Del failed");
 }
 
-bool AI_Buddy::begin(const Data &data)
+bool AI_Buddy::begin(const Data &data, bool del_on_fail)
 {
     ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
 
@@ -55,6 +55,9 @@ bool AI_Buddy::begin(const Data &data)
             ESP_UTILS_LOGE("Del failed");
         }
     });
+    if (!del_on_fail) {
+        del_function.release();
+    }
 
     ESP_UTILS_CHECK_NULL_RETURN(_agent = ai_framework::Agent::requestInstance(), false, "Invalid agent");
     ESP_UTILS_CHECK_FALSE_RETURN(_agent->begin(), false, "Agent begin failed");
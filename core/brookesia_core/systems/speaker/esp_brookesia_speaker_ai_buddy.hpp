@@ -56,7 +56,11 @@ public:
 
     ~AI_Buddy();
 
-    bool begin(const Data &data);
+    /**
+     * @param del_on_fail Delete on failure. Set it to false if `del()` should run on another thread, such as a boot
+     *                    stage on a worker, whose cleanup is called on the thread holding the LVGL lock
+     */
+    bool begin(const Data &data, bool del_on_fail = true);
     bool resume();
     bool pause();
     bool del();
@@ -130,7 +130,9 @@ bool Manager::begin(void)
         );
     });
     // Process quick settings storage service event signal
-    StorageNVS::requestInstance().connectEventSignal([this](const StorageNVS::Event & event) {
+    StorageNVS::requestInstance().connectKeyEventSignal({
+        SETTINGS_WLAN_SWITCH, SETTINGS_VOLUME, SETTINGS_BRIGHTNESS
+    }, [this](const StorageNVS::Event & event) {
         if ((event.operation != StorageNVS::Operation::UpdateNVS) || (event.sender == &display.getQuickSettings())) {
             ESP_UTILS_LOGD("Ignore event: operation(%d), sender(%p)", static_cast<int>(event.operation), event.sender);
             return;
@@ -365,7 +367,14 @@ bool Manager::begin(void)
 
     _flags.is_initialized = true;
 
-    // Then load the ai_buddy screen
+    return true;
+}
+
+bool Manager::loadDefaultScreen(void)
+{
+    ESP_UTILS_LOG_TRACE_GUARD_WITH_THIS();
+
+    // The ai_buddy screen draws the expression, so it should be loaded after the boot animation stops
     ESP_UTILS_CHECK_FALSE_RETURN(
         processDisplayScreenChange(Screen::DRAW_DUMMY, nullptr), false,
         "Process screen change failed"
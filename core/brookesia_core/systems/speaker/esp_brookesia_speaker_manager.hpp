@@ -92,6 +92,7 @@ private:
     // Main
     bool begin(void);
     bool del(void);
+    bool loadDefaultScreen(void);
     // Display
     bool processGestureScreenChange(Screen screen, void *param);
     bool processAI_BuddyResumeTimer(void);
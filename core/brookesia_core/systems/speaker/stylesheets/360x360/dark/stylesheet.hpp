@@ -128,6 +128,9 @@ constexpr AI_Buddy::Data STYLESHEET_360_360_DARK_AI_BUDDY_DATA = {
                     //             .fps = 30,
                     //         },
                     //     },
+                    //     // The emotions are only preloaded from the files, keep room for the playing and the preloaded ones
+                    //     .cache_num = 3,
+                    //     .enable_mmap = false,
                     // },
                     .task = {
                         .task_priority = 4,
@@ -135,10 +138,20 @@ constexpr AI_Buddy::Data STYLESHEET_360_360_DARK_AI_BUDDY_DATA = {
                         .task_affinity = 0,
                         .task_stack_in_ext = true,
                     },
+                    .pipeline = {
+                        .buffer_num = 2,
+                        .task_affinity = 1,
+                    },
+                    .delta = {
+                        .enable = true,
+                        .max_rect_num = 4,
+                    },
                     .flags = {
                         .enable_data_swap_bytes = true,
+                        .enable_frame_drop = true,
                     },
                 },
+                .preload_num = 2,
             },
             .icon = {
                 .data = {
@@ -205,6 +218,12 @@ constexpr AI_Buddy::Data STYLESHEET_360_360_DARK_AI_BUDDY_DATA = {
                     },
                 },
             },
+            .scheduler = {
+                .worker_num = 2,
+                .task_priority = 4,
+                .task_stack = 10 * 1024,
+                .task_stack_in_ext = true,
+            },
             .flags = {
                 .enable_emotion = true,
                 .enable_icon = true,
@@ -3,9 +3,14 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include "esp_log.h"
 #include "unity.h"
 #include "unity_test_runner.h"
@@ -19,6 +24,10 @@ using namespace esp_brookesia::systems::phone;
 #define TEST_LVGL_RESOLUTION_WIDTH          CONFIG_TEST_LVGL_RESOLUTION_WIDTH
 #define TEST_LVGL_RESOLUTION_HEIGHT         CONFIG_TEST_LVGL_RESOLUTION_HEIGHT
 #define TEST_INSTALL_UNINSTALL_APP_TIMES    (10)
+#define TEST_HANDLE_POOL_CYCLE_TIMES        (5)
+#define TEST_HANDLE_POOL_OBJECT_NUM         (7)
+#define TEST_HANDLE_THREAD_NUM              (4)
+#define TEST_HANDLE_THREAD_LOOP_NUM         (1000)
 
 /* Try using a stylesheet that corresponds to the resolution */
 #if (TEST_LVGL_RESOLUTION_WIDTH == 320) && (TEST_LVGL_RESOLUTION_HEIGHT == 240)
@@ -41,6 +50,12 @@ using namespace esp_brookesia::systems::phone;
 
 static const char *TAG = "test_esp_brookesia_phone";
 
+// Leaves the objects alive, so the benchmark of the handles does not include the objects
+struct TestHandleKeepDeleter {
+    void operator()(lv_obj_t *) const {}
+};
+using TestObjKeepHandle = gui::LvHandle<lv_obj_t, TestHandleKeepDeleter>;
+
 static void test_lvgl_init(lv_display_t **disp_out, lv_indev_t **tp_out);
 static void test_lvgl_deinit(lv_display_t *disp, lv_indev_t *indev);
 static systems::phone::Phone *test_esp_brookesia_phone_init(lv_display_t *disp, lv_indev_t *tp, bool enable_begin);
@@ -90,6 +105,182 @@ TEST_CASE("test esp-brookesia to add stylesheet", "[esp-brookesia][phone][add_st
     delete phone_stylesheet;
     TEST_ASSERT_TRUE_MESSAGE(phone->begin(), "Failed to begin phone");
 
+    test_esp_brookesia_phone_deinit(phone);
+    phone = test_esp_brookesia_phone_init(disp, tp, false);
+
+    // Use the built-in stylesheet without a copy, and measure the time and heap of adding and activating it
+    constexpr auto builtin_stylesheet = systems::phone::getBuiltinStylesheet(
+                                            TEST_LVGL_RESOLUTION_WIDTH, TEST_LVGL_RESOLUTION_HEIGHT
+                                        );
+    TEST_ASSERT_NOT_NULL_MESSAGE(builtin_stylesheet, "No built-in stylesheet");
+    auto heap_before = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    auto time_before = esp_timer_get_time();
+    TEST_ASSERT_TRUE_MESSAGE(phone->addStylesheet(builtin_stylesheet), "Failed to add built-in stylesheet");
+    TEST_ASSERT_TRUE_MESSAGE(phone->activateStylesheet(builtin_stylesheet), "Failed to active built-in stylesheet");
+    ESP_LOGI(TAG, "Add and activate built-in stylesheet: %d us, %d bytes",
+             static_cast<int>(esp_timer_get_time() - time_before),
+             static_cast<int>(heap_before - heap_caps_get_free_size(MALLOC_CAP_DEFAULT)));
+    TEST_ASSERT_TRUE_MESSAGE(phone->begin(), "Failed to begin phone");
+
+    test_esp_brookesia_phone_deinit(phone);
+    test_lvgl_deinit(disp, tp);
+}
+#endif
+
+TEST_CASE("test esp-brookesia lvgl handle pool", "[esp-brookesia][phone][handle_pool]")
+{
+    lv_display_t *disp = nullptr;
+    lv_indev_t *tp = nullptr;
+
+    test_lvgl_init(&disp, &tp);
+
+    // Same number of objects as `RecentsScreenSnapshot::begin()`. The objects are created first and the handles do
+    // not delete them, so only the heap used by the handles themselves is compared
+    std::vector<lv_obj_t *> native_objs;
+    for (int i = 0; i < TEST_HANDLE_POOL_OBJECT_NUM; i++) {
+        native_objs.push_back(lv_obj_create(lv_screen_active()));
+    }
+    auto heap_before = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    {
+        std::shared_ptr<lv_obj_t> objs[TEST_HANDLE_POOL_OBJECT_NUM];
+        auto heap_objs = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+        for (int i = 0; i < TEST_HANDLE_POOL_OBJECT_NUM; i++) {
+            objs[i] = std::shared_ptr<lv_obj_t>(native_objs[i], TestHandleKeepDeleter());
+        }
+        auto shared_ptr_bytes = heap_objs - heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+        ESP_LOGI(TAG, "shared_ptr: %d bytes for %d objects", static_cast<int>(shared_ptr_bytes),
+                 TEST_HANDLE_POOL_OBJECT_NUM);
+        // One control block for each object
+        TEST_ASSERT_TRUE(shared_ptr_bytes > 0);
+    }
+    for (int round = 0; round < 2; round++) {
+        TestObjKeepHandle objs[TEST_HANDLE_POOL_OBJECT_NUM];
+        auto heap_objs = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+        for (int i = 0; i < TEST_HANDLE_POOL_OBJECT_NUM; i++) {
+            objs[i] = TestObjKeepHandle(native_objs[i]);
+        }
+        auto handle_bytes = heap_objs - heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+        ESP_LOGI(TAG, "LvHandle (round %d): %d bytes for %d objects", round, static_cast<int>(handle_bytes),
+                 TEST_HANDLE_POOL_OBJECT_NUM);
+        // At most a new slab in the first round, the nodes are recycled afterwards
+        if (round > 0) {
+            TEST_ASSERT_EQUAL(0, handle_bytes);
+        }
+    }
+    for (auto obj : native_objs) {
+        lv_obj_delete(obj);
+    }
+    ESP_LOGI(TAG, "Heap kept by the pool: %d bytes",
+             static_cast<int>(heap_before - heap_caps_get_free_size(MALLOC_CAP_DEFAULT)));
+
+    // Begin and delete the phone repeatedly, all its widgets are created and deleted in each cycle
+    gui::LvHandlePool::Stats first_stats = {};
+    for (int i = 0; i < TEST_HANDLE_POOL_CYCLE_TIMES; i++) {
+        auto phone = test_esp_brookesia_phone_init(disp, tp, true);
+        auto stats = gui::LvHandlePool::getStats();
+        test_esp_brookesia_phone_deinit(phone);
+
+        ESP_LOGI(TAG, "Cycle %d: handles(%d), slabs(%d), heap free(%d), largest free block(%d)", i,
+                 static_cast<int>(stats.used_node_num), static_cast<int>(stats.slab_num),
+                 static_cast<int>(heap_caps_get_free_size(MALLOC_CAP_DEFAULT)),
+                 static_cast<int>(heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT)));
+        if (i == 0) {
+            first_stats = stats;
+        } else {
+            TEST_ASSERT_EQUAL_MESSAGE(first_stats.slab_num, stats.slab_num, "Slabs should be reused");
+        }
+    }
+    gui::LvHandlePool::dumpStats();
+
+    test_lvgl_deinit(disp, tp);
+}
+
+TEST_CASE("test esp-brookesia lvgl handle threads", "[esp-brookesia][phone][handle_pool]")
+{
+    static std::atomic<int> delete_count = 0;
+    struct CountDeleter {
+        void operator()(int *) const
+        {
+            delete_count++;
+        }
+    };
+    using CountHandle = gui::LvHandle<int, CountDeleter>;
+
+    // Copy and release a shared handle, and create and release new ones, in several threads at once
+    int native_handle = 0;
+    delete_count = 0;
+    auto stats_before = gui::LvHandlePool::getStats();
+    {
+        CountHandle shared_handle(&native_handle);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < TEST_HANDLE_THREAD_NUM; i++) {
+            threads.emplace_back([&shared_handle, &native_handle]() {
+                for (int j = 0; j < TEST_HANDLE_THREAD_LOOP_NUM; j++) {
+                    CountHandle copy = shared_handle;
+                    CountHandle own(&native_handle);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        TEST_ASSERT_EQUAL(1, shared_handle.use_count());
+        TEST_ASSERT_EQUAL(TEST_HANDLE_THREAD_NUM * TEST_HANDLE_THREAD_LOOP_NUM, delete_count.load());
+    }
+    TEST_ASSERT_EQUAL(TEST_HANDLE_THREAD_NUM * TEST_HANDLE_THREAD_LOOP_NUM + 1, delete_count.load());
+    auto stats_after = gui::LvHandlePool::getStats();
+    TEST_ASSERT_EQUAL(stats_before.used_node_num, stats_after.used_node_num);
+    TEST_ASSERT_EQUAL(
+        stats_before.alloc_count + TEST_HANDLE_THREAD_NUM * TEST_HANDLE_THREAD_LOOP_NUM + 1, stats_after.alloc_count
+    );
+}
+
+#ifdef TEST_ESP_BROOKESIA_PHONE_DARK_STYLESHEET
+TEST_CASE("test esp-brookesia stylesheet diff", "[esp-brookesia][phone][stylesheet_diff]")
+{
+    lv_display_t *disp = nullptr;
+    lv_indev_t *tp = nullptr;
+    systems::phone::Phone *phone = nullptr;
+
+    // Only change the background color of the status bar
+    auto old_stylesheet = std::make_unique<systems::phone::Stylesheet>(TEST_ESP_BROOKESIA_PHONE_DARK_STYLESHEET());
+    auto new_stylesheet = std::make_unique<systems::phone::Stylesheet>(*old_stylesheet);
+    new_stylesheet->core.name = "test_diff";
+    new_stylesheet->display.status_bar.data.main.background_color.color ^= 0xFFFFFF;
+
+    {
+        auto &new_display = new_stylesheet->display;
+        auto diff = gui::StylesheetDiff::compare(old_stylesheet->display, new_display);
+        TEST_ASSERT_TRUE(diff.checkChanged());
+        TEST_ASSERT_TRUE(diff.checkFieldChanged(new_display.status_bar.data.main.background_color));
+        TEST_ASSERT_FALSE(diff.checkFieldChanged(new_display.status_bar.data.main.text_color));
+        TEST_ASSERT_FALSE(diff.checkFieldChanged(new_display.navigation_bar));
+        // The fields outside the compared data are always changed
+        TEST_ASSERT_TRUE(diff.checkFieldChanged(old_stylesheet->display.navigation_bar));
+
+        TEST_ASSERT_TRUE(gui::StylesheetDiff::checkUpdateNeeded(&diff, new_display.status_bar.data));
+        TEST_ASSERT_FALSE(gui::StylesheetDiff::checkUpdateNeeded(&diff, new_display.navigation_bar.data));
+        TEST_ASSERT_FALSE(gui::StylesheetDiff::checkUpdateNeeded(&diff, new_display.app_launcher.data));
+        TEST_ASSERT_FALSE(gui::StylesheetDiff::checkUpdateNeeded(&diff, new_display.recents_screen.data));
+        TEST_ASSERT_EQUAL(1, diff.getTouchedNum());
+        TEST_ASSERT_EQUAL(3, diff.getSkippedNum());
+        diff.dump();
+    }
+
+    // Switch between the two stylesheets, only the status bar should be updated
+    test_lvgl_init(&disp, &tp);
+    phone = test_esp_brookesia_phone_init(disp, tp, false);
+    TEST_ASSERT_TRUE_MESSAGE(phone->addStylesheet(*old_stylesheet), "Failed to add old stylesheet");
+    TEST_ASSERT_TRUE_MESSAGE(phone->addStylesheet(*new_stylesheet), "Failed to add new stylesheet");
+    TEST_ASSERT_TRUE_MESSAGE(phone->activateStylesheet(*old_stylesheet), "Failed to active old stylesheet");
+    TEST_ASSERT_TRUE_MESSAGE(phone->begin(), "Failed to begin phone");
+    for (int i = 0; i < 2; i++) {
+        auto time_before = esp_timer_get_time();
+        TEST_ASSERT_TRUE_MESSAGE(phone->activateStylesheet(*new_stylesheet), "Failed to active new stylesheet");
+        TEST_ASSERT_TRUE_MESSAGE(phone->activateStylesheet(*old_stylesheet), "Failed to active old stylesheet");
+        ESP_LOGI(TAG, "Switch stylesheets twice: %d us", static_cast<int>(esp_timer_get_time() - time_before));
+    }
+
     test_esp_brookesia_phone_deinit(phone);
     test_lvgl_deinit(disp, tp);
 }
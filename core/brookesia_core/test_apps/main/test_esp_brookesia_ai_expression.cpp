@@ -0,0 +1,62 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "sdkconfig.h"
+#if CONFIG_ESP_BROOKESIA_AI_FRAMEWORK_ENABLE_EXPRESSION
+#include <vector>
+#include "unity.h"
+#include "esp_brookesia.hpp"
+#include "ai_framework/expression/esp_brookesia_ai_expression.hpp"
+
+using namespace esp_brookesia::ai_framework;
+
+TEST_CASE("test expression emotion history", "[esp-brookesia][ai_framework][expression]")
+{
+    ExpressionEmotionHistory history;
+    TEST_ASSERT_TRUE(history.predict(2).empty());
+
+    // Nothing to predict from the first emotion alone
+    history.use(0);
+    TEST_ASSERT_TRUE(history.predict(2).empty());
+
+    // The previous emotion comes first, even if it is used less
+    for (int i = 0; i < 3; i++) {
+        history.use(1);
+        history.use(2);
+    }
+    history.use(3);
+    TEST_ASSERT_TRUE((std::vector<int>{2, 1}) == history.predict(2));
+    // Ties of the use counts keep the order of the types, the current emotion is never predicted
+    TEST_ASSERT_TRUE((std::vector<int>{2, 1, 0}) == history.predict(3));
+    TEST_ASSERT_TRUE((std::vector<int>{2}) == history.predict(1));
+    TEST_ASSERT_TRUE(history.predict(0).empty());
+
+    // Switching back to the most used one makes the previous emotion the first again
+    history.use(1);
+    TEST_ASSERT_TRUE((std::vector<int>{3, 2}) == history.predict(2));
+
+    history.clear();
+    TEST_ASSERT_TRUE(history.predict(2).empty());
+}
+
+TEST_CASE("test expression emotion history fade out", "[esp-brookesia][ai_framework][expression]")
+{
+    ExpressionEmotionHistory history;
+
+    // Used a long time ago, the overflow halves its count
+    for (int i = 0; i < static_cast<int>(ExpressionEmotionHistory::USE_COUNT_MAX) + 1; i++) {
+        history.use(0);
+    }
+    // Fewer uses than the old emotion, but more than its halved count
+    for (int i = 0; i < static_cast<int>(ExpressionEmotionHistory::USE_COUNT_MAX) / 2 + 1; i++) {
+        history.use(1);
+        history.use(2);
+    }
+    history.use(3);
+    TEST_ASSERT_TRUE((std::vector<int>{2, 1}) == history.predict(2));
+    TEST_ASSERT_TRUE((std::vector<int>{2, 1, 0}) == history.predict(3));
+}
+
+#endif // CONFIG_ESP_BROOKESIA_AI_FRAMEWORK_ENABLE_EXPRESSION
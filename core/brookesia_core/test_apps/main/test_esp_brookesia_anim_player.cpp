@@ -0,0 +1,813 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "sdkconfig.h"
+#if CONFIG_ESP_BROOKESIA_GUI_ENABLE_ANIM_PLAYER
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <thread>
+#include <vector>
+#include "esp_log.h"
+#include "esp_vfs_fat.h"
+#include "unity.h"
+#include "esp_brookesia.hpp"
+#include "gui/anim_player/esp_brookesia_anim_player.hpp"
+#include "gui/anim_player/esp_brookesia_anim_player_pixel.hpp"
+
+using namespace esp_brookesia::gui;
+
+#define TEST_ANIM_CANVAS_SIZE       (64)
+#define TEST_ANIM_FPS               (30)
+#define TEST_ANIM_SWITCH_NUM        (20)
+#define TEST_ANIM_SWITCH_PERIOD_MS  (200)
+// The interval of the polling waits before they were notification driven, a start should never take that long
+#define TEST_ANIM_MAX_START_LATENCY_MS  (100)
+// "icon_volume_up_64.aaf" has 90 frames, a switch without interrupt waits for the end of the whole loop
+#define TEST_ANIM_LOOP_TIME_MS      (90 * 1000 / TEST_ANIM_FPS)
+#define TEST_ANIM_NO_INTERRUPT_SWITCH_NUM   (3)
+#define TEST_ANIM_PLAYER_NUM        (2)
+#define TEST_ANIM_PLAY_TIME_MS      (2000)
+#define TEST_ANIM_BENCHMARK_FPS     (1000)
+#define TEST_ANIM_FLUSH_DELAY_MS    (10)
+#define TEST_ANIM_BLOCK_TIME_MS     (200)
+#define TEST_ANIM_PLAY_ONCE_TIMEOUT_MS  (10000)
+#define TEST_PIXEL_NUM              (284 * 126)
+#define TEST_PIXEL_LOOP_NUM         (20)
+#define TEST_FILE_BASE_PATH         "/test_fs"
+#define TEST_FILE_PARTITION_LABEL   "storage"
+#define TEST_FILE_WAIT_TIME_MS      (2000)
+
+extern const uint8_t test_anim_start[] asm("_binary_icon_volume_up_64_aaf_start");
+extern const uint8_t test_anim_end[] asm("_binary_icon_volume_up_64_aaf_end");
+extern const uint8_t test_emotion_start[] asm("_binary_emotion_happy_284_126_aaf_start");
+extern const uint8_t test_emotion_end[] asm("_binary_emotion_happy_284_126_aaf_end");
+
+static const char *TAG = "test_esp_brookesia_anim_player";
+
+using TestAnimFlushHook = std::function<void(int, int, int, int, const void *, AnimPlayer *)>;
+
+static AnimPlayerData test_anim_make_data(
+    const AnimPlayerResourcesConfig &source, int width = TEST_ANIM_CANVAS_SIZE, int height = TEST_ANIM_CANVAS_SIZE
+)
+{
+    return AnimPlayerData{
+        .canvas = {0, 0, width, height},
+        .source = source,
+        .task = {
+            .task_priority = 4,
+            .task_stack = 10 * 1024,
+            .task_affinity = 0,
+            .task_stack_in_ext = false,
+        },
+    };
+}
+
+/**
+ * Finish each rectangle after `flush_delay_ms`, `hook` sees the rectangle before that
+ */
+static boost::signals2::connection test_anim_connect_flush(int flush_delay_ms = 0, TestAnimFlushHook hook = nullptr)
+{
+    return AnimPlayer::flush_ready_signal.connect(
+    [flush_delay_ms, hook](int x_start, int y_start, int x_end, int y_end, const void *data, AnimPlayer * player) {
+        if (hook) {
+            hook(x_start, y_start, x_end, y_end, data, player);
+        }
+        if (flush_delay_ms > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(flush_delay_ms));
+        }
+        player->notifyFlushFinished();
+    });
+}
+
+/**
+ * Count the rectangles during whose flush the decoder went on with the next block
+ */
+static int test_anim_pipeline_overlap(int buffer_num)
+{
+    const AnimPlayerAnimAddress anim_address = {
+        test_anim_start, static_cast<size_t>(test_anim_end - test_anim_start), TEST_ANIM_BENCHMARK_FPS
+    };
+    auto data = test_anim_make_data({
+        .num = 1,
+        .resources = &anim_address,
+    });
+    data.pipeline.buffer_num = buffer_num;
+    std::atomic<int> overlap_count = 0;
+    auto connection = AnimPlayer::flush_ready_signal.connect(
+    [&overlap_count](int x_start, int y_start, int x_end, int y_end, const void *data, AnimPlayer * player) {
+        auto decoded_pixel_count = player->getFrameStats().decoded_pixel_count;
+        std::this_thread::sleep_for(std::chrono::milliseconds(TEST_ANIM_FLUSH_DELAY_MS));
+        if (player->getFrameStats().decoded_pixel_count != decoded_pixel_count) {
+            overlap_count++;
+        }
+        player->notifyFlushFinished();
+    });
+
+    AnimPlayer player;
+    TEST_ASSERT_TRUE(player.begin(data));
+    TEST_ASSERT_EQUAL(buffer_num > 0, player.isPipelineEnabled());
+    TEST_ASSERT_TRUE(player.sendEvent({0, AnimPlayer::Operation::PlayLoop, {true, true}}, false));
+    std::this_thread::sleep_for(std::chrono::milliseconds(TEST_ANIM_PLAY_TIME_MS));
+    TEST_ASSERT_TRUE(player.del());
+    connection.disconnect();
+
+    auto stats = player.getFrameStats();
+    ESP_LOGI(
+        TAG, "Buffers(%d): frames(%d), overlapped flushes(%d), stalls(%d), frame decode(%d us), flush(%d us)",
+        buffer_num, static_cast<int>(stats.frame_count), overlap_count.load(), static_cast<int>(stats.stall_count),
+        static_cast<int>(stats.last.decode_us), static_cast<int>(stats.last.flush_us)
+    );
+    TEST_ASSERT_NOT_EQUAL(0, stats.frame_count);
+    TEST_ASSERT_NOT_EQUAL(0, stats.last.decode_us);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(TEST_ANIM_FLUSH_DELAY_MS * 1000, stats.last.flush_us);
+
+    return overlap_count;
+}
+
+TEST_CASE("test anim player pipeline overlap", "[esp-brookesia][anim_player][pipeline]")
+{
+    // The decoder waits for each flush without a pipeline
+    TEST_ASSERT_EQUAL(0, test_anim_pipeline_overlap(0));
+    TEST_ASSERT_NOT_EQUAL(0, test_anim_pipeline_overlap(2));
+}
+
+static void test_anim_start_latency(bool enable_interrupt)
+{
+    const AnimPlayerAnimAddress anim_addresses[] = {
+        {test_anim_start, static_cast<size_t>(test_anim_end - test_anim_start), TEST_ANIM_FPS},
+        {test_anim_start, static_cast<size_t>(test_anim_end - test_anim_start), TEST_ANIM_FPS},
+    };
+    auto data = test_anim_make_data({
+        .num = 2,
+        .resources = anim_addresses,
+    });
+    auto connection = test_anim_connect_flush();
+
+    AnimPlayer player;
+    TEST_ASSERT_TRUE(player.begin(data));
+
+    // Each switch is given the time to start before the next one, so the switches are not queued
+    int switch_num = enable_interrupt ? TEST_ANIM_SWITCH_NUM : TEST_ANIM_NO_INTERRUPT_SWITCH_NUM;
+    int switch_period_ms = enable_interrupt ? TEST_ANIM_SWITCH_PERIOD_MS :
+                           (TEST_ANIM_LOOP_TIME_MS + TEST_ANIM_MAX_START_LATENCY_MS);
+    uint64_t total_latency_us = 0;
+    uint32_t max_latency_us = 0;
+    for (int i = 0; i < switch_num; i++) {
+        player.resetFrameStats();
+        TEST_ASSERT_TRUE(player.sendEvent({i % 2, AnimPlayer::Operation::PlayLoop, {enable_interrupt, true}}, false));
+        std::this_thread::sleep_for(std::chrono::milliseconds(switch_period_ms));
+
+        auto stats = player.getFrameStats();
+        TEST_ASSERT_NOT_EQUAL(0, stats.frame_count);
+        total_latency_us += stats.last_start_latency_us;
+        max_latency_us = std::max(max_latency_us, stats.max_start_latency_us);
+    }
+    auto stats = player.getFrameStats();
+    ESP_LOGI(
+        TAG, "Interrupt(%d): start latency avg(%d us), max(%d us), frame decode(%d us), flush(%d us)",
+        enable_interrupt, static_cast<int>(total_latency_us / switch_num),
+        static_cast<int>(max_latency_us), static_cast<int>(stats.last.decode_us),
+        static_cast<int>(stats.last.flush_us)
+    );
+    if (enable_interrupt) {
+        // The playing animation is stopped at once, the switch never takes as long as a poll
+        TEST_ASSERT_LESS_THAN_UINT32(TEST_ANIM_MAX_START_LATENCY_MS * 1000, max_latency_us);
+    } else {
+        // The switch waits for `PLAYER_EVENT_ALL_FRAME_DONE`, i.e. the end of the playing loop, not of a frame
+        TEST_ASSERT_LESS_THAN_UINT32((TEST_ANIM_LOOP_TIME_MS + TEST_ANIM_MAX_START_LATENCY_MS) * 1000, max_latency_us);
+    }
+
+    TEST_ASSERT_TRUE(player.del());
+    connection.disconnect();
+}
+
+TEST_CASE("test anim player start latency benchmark", "[esp-brookesia][anim_player][benchmark]")
+{
+    test_anim_start_latency(true);
+    test_anim_start_latency(false);
+}
+
+TEST_CASE("test anim player shared scheduler", "[esp-brookesia][anim_player][scheduler]")
+{
+    const AnimPlayerAnimAddress anim_address = {
+        test_anim_start, static_cast<size_t>(test_anim_end - test_anim_start), TEST_ANIM_FPS
+    };
+    auto data = test_anim_make_data({
+        .num = 1,
+        .resources = &anim_address,
+    });
+    data.pipeline.buffer_num = 2;
+    auto scheduler = std::make_shared<AnimPlayerScheduler>(AnimPlayerScheduler::Config{
+        .name = "test_anim",
+        .worker_num = 2,
+        .task_priority = 4,
+        .task_stack = 10 * 1024,
+        .task_stack_in_ext = false,
+        .task_affinity = -1,
+        .enable_pin_core = true,
+    });
+    TEST_ASSERT_TRUE(scheduler->begin());
+    auto connection = test_anim_connect_flush();
+
+    AnimPlayer players[TEST_ANIM_PLAYER_NUM];
+    for (auto &player : players) {
+        TEST_ASSERT_TRUE(player.begin(data, scheduler));
+        TEST_ASSERT_TRUE(player.sendEvent({0, AnimPlayer::Operation::PlayLoop, {true, true}}, false));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(TEST_ANIM_PLAY_TIME_MS));
+
+    for (int i = 0; i < TEST_ANIM_PLAYER_NUM; i++) {
+        AnimPlayerScheduler::PlayerStats scheduler_stats = {};
+        TEST_ASSERT_TRUE(scheduler->getPlayerStats(&players[i], scheduler_stats));
+        auto frame_stats = players[i].getFrameStats();
+        ESP_LOGI(
+            TAG, "Player(%d): frames(%d), runs(%d), deadline misses(%d), max lateness(%d us)", i,
+            static_cast<int>(frame_stats.frame_count), static_cast<int>(scheduler_stats.run_count),
+            static_cast<int>(scheduler_stats.deadline_miss_count), static_cast<int>(scheduler_stats.max_lateness_us)
+        );
+        TEST_ASSERT_NOT_EQUAL(0, frame_stats.frame_count);
+    }
+
+    for (auto &player : players) {
+        TEST_ASSERT_TRUE(player.del());
+    }
+    TEST_ASSERT_TRUE(scheduler->del());
+    connection.disconnect();
+}
+
+/**
+ * One worker is kept busy by the first flush of a low priority player, until the event of another player is sent
+ * after the next block of the low one is due. Returns if the other player ran before the next flush of the low one.
+ */
+static bool test_anim_scheduler_runs_before(int priority)
+{
+    const AnimPlayerAnimAddress anim_address = {
+        test_anim_start, static_cast<size_t>(test_anim_end - test_anim_start), TEST_ANIM_FPS
+    };
+    auto low_data = test_anim_make_data({
+        .num = 1,
+        .resources = &anim_address,
+    });
+    low_data.pipeline.buffer_num = 2;
+    auto data = low_data;
+    data.task.task_priority = priority;
+    auto scheduler = std::make_shared<AnimPlayerScheduler>(AnimPlayerScheduler::Config{
+        .name = "test_anim",
+        .worker_num = 1,
+        .task_priority = 4,
+        .task_stack = 10 * 1024,
+        .task_stack_in_ext = false,
+        .task_affinity = -1,
+        .enable_pin_core = false,
+    });
+    TEST_ASSERT_TRUE(scheduler->begin());
+
+    AnimPlayer low_player;
+    AnimPlayer player;
+    std::atomic<int> low_flush_count = 0;
+    std::atomic<bool> is_released = false;
+    std::atomic<int> run_count = -1;
+    auto connection = test_anim_connect_flush(0, [&](int, int, int, int, const void *, AnimPlayer * p) {
+        if (p != &low_player) {
+            return;
+        }
+        auto count = ++low_flush_count;
+        if (count == 1) {
+            while (!is_released) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        } else if (count == 2) {
+            AnimPlayerScheduler::PlayerStats stats = {};
+            scheduler->getPlayerStats(&player, stats);
+            run_count = stats.run_count;
+        }
+    });
+
+    TEST_ASSERT_TRUE(low_player.begin(low_data, scheduler));
+    TEST_ASSERT_TRUE(player.begin(data, scheduler));
+    TEST_ASSERT_TRUE(low_player.sendEvent({0, AnimPlayer::Operation::PlayLoop, {true, true}}, false));
+    while (low_flush_count == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // The next block of the low player is decoded and due one frame period later
+    std::this_thread::sleep_for(std::chrono::milliseconds(TEST_ANIM_BLOCK_TIME_MS));
+    TEST_ASSERT_TRUE(player.sendEvent({0, AnimPlayer::Operation::PlayLoop, {true, true}}, false));
+    is_released = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(TEST_ANIM_SWITCH_PERIOD_MS));
+
+    AnimPlayerScheduler::PlayerStats low_stats = {};
+    TEST_ASSERT_TRUE(scheduler->getPlayerStats(&low_player, low_stats));
+    TEST_ASSERT_TRUE(low_player.del());
+    TEST_ASSERT_TRUE(player.del());
+    TEST_ASSERT_TRUE(scheduler->del());
+    connection.disconnect();
+
+    ESP_LOGI(
+        TAG, "Priority(%d): runs before the low player(%d), low player deadline misses(%d), max lateness(%d us)",
+        priority, run_count.load(), static_cast<int>(low_stats.deadline_miss_count),
+        static_cast<int>(low_stats.max_lateness_us)
+    );
+    TEST_ASSERT_NOT_EQUAL(-1, run_count.load());
+    // The worker was blocked far beyond the deadline of the next block
+    TEST_ASSERT_NOT_EQUAL(0, low_stats.deadline_miss_count);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, low_stats.max_lateness_us);
+
+    return run_count > 0;
+}
+
+TEST_CASE("test anim player scheduler order", "[esp-brookesia][anim_player][scheduler]")
+{
+    // The same priority runs in the order of the deadlines, the low player was due before the event was sent
+    TEST_ASSERT_FALSE(test_anim_scheduler_runs_before(4));
+    // A higher priority runs first, even if it is due later
+    TEST_ASSERT_TRUE(test_anim_scheduler_runs_before(5));
+}
+
+/**
+ * Play the animation once and draw the flushed rectangles on `canvas`
+ */
+static AnimPlayer::FrameStats test_anim_play_once_canvas(
+    bool enable_delta, std::vector<uint16_t> &canvas, bool enable_swap = false, int buffer_num = 0
+)
+{
+    const AnimPlayerAnimAddress anim_address = {
+        test_anim_start, static_cast<size_t>(test_anim_end - test_anim_start), TEST_ANIM_BENCHMARK_FPS
+    };
+    auto data = test_anim_make_data({
+        .num = 1,
+        .resources = &anim_address,
+    });
+    data.delta = {
+        .enable = enable_delta,
+        .max_rect_num = 4,
+    };
+    data.pipeline.buffer_num = buffer_num;
+    data.flags.enable_data_swap_bytes = enable_swap;
+    // Checked on the test task, an assertion in the slot would unwind the decoder task
+    std::atomic<int> invalid_rect_count = 0;
+    canvas.assign(TEST_ANIM_CANVAS_SIZE * TEST_ANIM_CANVAS_SIZE, 0);
+    auto draw_rect = [&](int x_start, int y_start, int x_end, int y_end, const void *pixels, AnimPlayer * player) {
+        if ((x_start < 0) || (x_end > TEST_ANIM_CANVAS_SIZE) || (x_start >= x_end) ||
+                (y_start < 0) || (y_end > TEST_ANIM_CANVAS_SIZE) || (y_start >= y_end)) {
+            invalid_rect_count++;
+            return;
+        }
+        auto src = static_cast<const uint16_t *>(pixels);
+        for (int y = y_start; y < y_end; y++) {
+            memcpy(&canvas[y * TEST_ANIM_CANVAS_SIZE + x_start], src, (x_end - x_start) * sizeof(uint16_t));
+            src += x_end - x_start;
+        }
+    };
+    auto connection = test_anim_connect_flush(0, draw_rect);
+
+    AnimPlayer player;
+    AnimPlayer::EventFuture future;
+    TEST_ASSERT_TRUE(player.begin(data));
+    TEST_ASSERT_EQUAL(enable_delta, player.isDeltaEnabled());
+    TEST_ASSERT_TRUE(player.sendEvent({0, AnimPlayer::Operation::PlayOncePause, {true, true}}, false, &future));
+    TEST_ASSERT_TRUE(
+        future.wait_for(std::chrono::milliseconds(TEST_ANIM_PLAY_ONCE_TIMEOUT_MS)) == std::future_status::ready
+    );
+    // The decoder is done, but the last blocks may still be in the pipeline, wait until they are flushed
+    size_t frame_count = 0;
+    auto stats = player.getFrameStats();
+    do {
+        frame_count = stats.frame_count;
+        std::this_thread::sleep_for(std::chrono::milliseconds(TEST_ANIM_SWITCH_PERIOD_MS));
+        stats = player.getFrameStats();
+    } while (stats.frame_count != frame_count);
+    TEST_ASSERT_TRUE(player.del());
+    connection.disconnect();
+
+    TEST_ASSERT_EQUAL(0, invalid_rect_count.load());
+
+    return stats;
+}
+
+TEST_CASE("test anim player delta frames", "[esp-brookesia][anim_player][delta]")
+{
+    std::vector<uint16_t> full_canvas;
+    std::vector<uint16_t> delta_canvas;
+    auto full_stats = test_anim_play_once_canvas(false, full_canvas);
+    auto stats = test_anim_play_once_canvas(true, delta_canvas);
+    ESP_LOGI(
+        TAG, "Delta: frames(%d), decoded pixels(%d), flushed pixels(%d), skipped blocks(%d)",
+        static_cast<int>(stats.frame_count), static_cast<int>(stats.decoded_pixel_count),
+        static_cast<int>(stats.flushed_pixel_count), static_cast<int>(stats.skipped_block_count)
+    );
+
+    TEST_ASSERT_NOT_EQUAL(0, stats.frame_count);
+    TEST_ASSERT_EQUAL(full_stats.frame_count, stats.frame_count);
+    TEST_ASSERT_EQUAL(full_stats.flushed_pixel_count, full_stats.decoded_pixel_count);
+    TEST_ASSERT_TRUE(stats.flushed_pixel_count < stats.decoded_pixel_count);
+    // The rectangles cover every changed pixel, so the last frame is the same as with full frames
+    TEST_ASSERT_EQUAL_MEMORY(full_canvas.data(), delta_canvas.data(), full_canvas.size() * sizeof(uint16_t));
+}
+
+static void test_anim_decode_throughput(
+    const char *name, const uint8_t *start, const uint8_t *end, int width, int height
+)
+{
+    const AnimPlayerAnimAddress anim_address = {start, static_cast<size_t>(end - start), TEST_ANIM_BENCHMARK_FPS};
+    auto data = test_anim_make_data({
+        .num = 1,
+        .resources = &anim_address,
+    }, width, height);
+    // Nothing is drawn, so the frame rate is only limited by the decoder
+    auto connection = test_anim_connect_flush();
+
+    AnimPlayer player;
+    TEST_ASSERT_TRUE(player.begin(data));
+    TEST_ASSERT_TRUE(player.sendEvent({0, AnimPlayer::Operation::PlayLoop, {true, true}}, false));
+    std::this_thread::sleep_for(std::chrono::milliseconds(TEST_ANIM_PLAY_TIME_MS));
+
+    auto stats = player.getFrameStats();
+    TEST_ASSERT_NOT_EQUAL(0, stats.frame_count);
+    TEST_ASSERT_NOT_EQUAL(0, stats.total_decode_us);
+    // The AAF header starts with the number of frames
+    uint32_t frame_num = 0;
+    memcpy(&frame_num, start, sizeof(frame_num));
+    TEST_ASSERT_NOT_EQUAL(0, frame_num);
+    ESP_LOGI(
+        TAG, "%s: decode(%d fps), frame decode avg(%d us), max(%d us), bytes/frame(%d)", name,
+        static_cast<int>(stats.frame_count * 1000000ULL / stats.total_decode_us),
+        static_cast<int>(stats.total_decode_us / stats.frame_count), static_cast<int>(stats.max.decode_us),
+        static_cast<int>((end - start) / frame_num)
+    );
+    // The assets are played at up to this rate on the devices, so the decoder alone must keep up with it
+    TEST_ASSERT_GREATER_OR_EQUAL(TEST_ANIM_FPS, stats.frame_count * 1000000ULL / stats.total_decode_us);
+
+    TEST_ASSERT_TRUE(player.del());
+    connection.disconnect();
+}
+
+TEST_CASE("test anim player decode throughput benchmark", "[esp-brookesia][anim_player][benchmark]")
+{
+    test_anim_decode_throughput(
+        "icon_volume_up_64", test_anim_start, test_anim_end, TEST_ANIM_CANVAS_SIZE, TEST_ANIM_CANVAS_SIZE
+    );
+    test_anim_decode_throughput("emotion_happy_284_126", test_emotion_start, test_emotion_end, 284, 126);
+}
+
+static AnimPlayer::FrameStats test_anim_frame_drop(bool enable_frame_drop, int flush_delay_ms)
+{
+    const AnimPlayerAnimAddress anim_address = {
+        test_anim_start, static_cast<size_t>(test_anim_end - test_anim_start), TEST_ANIM_FPS
+    };
+    auto data = test_anim_make_data({
+        .num = 1,
+        .resources = &anim_address,
+    });
+    data.flags.enable_frame_drop = enable_frame_drop;
+    auto connection = test_anim_connect_flush(flush_delay_ms);
+
+    AnimPlayer player;
+    TEST_ASSERT_TRUE(player.begin(data));
+    TEST_ASSERT_TRUE(player.sendEvent({0, AnimPlayer::Operation::PlayLoop, {true, true}}, false));
+    std::this_thread::sleep_for(std::chrono::milliseconds(TEST_ANIM_PLAY_TIME_MS));
+    auto stats = player.getFrameStats();
+    TEST_ASSERT_TRUE(player.del());
+    connection.disconnect();
+
+    ESP_LOGI(
+        TAG, "Frame drop(%d), flush delay(%d ms): flushed(%d), dropped(%d), achieved fps(%.1f), jitter last(%d us), "
+        "max(%d us)", enable_frame_drop, flush_delay_ms, static_cast<int>(stats.frame_count),
+        static_cast<int>(stats.dropped_frame_count), stats.achieved_fps, static_cast<int>(stats.last_jitter_us),
+        static_cast<int>(stats.max_jitter_us)
+    );
+    TEST_ASSERT_NOT_EQUAL(0, stats.frame_count);
+
+    return stats;
+}
+
+TEST_CASE("test anim player frame drop", "[esp-brookesia][anim_player][pacing]")
+{
+    // Most of the slots of the play time, the first ones are taken by the start of the animation
+    size_t min_slot_num = TEST_ANIM_PLAY_TIME_MS * TEST_ANIM_FPS / 1000 * 8 / 10;
+    // Flush slower than the frame period, so some frames can not meet their slots
+    int slow_flush_ms = 2000 / TEST_ANIM_FPS;
+
+    // Nothing is dropped while the flush keeps up
+    auto stats = test_anim_frame_drop(true, 0);
+    TEST_ASSERT_EQUAL(0, stats.dropped_frame_count);
+    TEST_ASSERT_GREATER_OR_EQUAL(min_slot_num, stats.frame_count);
+
+    // Under load, the late frames are dropped and the animation stays on the wall clock
+    stats = test_anim_frame_drop(true, slow_flush_ms);
+    TEST_ASSERT_NOT_EQUAL(0, stats.dropped_frame_count);
+    TEST_ASSERT_GREATER_OR_EQUAL(min_slot_num, stats.frame_count + stats.dropped_frame_count);
+    TEST_ASSERT_TRUE(stats.achieved_fps < TEST_ANIM_FPS);
+
+    // Without dropping, the same load makes the animation run behind
+    stats = test_anim_frame_drop(false, slow_flush_ms);
+    TEST_ASSERT_EQUAL(0, stats.dropped_frame_count);
+    TEST_ASSERT_LESS_THAN(min_slot_num, stats.frame_count);
+}
+
+static wl_handle_t test_file_wl_handle = WL_INVALID_HANDLE;
+// FAT without long file names, so keep the names in 8.3
+static const char *test_file_paths[] = {
+    TEST_FILE_BASE_PATH "/anim_0.aaf",
+    TEST_FILE_BASE_PATH "/anim_1.aaf",
+    TEST_FILE_BASE_PATH "/anim_2.aaf",
+};
+
+static void test_file_write(const char *path, const uint8_t *start, const uint8_t *end)
+{
+    FILE *file = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_EQUAL(end - start, fwrite(start, 1, end - start, file));
+    TEST_ASSERT_EQUAL(0, fclose(file));
+}
+
+static void test_file_mount()
+{
+    esp_vfs_fat_mount_config_t mount_config = {
+        .format_if_mount_failed = true,
+        .max_files = 4,
+        .allocation_unit_size = CONFIG_WL_SECTOR_SIZE,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, esp_vfs_fat_spiflash_mount_rw_wl(
+                          TEST_FILE_BASE_PATH, TEST_FILE_PARTITION_LABEL, &mount_config, &test_file_wl_handle
+                      ));
+    // Two sizes, so the loaded size tells which of the files are in the cache
+    test_file_write(test_file_paths[0], test_anim_start, test_anim_end);
+    test_file_write(test_file_paths[1], test_emotion_start, test_emotion_end);
+    test_file_write(test_file_paths[2], test_anim_start, test_anim_end);
+}
+
+static void test_file_unmount()
+{
+    for (auto path : test_file_paths) {
+        remove(path);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_vfs_fat_spiflash_unmount_rw_wl(TEST_FILE_BASE_PATH, test_file_wl_handle));
+    test_file_wl_handle = WL_INVALID_HANDLE;
+}
+
+TEST_CASE("test anim player file source", "[esp-brookesia][anim_player][source]")
+{
+    test_file_mount();
+
+    {
+        AnimPlayerFileSource source(test_file_paths[1], false);
+        TEST_ASSERT_TRUE(source.open());
+        TEST_ASSERT_FALSE(source.isLoaded());
+        TEST_ASSERT_EQUAL(test_emotion_end - test_emotion_start, source.getSize());
+
+        // Larger than a chunk, so the file is read in several parts
+        TEST_ASSERT_TRUE(source.getSize() > AnimPlayerFileSource::READ_CHUNK_SIZE);
+        TEST_ASSERT_TRUE(source.load());
+        TEST_ASSERT_TRUE(source.isLoaded());
+        TEST_ASSERT_FALSE(source.isMapped());
+        TEST_ASSERT_EQUAL_MEMORY(test_emotion_start, source.getData(), source.getSize());
+
+        source.unload();
+        TEST_ASSERT_FALSE(source.isLoaded());
+        TEST_ASSERT_NULL(source.getData());
+        // Loaded again after an unload
+        TEST_ASSERT_TRUE(source.load());
+        TEST_ASSERT_EQUAL_MEMORY(test_emotion_start, source.getData(), source.getSize());
+    }
+    {
+        AnimPlayerFileSource source(TEST_FILE_BASE_PATH "/none.aaf", false);
+        TEST_ASSERT_FALSE(source.open());
+    }
+
+    test_file_unmount();
+}
+
+static void test_anim_play_file(AnimPlayer &player, int index)
+{
+    player.resetFrameStats();
+    TEST_ASSERT_TRUE(player.sendEvent({index, AnimPlayer::Operation::PlayLoop, {true, true}}, false));
+
+    auto start = std::chrono::steady_clock::now();
+    while (player.getFrameStats().frame_count == 0) {
+        TEST_ASSERT_TRUE(
+            std::chrono::steady_clock::now() - start < std::chrono::milliseconds(TEST_FILE_WAIT_TIME_MS)
+        );
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+TEST_CASE("test anim player file source cache", "[esp-brookesia][anim_player][source]")
+{
+    test_file_mount();
+
+    const AnimPlayerAnimPath anim_paths[] = {
+        {test_file_paths[0], TEST_ANIM_FPS},
+        {test_file_paths[1], TEST_ANIM_FPS},
+        {test_file_paths[2], TEST_ANIM_FPS},
+    };
+    auto data = test_anim_make_data({
+        .num = 3,
+        .resources = anim_paths,
+        .cache_num = 2,
+        .enable_mmap = false,
+    }, 284, 126);
+    auto connection = test_anim_connect_flush();
+    size_t small_size = test_anim_end - test_anim_start;
+    size_t large_size = test_emotion_end - test_emotion_start;
+
+    AnimPlayer player;
+    TEST_ASSERT_TRUE(player.begin(data));
+    // Nothing is loaded before it is played
+    TEST_ASSERT_EQUAL(0, player.getLoadedSourceSize());
+
+    test_anim_play_file(player, 0);
+    TEST_ASSERT_EQUAL(small_size, player.getLoadedSourceSize());
+    test_anim_play_file(player, 1);
+    TEST_ASSERT_EQUAL(small_size + large_size, player.getLoadedSourceSize());
+    // The cache is full, the least recently used file 0 is evicted instead of file 1
+    test_anim_play_file(player, 2);
+    TEST_ASSERT_EQUAL(small_size + large_size, player.getLoadedSourceSize());
+    // A hit makes file 1 the most recently used, so file 2 is evicted next
+    test_anim_play_file(player, 1);
+    TEST_ASSERT_EQUAL(small_size + large_size, player.getLoadedSourceSize());
+    test_anim_play_file(player, 0);
+    TEST_ASSERT_EQUAL(small_size + large_size, player.getLoadedSourceSize());
+    test_anim_play_file(player, 2);
+    // File 1 was evicted, since file 0 was used after it
+    TEST_ASSERT_EQUAL(small_size * 2, player.getLoadedSourceSize());
+
+    TEST_ASSERT_TRUE(player.del());
+    connection.disconnect();
+
+    test_file_unmount();
+}
+
+TEST_CASE("test anim player file source preload", "[esp-brookesia][anim_player][source]")
+{
+    test_file_mount();
+
+    const AnimPlayerAnimPath anim_paths[] = {
+        {test_file_paths[0], TEST_ANIM_FPS},
+        {test_file_paths[1], TEST_ANIM_FPS},
+        {test_file_paths[2], TEST_ANIM_FPS},
+    };
+    auto data = test_anim_make_data({
+        .num = 3,
+        .resources = anim_paths,
+        .cache_num = 3,
+        .enable_mmap = false,
+    }, 284, 126);
+    auto connection = test_anim_connect_flush();
+    size_t small_size = test_anim_end - test_anim_start;
+    size_t large_size = test_emotion_end - test_emotion_start;
+
+    AnimPlayer player;
+    TEST_ASSERT_TRUE(player.begin(data));
+
+    test_anim_play_file(player, 0);
+    TEST_ASSERT_TRUE(player.preloadAnimation(1));
+    auto start = std::chrono::steady_clock::now();
+    while (player.getLoadedSourceSize() != small_size + large_size) {
+        TEST_ASSERT_TRUE(
+            std::chrono::steady_clock::now() - start < std::chrono::milliseconds(TEST_FILE_WAIT_TIME_MS)
+        );
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // The files are reopened by path when they are loaded, so file 1 can only be played from the cache now
+    TEST_ASSERT_EQUAL(0, remove(test_file_paths[1]));
+    test_anim_play_file(player, 1);
+    TEST_ASSERT_EQUAL(small_size + large_size, player.getLoadedSourceSize());
+
+    TEST_ASSERT_TRUE(player.del());
+    connection.disconnect();
+
+    test_file_unmount();
+}
+
+template <typename Func>
+static uint32_t test_pixel_kernel_time_us(Func &&func)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < TEST_PIXEL_LOOP_NUM; i++) {
+        func();
+    }
+    auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    return static_cast<uint32_t>(time_us.count() / TEST_PIXEL_LOOP_NUM);
+}
+
+TEST_CASE("test anim player pixel kernels benchmark", "[esp-brookesia][anim_player][benchmark]")
+{
+    std::vector<uint16_t> src(TEST_PIXEL_NUM);
+    std::vector<uint16_t> dst(TEST_PIXEL_NUM);
+    std::vector<uint16_t> expected(TEST_PIXEL_NUM);
+    for (int i = 0; i < TEST_PIXEL_NUM; i++) {
+        src[i] = static_cast<uint16_t>(i * 2654435761U);
+    }
+
+    auto ref_us = test_pixel_kernel_time_us([&]() {
+        for (int i = 0; i < TEST_PIXEL_NUM; i++) {
+            expected[i] = static_cast<uint16_t>((src[i] << 8) | (src[i] >> 8));
+        }
+    });
+    auto kernel_us = test_pixel_kernel_time_us([&]() {
+        AnimPlayerPixel::swapRGB565(dst.data(), src.data(), TEST_PIXEL_NUM);
+    });
+    TEST_ASSERT_EQUAL_MEMORY(expected.data(), dst.data(), TEST_PIXEL_NUM * sizeof(uint16_t));
+    ESP_LOGI(
+        TAG, "Swap RGB565: reference(%d us), kernel(%d us)", static_cast<int>(ref_us), static_cast<int>(kernel_us)
+    );
+
+    // In place and from an unaligned pixel with an odd number of pixels, as on the flush path
+    dst = src;
+    AnimPlayerPixel::swapRGB565(dst.data() + 1, dst.data() + 1, TEST_PIXEL_NUM - 3);
+    TEST_ASSERT_EQUAL_UINT16(src[0], dst[0]);
+    TEST_ASSERT_EQUAL_MEMORY(expected.data() + 1, dst.data() + 1, (TEST_PIXEL_NUM - 3) * sizeof(uint16_t));
+    TEST_ASSERT_EQUAL_MEMORY(src.data() + TEST_PIXEL_NUM - 2, dst.data() + TEST_PIXEL_NUM - 2, 2 * sizeof(uint16_t));
+
+    // RGB888 to RGB565, with and without the swap
+    std::vector<uint8_t> src_rgb888(TEST_PIXEL_NUM * 3);
+    for (int i = 0; i < TEST_PIXEL_NUM * 3; i++) {
+        src_rgb888[i] = static_cast<uint8_t>(i * 2654435761U >> 24);
+    }
+    for (bool swap : {false, true}) {
+        ref_us = test_pixel_kernel_time_us([&]() {
+            for (int i = 0; i < TEST_PIXEL_NUM; i++) {
+                const uint8_t *pixel = &src_rgb888[i * 3];
+                auto color = static_cast<uint16_t>(
+                    ((pixel[2] & 0xF8) << 8) | ((pixel[1] & 0xFC) << 3) | (pixel[0] >> 3)
+                );
+                expected[i] = swap ? static_cast<uint16_t>((color << 8) | (color >> 8)) : color;
+            }
+        });
+        kernel_us = test_pixel_kernel_time_us([&]() {
+            AnimPlayerPixel::convertRGB888ToRGB565(dst.data(), src_rgb888.data(), TEST_PIXEL_NUM, swap);
+        });
+        TEST_ASSERT_EQUAL_MEMORY(expected.data(), dst.data(), TEST_PIXEL_NUM * sizeof(uint16_t));
+        ESP_LOGI(
+            TAG, "Convert RGB888 to RGB565 (swap: %d): reference(%d us), kernel(%d us)", swap, static_cast<int>(ref_us),
+            static_cast<int>(kernel_us)
+        );
+    }
+    // Into an unaligned destination with an odd number of pixels
+    dst.assign(TEST_PIXEL_NUM, 0);
+    AnimPlayerPixel::convertRGB888ToRGB565(dst.data() + 1, src_rgb888.data() + 3, TEST_PIXEL_NUM - 2, true);
+    TEST_ASSERT_EQUAL_UINT16(0, dst[0]);
+    TEST_ASSERT_EQUAL_MEMORY(expected.data() + 1, dst.data() + 1, (TEST_PIXEL_NUM - 2) * sizeof(uint16_t));
+    TEST_ASSERT_EQUAL_UINT16(0, dst[TEST_PIXEL_NUM - 1]);
+
+    // Blend, the reference works per channel with the same 5-bit opacity as the kernel, so they match exactly
+    std::vector<uint8_t> alpha(TEST_PIXEL_NUM);
+    for (int i = 0; i < TEST_PIXEL_NUM; i++) {
+        alpha[i] = static_cast<uint8_t>(i * 7);
+    }
+    const uint16_t bg_color = 0x1234;
+    auto blend_channel = [](uint32_t fg, uint32_t bg, uint32_t a) {
+        return (fg * a + bg * (32 - a)) >> 5;
+    };
+    ref_us = test_pixel_kernel_time_us([&]() {
+        for (int i = 0; i < TEST_PIXEL_NUM; i++) {
+            uint32_t a = (alpha[i] + 4) >> 3;
+            uint32_t r = blend_channel((src[i] >> 11) & 0x1F, (bg_color >> 11) & 0x1F, a);
+            uint32_t g = blend_channel((src[i] >> 5) & 0x3F, (bg_color >> 5) & 0x3F, a);
+            uint32_t b = blend_channel(src[i] & 0x1F, bg_color & 0x1F, a);
+            expected[i] = static_cast<uint16_t>((r << 11) | (g << 5) | b);
+        }
+    });
+    kernel_us = test_pixel_kernel_time_us([&]() {
+        AnimPlayerPixel::blendRGB565(dst.data(), src.data(), alpha.data(), TEST_PIXEL_NUM, bg_color, false);
+    });
+    TEST_ASSERT_EQUAL_MEMORY(expected.data(), dst.data(), TEST_PIXEL_NUM * sizeof(uint16_t));
+    ESP_LOGI(
+        TAG, "Blend RGB565: reference(%d us), kernel(%d us)", static_cast<int>(ref_us), static_cast<int>(kernel_us)
+    );
+    // Swapped pixels and background give the swapped result
+    std::vector<uint16_t> swapped_src(TEST_PIXEL_NUM);
+    AnimPlayerPixel::swapRGB565(swapped_src.data(), src.data(), TEST_PIXEL_NUM);
+    AnimPlayerPixel::blendRGB565(
+        dst.data(), swapped_src.data(), alpha.data(), TEST_PIXEL_NUM,
+        static_cast<uint16_t>((bg_color << 8) | (bg_color >> 8)), true
+    );
+    AnimPlayerPixel::swapRGB565(dst.data(), dst.data(), TEST_PIXEL_NUM);
+    TEST_ASSERT_EQUAL_MEMORY(expected.data(), dst.data(), TEST_PIXEL_NUM * sizeof(uint16_t));
+}
+
+TEST_CASE("test anim player swap bytes", "[esp-brookesia][anim_player][pixel]")
+{
+    std::vector<uint16_t> canvas;
+    std::vector<uint16_t> swapped_canvas;
+    test_anim_play_once_canvas(false, canvas);
+    for (auto &pixel : canvas) {
+        pixel = static_cast<uint16_t>((pixel << 8) | (pixel >> 8));
+    }
+
+    // Swapped in the decoder buffer without a pipeline, and while copying into the buffers of the pipeline
+    test_anim_play_once_canvas(false, swapped_canvas, true);
+    TEST_ASSERT_EQUAL_MEMORY(canvas.data(), swapped_canvas.data(), canvas.size() * sizeof(uint16_t));
+    test_anim_play_once_canvas(false, swapped_canvas, true, 2);
+    TEST_ASSERT_EQUAL_MEMORY(canvas.data(), swapped_canvas.data(), canvas.size() * sizeof(uint16_t));
+}
+#endif // CONFIG_ESP_BROOKESIA_GUI_ENABLE_ANIM_PLAYER
@@ -0,0 +1,287 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "unity.h"
+#include "esp_brookesia.hpp"
+#include "gui/lvgl/esp_brookesia_lv_lock.hpp"
+#include "systems/base/esp_brookesia_base_boot_sequence.hpp"
+
+using namespace esp_brookesia::gui;
+using namespace esp_brookesia::systems::base;
+
+#define TEST_BOOT_LONG_TIME_MS      (100)
+#define TEST_BOOT_SHORT_TIME_MS     (30)
+#define TEST_BOOT_CALLER_TIME_MS    (40)
+#define TEST_BOOT_FAIL_TIME_MS      (10)
+#define TEST_BOOT_LOCK_TIMEOUT_MS   (10)
+
+using Runner = BootSequence::Runner;
+
+// Stands in for the display lock of the BSP
+static std::recursive_timed_mutex test_boot_lock_mutex;
+
+// What a stage sees in its thread. Unity can not assert in other threads, the results are checked after `run()`
+struct TestBootStageRecord {
+    std::thread::id thread_id;
+    bool is_forbidden;
+    bool is_try_locked;
+    bool is_locked;
+};
+
+static void test_boot_register_lock_callbacks()
+{
+    LvLock::registerCallbacks([](int timeout_ms) {
+        if (timeout_ms < 0) {
+            test_boot_lock_mutex.lock();
+            return true;
+        }
+        return test_boot_lock_mutex.try_lock_for(std::chrono::milliseconds(timeout_ms));
+    }, []() {
+        test_boot_lock_mutex.unlock();
+        return true;
+    });
+}
+
+static BootSequence::Function test_boot_stage(TestBootStageRecord &record, int time_ms, bool ret = true)
+{
+    return [&record, time_ms, ret]() {
+        auto &lock = LvLock::getInstance();
+        record.thread_id = std::this_thread::get_id();
+        record.is_forbidden = LvLockForbidGuard::checkForbidden();
+        record.is_try_locked = lock.tryLock();
+        if (record.is_try_locked) {
+            lock.unlock();
+        }
+        record.is_locked = lock.lock(TEST_BOOT_LOCK_TIMEOUT_MS);
+        if (record.is_locked) {
+            lock.unlock();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(time_ms));
+        return ret;
+    };
+}
+
+static const BootSequence::StageInfo &test_boot_find_info(const BootSequence &sequence, const char *name)
+{
+    auto &timeline = sequence.getTimeline();
+    auto it = std::find_if(timeline.begin(), timeline.end(), [name](const auto &info) {
+        return info.name == name;
+    });
+    TEST_ASSERT_TRUE(it != timeline.end());
+    return *it;
+}
+
+TEST_CASE("test boot sequence add stage", "[esp-brookesia][systems][boot_sequence]")
+{
+    BootSequence sequence;
+
+    TEST_ASSERT_TRUE(sequence.addStage("a", Runner::CALLER, []() {
+        return true;
+    }));
+    TEST_ASSERT_TRUE(sequence.checkStageExist("a"));
+    TEST_ASSERT_FALSE(sequence.checkStageExist("b"));
+    // Duplicate name, missing function, and a dependency which is not added before
+    TEST_ASSERT_FALSE(sequence.addStage("a", Runner::WORKER, []() {
+        return true;
+    }));
+    TEST_ASSERT_FALSE(sequence.addStage("b", Runner::CALLER, nullptr));
+    TEST_ASSERT_FALSE(sequence.addStage("b", Runner::WORKER, []() {
+        return true;
+    }, {"a", "c"}));
+    TEST_ASSERT_FALSE(sequence.checkStageExist("b"));
+    TEST_ASSERT_EQUAL(1, sequence.getTimeline().size());
+
+    TEST_ASSERT_TRUE(sequence.run());
+}
+
+TEST_CASE("test boot sequence order and runner", "[esp-brookesia][systems][boot_sequence]")
+{
+    test_boot_register_lock_callbacks();
+
+    //            +-> w_long  -+
+    //  init -----+-> w_short -+-> final
+    //            +-> c_mid   -+
+    BootSequence sequence;
+    std::vector<TestBootStageRecord> records(5);
+    TEST_ASSERT_TRUE(sequence.addStage("init", Runner::CALLER, test_boot_stage(records[0], 0)));
+    TEST_ASSERT_TRUE(
+        sequence.addStage("w_long", Runner::WORKER, test_boot_stage(records[1], TEST_BOOT_LONG_TIME_MS), {"init"})
+    );
+    TEST_ASSERT_TRUE(
+        sequence.addStage("w_short", Runner::WORKER, test_boot_stage(records[2], TEST_BOOT_SHORT_TIME_MS), {"init"})
+    );
+    TEST_ASSERT_TRUE(
+        sequence.addStage("c_mid", Runner::CALLER, test_boot_stage(records[3], TEST_BOOT_CALLER_TIME_MS), {"init"})
+    );
+    TEST_ASSERT_TRUE(sequence.addStage(
+                         "final", Runner::CALLER, test_boot_stage(records[4], 0), {"w_long", "w_short", "c_mid"}
+                     ));
+
+    // The caller holds the lock while it runs the sequence, as a system does
+    {
+        LvLockGuard gui_guard;
+        TEST_ASSERT_TRUE(sequence.run());
+    }
+    sequence.dumpTimeline();
+
+    auto &timeline = sequence.getTimeline();
+    auto caller_id = std::this_thread::get_id();
+    for (size_t i = 0; i < timeline.size(); i++) {
+        auto &info = timeline[i];
+        TEST_ASSERT_TRUE(info.is_done);
+        TEST_ASSERT_FALSE(info.is_failed);
+        TEST_ASSERT_TRUE(info.end_time_us >= info.start_time_us);
+        TEST_ASSERT_TRUE(info.start_time_us >= info.ready_time_us);
+        // The stages on the caller can use LVGL, the ones on the workers can not even take the lock
+        if (info.runner == Runner::CALLER) {
+            TEST_ASSERT_TRUE(records[i].thread_id == caller_id);
+            TEST_ASSERT_FALSE(records[i].is_forbidden);
+            TEST_ASSERT_TRUE(records[i].is_try_locked);
+            TEST_ASSERT_TRUE(records[i].is_locked);
+        } else {
+            TEST_ASSERT_TRUE(records[i].thread_id != caller_id);
+            TEST_ASSERT_TRUE(records[i].is_forbidden);
+            TEST_ASSERT_FALSE(records[i].is_try_locked);
+            TEST_ASSERT_FALSE(records[i].is_locked);
+        }
+    }
+    TEST_ASSERT_FALSE(LvLockForbidGuard::checkForbidden());
+    TEST_ASSERT_TRUE(records[1].thread_id != records[2].thread_id);
+
+    // Each stage starts after all its dependencies are done
+    auto &init = test_boot_find_info(sequence, "init");
+    auto &w_long = test_boot_find_info(sequence, "w_long");
+    auto &w_short = test_boot_find_info(sequence, "w_short");
+    auto &c_mid = test_boot_find_info(sequence, "c_mid");
+    auto &final = test_boot_find_info(sequence, "final");
+    TEST_ASSERT_TRUE(w_long.start_time_us >= init.end_time_us);
+    TEST_ASSERT_TRUE(w_short.start_time_us >= init.end_time_us);
+    TEST_ASSERT_TRUE(c_mid.start_time_us >= init.end_time_us);
+    TEST_ASSERT_TRUE(final.start_time_us >= w_long.end_time_us);
+    TEST_ASSERT_TRUE(final.start_time_us >= w_short.end_time_us);
+    TEST_ASSERT_TRUE(final.start_time_us >= c_mid.end_time_us);
+
+    // The independent stages overlap, so the total time is the longest branch instead of the sum
+    TEST_ASSERT_TRUE(w_short.start_time_us < w_long.end_time_us);
+    TEST_ASSERT_TRUE(c_mid.start_time_us < w_long.end_time_us);
+    TEST_ASSERT_TRUE(sequence.getTotalTimeUs() >= TEST_BOOT_LONG_TIME_MS * 1000);
+    TEST_ASSERT_TRUE(sequence.getTotalTimeUs() < (TEST_BOOT_LONG_TIME_MS + TEST_BOOT_SHORT_TIME_MS) * 1000);
+
+    // The longest branch decides the total time
+    TEST_ASSERT_TRUE((std::vector<size_t> {0, 1, 4}) == sequence.getCriticalPath());
+    TEST_ASSERT_TRUE(init.is_critical);
+    TEST_ASSERT_TRUE(w_long.is_critical);
+    TEST_ASSERT_FALSE(w_short.is_critical);
+    TEST_ASSERT_FALSE(c_mid.is_critical);
+    TEST_ASSERT_TRUE(final.is_critical);
+
+    LvLock::registerCallbacks(nullptr, nullptr);
+}
+
+TEST_CASE("test boot sequence caller critical path", "[esp-brookesia][systems][boot_sequence]")
+{
+    test_boot_register_lock_callbacks();
+
+    // Both stages on the caller are ready at once, the second one waits for the first instead of a dependency
+    BootSequence sequence;
+    std::vector<TestBootStageRecord> records(3);
+    TEST_ASSERT_TRUE(
+        sequence.addStage("c_first", Runner::CALLER, test_boot_stage(records[0], TEST_BOOT_SHORT_TIME_MS))
+    );
+    TEST_ASSERT_TRUE(
+        sequence.addStage("c_second", Runner::CALLER, test_boot_stage(records[1], TEST_BOOT_SHORT_TIME_MS))
+    );
+    TEST_ASSERT_TRUE(sequence.addStage("w_short", Runner::WORKER, test_boot_stage(records[2], TEST_BOOT_FAIL_TIME_MS)));
+    TEST_ASSERT_TRUE(sequence.run());
+
+    auto &c_first = test_boot_find_info(sequence, "c_first");
+    auto &c_second = test_boot_find_info(sequence, "c_second");
+    TEST_ASSERT_TRUE(c_second.start_time_us >= c_first.end_time_us);
+    TEST_ASSERT_TRUE(c_second.ready_time_us < c_first.end_time_us);
+    TEST_ASSERT_TRUE((std::vector<size_t> {0, 1}) == sequence.getCriticalPath());
+    TEST_ASSERT_FALSE(test_boot_find_info(sequence, "w_short").is_critical);
+
+    LvLock::registerCallbacks(nullptr, nullptr);
+}
+
+TEST_CASE("test boot sequence failure", "[esp-brookesia][systems][boot_sequence]")
+{
+    test_boot_register_lock_callbacks();
+
+    //         +-> w_slow -> w_after_slow
+    //  init --+
+    //         +-> w_fail -> c_after_fail
+    BootSequence sequence;
+    std::vector<TestBootStageRecord> records(5);
+    std::atomic<bool> is_slow_finished = false;
+    std::vector<std::string> cleanup_order;
+    std::vector<std::thread::id> cleanup_thread_ids;
+    auto cleanup = [&](const char *name) -> BootSequence::Function {
+        return [&, name]() {
+            cleanup_order.push_back(name);
+            cleanup_thread_ids.push_back(std::this_thread::get_id());
+            return true;
+        };
+    };
+    auto slow_stage = test_boot_stage(records[1], TEST_BOOT_LONG_TIME_MS);
+    TEST_ASSERT_TRUE(sequence.addStage("init", Runner::CALLER, test_boot_stage(records[0], 0), {}, cleanup("init")));
+    TEST_ASSERT_TRUE(sequence.addStage("w_slow", Runner::WORKER, [&]() {
+        bool ret = slow_stage();
+        is_slow_finished = true;
+        return ret;
+    }, {"init"}, cleanup("w_slow")));
+    TEST_ASSERT_TRUE(sequence.addStage(
+                         "w_fail", Runner::WORKER, test_boot_stage(records[2], TEST_BOOT_FAIL_TIME_MS, false), {"init"},
+                         cleanup("w_fail")
+                     ));
+    TEST_ASSERT_TRUE(sequence.addStage(
+                         "w_after_slow", Runner::WORKER, test_boot_stage(records[3], 0), {"w_slow"},
+                         cleanup("w_after_slow")
+                     ));
+    TEST_ASSERT_TRUE(sequence.addStage(
+                         "c_after_fail", Runner::CALLER, test_boot_stage(records[4], 0), {"w_fail"},
+                         cleanup("c_after_fail")
+                     ));
+
+    {
+        LvLockGuard gui_guard;
+        TEST_ASSERT_FALSE(sequence.run());
+    }
+    sequence.dumpTimeline();
+
+    // The running stage is waited before `run()` returns
+    TEST_ASSERT_TRUE(is_slow_finished);
+    auto &w_slow = test_boot_find_info(sequence, "w_slow");
+    TEST_ASSERT_TRUE(w_slow.is_done);
+    TEST_ASSERT_TRUE(w_slow.end_time_us <= sequence.getTotalTimeUs());
+    auto &w_fail = test_boot_find_info(sequence, "w_fail");
+    TEST_ASSERT_TRUE(w_fail.is_failed);
+    TEST_ASSERT_FALSE(w_fail.is_done);
+
+    // No more stages are started after the failure, even if their dependencies are done
+    for (auto name : {"w_after_slow", "c_after_fail"}) {
+        auto &info = test_boot_find_info(sequence, name);
+        TEST_ASSERT_FALSE(info.is_done);
+        TEST_ASSERT_FALSE(info.is_failed);
+        TEST_ASSERT_EQUAL(0, info.start_time_us);
+    }
+    TEST_ASSERT_TRUE(records[3].thread_id == std::thread::id());
+    TEST_ASSERT_TRUE(records[4].thread_id == std::thread::id());
+
+    // Only the started stages are cleaned up, on the caller, in the reverse order of their starts
+    TEST_ASSERT_TRUE((std::vector<std::string> {"w_fail", "w_slow", "init"}) == cleanup_order);
+    for (auto &thread_id : cleanup_thread_ids) {
+        TEST_ASSERT_TRUE(thread_id == std::this_thread::get_id());
+    }
+
+    LvLock::registerCallbacks(nullptr, nullptr);
+}
@@ -0,0 +1,291 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "unity.h"
+#include "esp_brookesia.hpp"
+
+using namespace esp_brookesia;
+using namespace esp_brookesia::systems::base;
+
+#define TEST_EVENT_OBJECT_NUM           (64)
+#define TEST_EVENT_ID_NUM_PER_OBJECT    (4)
+#define TEST_EVENT_HANDLER_NUM_PER_ID   (2)
+#define TEST_EVENT_DISPATCH_ROUNDS      (200)
+#define TEST_EVENT_POST_THREAD_NUM      (4)
+#define TEST_EVENT_POST_NUM_PER_THREAD  (8)
+
+static const char *TAG = "test_esp_brookesia_event";
+
+/**
+ * Count the heap allocations of the benchmark task through the heap hooks (`CONFIG_HEAP_USE_HOOKS`), the other tasks
+ * and the other test cases are not affected
+ */
+static std::atomic<TaskHandle_t> test_alloc_task = nullptr;
+static std::atomic<size_t> test_alloc_count = 0;
+
+#if CONFIG_HEAP_USE_HOOKS
+extern "C" IRAM_ATTR void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    if ((test_alloc_task != nullptr) && (test_alloc_task == xTaskGetCurrentTaskHandle())) {
+        test_alloc_count++;
+    }
+}
+
+extern "C" IRAM_ATTR void esp_heap_trace_free_hook(void *ptr)
+{
+}
+#endif
+
+/**
+ * The dispatch structure used before the flat table, kept here as the baseline of the benchmark. It iterates over a
+ * copy of the handler list, which is how the nested maps stay valid when a handler registers or unregisters events
+ */
+class TestLegacyEvent {
+public:
+    bool registerEvent(void *object, Event::Handler handler, Event::ID id, void *user_data = nullptr)
+    {
+        _event_handlers[object][id].emplace_back(handler, user_data);
+        return true;
+    }
+
+    bool sendEvent(void *object, Event::ID id, void *param = nullptr) const
+    {
+        auto object_it = _event_handlers.find(object);
+        if (object_it == _event_handlers.end()) {
+            return true;
+        }
+        auto handler_it = object_it->second.find(id);
+        if (handler_it == object_it->second.end()) {
+            return true;
+        }
+
+        bool ret = true;
+        HandlerList handlers = handler_it->second;
+        for (auto &handler_data_pair : handlers) {
+            Event::HandlerData data = {id, object, param, handler_data_pair.second};
+            ret = handler_data_pair.first(data) && ret;
+        }
+        return ret;
+    }
+
+private:
+    using HandlerList = std::vector<std::pair<Event::Handler, void *>>;
+
+    std::unordered_map<void *, std::unordered_map<Event::ID, HandlerList>> _event_handlers;
+};
+
+struct TestEventResult {
+    int64_t elapsed_us;
+    size_t alloc_count;
+    size_t handled_count;
+};
+
+static size_t test_handled_count = 0;
+
+static bool test_event_handler(const Event::HandlerData &data)
+{
+    test_handled_count++;
+    return true;
+}
+
+template <typename EventType>
+static TestEventResult test_event_benchmark(EventType &event, std::vector<int> &objects, std::vector<Event::ID> &ids)
+{
+    for (auto &object : objects) {
+        for (auto &id : ids) {
+            for (int i = 0; i < TEST_EVENT_HANDLER_NUM_PER_ID; i++) {
+                TEST_ASSERT_TRUE(event.registerEvent(&object, test_event_handler, id));
+            }
+        }
+    }
+
+    test_handled_count = 0;
+    test_alloc_count = 0;
+    test_alloc_task = xTaskGetCurrentTaskHandle();
+    int64_t start_us = esp_timer_get_time();
+    for (int round = 0; round < TEST_EVENT_DISPATCH_ROUNDS; round++) {
+        for (auto &object : objects) {
+            for (auto &id : ids) {
+                event.sendEvent(&object, id);
+            }
+        }
+    }
+
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    test_alloc_task = nullptr;
+
+    return {
+        .elapsed_us = elapsed_us,
+        .alloc_count = test_alloc_count,
+        .handled_count = test_handled_count,
+    };
+}
+
+TEST_CASE("test event dispatch benchmark", "[esp-brookesia][event][benchmark]")
+{
+    std::vector<int> objects(TEST_EVENT_OBJECT_NUM);
+    std::vector<Event::ID> ids;
+    TestEventResult legacy_result = {};
+    TestEventResult flat_result = {};
+    size_t dispatch_count = TEST_EVENT_OBJECT_NUM * TEST_EVENT_ID_NUM_PER_OBJECT * TEST_EVENT_DISPATCH_ROUNDS;
+
+    {
+        Event id_allocator;
+        for (int i = 0; i < TEST_EVENT_ID_NUM_PER_OBJECT; i++) {
+            ids.push_back(id_allocator.getFreeEventID());
+        }
+    }
+
+    {
+        TestLegacyEvent legacy_event;
+        legacy_result = test_event_benchmark(legacy_event, objects, ids);
+    }
+    {
+        Event flat_event;
+        flat_result = test_event_benchmark(flat_event, objects, ids);
+    }
+
+    ESP_LOGI(TAG, "Dispatch %d events, %d handlers per event", static_cast<int>(dispatch_count),
+             TEST_EVENT_HANDLER_NUM_PER_ID);
+    ESP_LOGI(TAG, "Legacy: %d us, %.3f us/event, %.3f allocs/event", static_cast<int>(legacy_result.elapsed_us),
+             static_cast<float>(legacy_result.elapsed_us) / dispatch_count,
+             static_cast<float>(legacy_result.alloc_count) / dispatch_count);
+    ESP_LOGI(TAG, "Flat  : %d us, %.3f us/event, %.3f allocs/event", static_cast<int>(flat_result.elapsed_us),
+             static_cast<float>(flat_result.elapsed_us) / dispatch_count,
+             static_cast<float>(flat_result.alloc_count) / dispatch_count);
+
+    TEST_ASSERT_EQUAL(legacy_result.handled_count, flat_result.handled_count);
+#if CONFIG_HEAP_USE_HOOKS
+    TEST_ASSERT_GREATER_OR_EQUAL(dispatch_count, legacy_result.alloc_count);
+    TEST_ASSERT_EQUAL(0, flat_result.alloc_count);
+#else
+    ESP_LOGW(TAG, "Enable `CONFIG_HEAP_USE_HOOKS` to count the allocations");
+#endif
+}
+
+static Event *test_reentrant_event = nullptr;
+static int test_reentrant_object_a = 0;
+static int test_reentrant_object_b = 0;
+
+static bool test_reentrant_event_handler(const Event::HandlerData &data)
+{
+    test_reentrant_event->unregisterEvent(data.object);
+
+    return test_reentrant_event->registerEvent(&test_reentrant_object_b, test_event_handler, Event::ID::CUSTOM);
+}
+
+TEST_CASE("test event register and unregister while dispatching", "[esp-brookesia][event][reentrant]")
+{
+    Event event;
+    test_reentrant_event = &event;
+
+    test_handled_count = 0;
+    TEST_ASSERT_TRUE(event.registerEvent(&test_reentrant_object_a, test_event_handler, Event::ID::CUSTOM));
+    TEST_ASSERT_TRUE(event.registerEvent(&test_reentrant_object_a, test_reentrant_event_handler, Event::ID::CUSTOM));
+    TEST_ASSERT_TRUE(event.registerEvent(&test_reentrant_object_a, test_event_handler, Event::ID::CUSTOM));
+
+    // The third handler is unregistered by the second one, so it should be skipped
+    TEST_ASSERT_TRUE(event.sendEvent(&test_reentrant_object_a, Event::ID::CUSTOM));
+    TEST_ASSERT_EQUAL(1, test_handled_count);
+
+    // The handler registered during the dispatch should be visible after it returns
+    TEST_ASSERT_TRUE(event.sendEvent(&test_reentrant_object_a, Event::ID::CUSTOM));
+    TEST_ASSERT_EQUAL(1, test_handled_count);
+    TEST_ASSERT_TRUE(event.sendEvent(&test_reentrant_object_b, Event::ID::CUSTOM));
+    TEST_ASSERT_EQUAL(2, test_handled_count);
+
+    test_reentrant_event = nullptr;
+}
+
+TEST_CASE("test event ID recycling", "[esp-brookesia][event][recycle]")
+{
+    Event event;
+    int object_a = 0;
+    int object_b = 0;
+
+    Event::ID id_a = event.getFreeEventID();
+    Event::ID id_b = event.getFreeEventID();
+    TEST_ASSERT_TRUE(event.registerEvent(&object_a, test_event_handler, id_a));
+    TEST_ASSERT_TRUE(event.registerEvent(&object_b, test_event_handler, id_a));
+    TEST_ASSERT_TRUE(event.registerEvent(&object_a, test_event_handler, id_b));
+
+    // `id_a` is still used by `object_b`, only `id_b` can be recycled
+    event.unregisterEvent(&object_a);
+    TEST_ASSERT_EQUAL(static_cast<int>(id_b), static_cast<int>(event.getFreeEventID()));
+
+    event.unregisterEvent(test_event_handler);
+    TEST_ASSERT_EQUAL(static_cast<int>(id_a), static_cast<int>(event.getFreeEventID()));
+
+    // A recycled ID registered again is taken out of the free list, so it is handed out only once
+    event.unregisterEvent(id_a);
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(event.registerEvent(&object_a, test_event_handler, id_a));
+        event.unregisterEvent(&object_a);
+    }
+    TEST_ASSERT_EQUAL(static_cast<int>(id_a), static_cast<int>(event.getFreeEventID()));
+    Event::ID id_c = event.getFreeEventID();
+    TEST_ASSERT_NOT_EQUAL(static_cast<int>(id_a), static_cast<int>(id_c));
+
+    // Built-in IDs are never handed out by `getFreeEventID()`
+    TEST_ASSERT_TRUE(event.registerEvent(&object_a, test_event_handler, Event::ID::NAVIGATION));
+    event.unregisterEvent(&object_a, Event::ID::NAVIGATION);
+    TEST_ASSERT_GREATER_THAN(static_cast<int>(id_c), static_cast<int>(event.getFreeEventID()));
+}
+
+TEST_CASE("test event post from other threads", "[esp-brookesia][event][post]")
+{
+    Event event;
+    int object_a = 0;
+    int object_b = 0;
+
+    test_handled_count = 0;
+    TEST_ASSERT_TRUE(event.registerEvent(&object_a, test_event_handler, Event::ID::CUSTOM));
+    TEST_ASSERT_TRUE(event.registerEvent(&object_b, test_event_handler, Event::ID::CUSTOM));
+
+    // Coalesced events with the same (object, ID) are dispatched only once
+    // The results are checked on the test task, a failed assertion must not unwind the stack of another thread
+    std::atomic<int> post_failed_count = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < TEST_EVENT_POST_THREAD_NUM; i++) {
+        threads.emplace_back([&event, &object_a, &post_failed_count]() {
+            for (int j = 0; j < TEST_EVENT_POST_NUM_PER_THREAD; j++) {
+                if (!event.postEvent(&object_a, Event::ID::CUSTOM, nullptr, true)) {
+                    post_failed_count++;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    TEST_ASSERT_EQUAL(0, post_failed_count.load());
+    TEST_ASSERT_EQUAL(0, test_handled_count);
+    TEST_ASSERT_EQUAL(1, event.dispatchPostedEvents());
+    TEST_ASSERT_EQUAL(1, test_handled_count);
+
+    // Events without coalescing are all dispatched
+    for (int i = 0; i < TEST_EVENT_POST_NUM_PER_THREAD; i++) {
+        TEST_ASSERT_TRUE(event.postEvent(&object_b, Event::ID::CUSTOM));
+    }
+    TEST_ASSERT_EQUAL(TEST_EVENT_POST_NUM_PER_THREAD, event.dispatchPostedEvents());
+    TEST_ASSERT_EQUAL(1 + TEST_EVENT_POST_NUM_PER_THREAD, test_handled_count);
+
+    // The queue is bounded, posting fails instead of blocking when it is full
+    for (size_t i = 0; i < Event::POST_QUEUE_SIZE; i++) {
+        TEST_ASSERT_TRUE(event.postEvent(&object_b, Event::ID::CUSTOM));
+    }
+    TEST_ASSERT_FALSE(event.postEvent(&object_b, Event::ID::CUSTOM));
+    TEST_ASSERT_EQUAL(Event::POST_QUEUE_SIZE, event.dispatchPostedEvents());
+    TEST_ASSERT_EQUAL(0, event.dispatchPostedEvents());
+}
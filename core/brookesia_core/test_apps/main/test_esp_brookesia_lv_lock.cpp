@@ -0,0 +1,255 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "esp_timer.h"
+#include "unity.h"
+#include "lvgl.h"
+#include "esp_lib_utils.h"
+#include "esp_brookesia.hpp"
+#include "gui/lvgl/esp_brookesia_lv_lock.hpp"
+
+using namespace esp_brookesia::gui;
+
+#define TEST_LOCK_HOLD_TIME_MS      (20)
+#define TEST_LOCK_BLOCK_TIME_MS     (50)
+// Margin of the measured times, the FreeRTOS tick is 1 ms
+#define TEST_LOCK_TIME_MARGIN_MS    (5)
+#define TEST_LOCK_HOLDER_NAME       "lv_holder"
+#define TEST_LOCK_UI_TASK_NUM       (8)
+#define TEST_LOCK_UI_TASK_WAIT_MS   (1000)
+
+// Stands in for the display lock of the BSP
+static std::recursive_timed_mutex test_lock_mutex;
+
+static void test_lock_register_callbacks()
+{
+    LvLock::registerCallbacks([](int timeout_ms) {
+        if (timeout_ms < 0) {
+            test_lock_mutex.lock();
+            return true;
+        }
+        return test_lock_mutex.try_lock_for(std::chrono::milliseconds(timeout_ms));
+    }, []() {
+        test_lock_mutex.unlock();
+        return true;
+    });
+}
+
+// Holds the display lock in another thread until the future is ready
+static std::thread test_lock_hold_in_thread(std::future<void> release_future)
+{
+    std::promise<void> locked_promise;
+    auto locked_future = locked_promise.get_future();
+    std::thread holder_thread;
+    {
+        esp_utils::thread_config_guard thread_config(esp_utils::ThreadConfig{
+            .name = TEST_LOCK_HOLDER_NAME,
+        });
+        holder_thread = std::thread([&locked_promise, release_future = std::move(release_future)]() mutable {
+            std::lock_guard<std::recursive_timed_mutex> lock(test_lock_mutex);
+            locked_promise.set_value();
+            release_future.wait();
+        });
+    }
+    locked_future.wait();
+
+    return holder_thread;
+}
+
+TEST_CASE("test lv lock try lock", "[esp-brookesia][gui][lv_lock]")
+{
+    test_lock_register_callbacks();
+    auto &lock = LvLock::getInstance();
+
+    TEST_ASSERT_TRUE(lock.tryLock());
+    // Recursive in the same thread
+    TEST_ASSERT_TRUE(lock.tryLock());
+    TEST_ASSERT_TRUE(lock.unlock());
+    TEST_ASSERT_TRUE(lock.unlock());
+
+    std::promise<void> release_promise;
+    auto holder_thread = test_lock_hold_in_thread(release_promise.get_future());
+    // Returns at once instead of waiting for the holder
+    auto start_time_us = esp_timer_get_time();
+    TEST_ASSERT_FALSE(lock.tryLock());
+    TEST_ASSERT_TRUE(esp_timer_get_time() - start_time_us < TEST_LOCK_TIME_MARGIN_MS * 1000);
+    release_promise.set_value();
+    holder_thread.join();
+
+    TEST_ASSERT_TRUE(lock.tryLock());
+    TEST_ASSERT_TRUE(lock.unlock());
+
+    LvLock::registerCallbacks(nullptr, nullptr);
+}
+
+TEST_CASE("test lv lock ui task queue", "[esp-brookesia][gui][lv_lock]")
+{
+    lv_init();
+    lv_tick_set_cb([]() {
+        return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+    });
+    test_lock_register_callbacks();
+
+    // The tasks are only queued once the timer running them is created
+    TEST_ASSERT_FALSE(LvLock::isUiTaskTimerRunning());
+    TEST_ASSERT_FALSE(LvLock::runOnUiThread([]() {}));
+    TEST_ASSERT_TRUE(LvLock::beginUiTaskTimer());
+    TEST_ASSERT_TRUE(LvLock::isUiTaskTimerRunning());
+
+    // Queued while another thread holds the lock, without waiting for it
+    std::vector<int> run_order;
+    std::promise<void> release_promise;
+    auto holder_thread = test_lock_hold_in_thread(release_promise.get_future());
+    auto start_time_us = esp_timer_get_time();
+    for (int i = 0; i < TEST_LOCK_UI_TASK_NUM; i++) {
+        TEST_ASSERT_TRUE(LvLock::runOnUiThread([&run_order, i]() {
+            run_order.push_back(i);
+        }));
+    }
+    TEST_ASSERT_TRUE(esp_timer_get_time() - start_time_us < TEST_LOCK_TIME_MARGIN_MS * 1000);
+    release_promise.set_value();
+    holder_thread.join();
+    TEST_ASSERT_TRUE(run_order.empty());
+
+    // Run in order by the timer handler of LVGL
+    auto start = std::chrono::steady_clock::now();
+    while (static_cast<int>(run_order.size()) < TEST_LOCK_UI_TASK_NUM) {
+        TEST_ASSERT_TRUE(
+            std::chrono::steady_clock::now() - start < std::chrono::milliseconds(TEST_LOCK_UI_TASK_WAIT_MS)
+        );
+        {
+            LvLockGuard gui_guard;
+            lv_timer_handler();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(LV_DEF_REFR_PERIOD));
+    }
+    for (int i = 0; i < TEST_LOCK_UI_TASK_NUM; i++) {
+        TEST_ASSERT_EQUAL(i, run_order[i]);
+    }
+
+    // The tasks not run yet are dropped with the timer
+    TEST_ASSERT_TRUE(LvLock::runOnUiThread([&run_order]() {
+        run_order.push_back(TEST_LOCK_UI_TASK_NUM);
+    }));
+    TEST_ASSERT_TRUE(LvLock::delUiTaskTimer());
+    TEST_ASSERT_FALSE(LvLock::isUiTaskTimerRunning());
+    TEST_ASSERT_FALSE(LvLock::runOnUiThread([]() {}));
+    {
+        LvLockGuard gui_guard;
+        lv_timer_handler();
+    }
+    TEST_ASSERT_EQUAL(TEST_LOCK_UI_TASK_NUM, run_order.size());
+
+    LvLock::registerCallbacks(nullptr, nullptr);
+    lv_deinit();
+}
+
+#if CONFIG_ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER
+static const LvLock::ProfileOffender *test_lock_find_offender(const LvLock::ProfileReport &report, const char *tag)
+{
+    auto it = std::find_if(report.offenders.begin(), report.offenders.end(), [tag](const auto &offender) {
+        return offender.tag == tag;
+    });
+    return (it != report.offenders.end()) ? &*it : nullptr;
+}
+
+TEST_CASE("test lv lock profiler", "[esp-brookesia][gui][lv_lock]")
+{
+    test_lock_register_callbacks();
+    auto &lock = LvLock::getInstance();
+    LvLock::resetProfile();
+
+    // Only the outermost lock is recorded, with the hold time of the whole section
+    TEST_ASSERT_TRUE(lock.lock(-1, "test_hold"));
+    TEST_ASSERT_TRUE(lock.lock(-1, "test_nested"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(TEST_LOCK_HOLD_TIME_MS));
+    TEST_ASSERT_TRUE(lock.unlock());
+    TEST_ASSERT_TRUE(lock.unlock());
+
+    // Another thread holds the lock, so the next lock of this thread waits for it
+    std::promise<void> locked_promise;
+    auto locked_future = locked_promise.get_future();
+    std::thread holder_thread;
+    // Unity can not assert in other threads, the results are checked after the join
+    bool is_holder_locked = false;
+    bool is_holder_unlocked = false;
+    {
+        esp_utils::thread_config_guard thread_config(esp_utils::ThreadConfig{
+            .name = TEST_LOCK_HOLDER_NAME,
+        });
+        holder_thread = std::thread([&]() {
+            is_holder_locked = lock.lock(-1, "test_holder");
+            locked_promise.set_value();
+            if (is_holder_locked) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(TEST_LOCK_BLOCK_TIME_MS));
+                is_holder_unlocked = lock.unlock();
+            }
+        });
+    }
+    locked_future.wait();
+    // A busy lock is not an error of `tryLock()`, and it is not recorded
+    TEST_ASSERT_FALSE(lock.tryLock("test_try"));
+    TEST_ASSERT_TRUE(lock.lock(-1, "test_wait"));
+    TEST_ASSERT_TRUE(lock.unlock());
+    holder_thread.join();
+    TEST_ASSERT_TRUE(is_holder_locked);
+    TEST_ASSERT_TRUE(is_holder_unlocked);
+
+    LvLock::ProfileReport report = {};
+    TEST_ASSERT_TRUE(LvLock::getProfileReport(report));
+    TEST_ASSERT_TRUE(LvLock::dumpProfile());
+    TEST_ASSERT_EQUAL(3, report.record_count);
+    TEST_ASSERT_NULL(test_lock_find_offender(report, "test_nested"));
+    TEST_ASSERT_NULL(test_lock_find_offender(report, "test_try"));
+
+    auto hold = test_lock_find_offender(report, "test_hold");
+    TEST_ASSERT_NOT_NULL(hold);
+    TEST_ASSERT_EQUAL(1, hold->count);
+    TEST_ASSERT_TRUE(hold->max_hold_us >= (TEST_LOCK_HOLD_TIME_MS - TEST_LOCK_TIME_MARGIN_MS) * 1000);
+    TEST_ASSERT_TRUE(hold->max_wait_us < TEST_LOCK_TIME_MARGIN_MS * 1000);
+
+    // The holder keeps the lock the longest, so it is the top offender
+    auto holder = test_lock_find_offender(report, "test_holder");
+    TEST_ASSERT_NOT_NULL(holder);
+    TEST_ASSERT_TRUE(&report.offenders.front() == holder);
+    TEST_ASSERT_EQUAL_STRING(TEST_LOCK_HOLDER_NAME, holder->thread_name.c_str());
+    TEST_ASSERT_TRUE(holder->max_hold_us >= (TEST_LOCK_BLOCK_TIME_MS - TEST_LOCK_TIME_MARGIN_MS) * 1000);
+
+    auto wait = test_lock_find_offender(report, "test_wait");
+    TEST_ASSERT_NOT_NULL(wait);
+    TEST_ASSERT_TRUE(wait->max_wait_us >= (TEST_LOCK_BLOCK_TIME_MS - 2 * TEST_LOCK_TIME_MARGIN_MS) * 1000);
+    TEST_ASSERT_TRUE(wait->max_hold_us < TEST_LOCK_TIME_MARGIN_MS * 1000);
+
+    // Each record is counted once in each histogram, in the bucket of its time
+    size_t wait_num = 0;
+    size_t hold_num = 0;
+    for (size_t i = 0; i < LvLock::PROFILE_BUCKET_NUM; i++) {
+        wait_num += report.wait_histogram[i];
+        hold_num += report.hold_histogram[i];
+    }
+    TEST_ASSERT_EQUAL(report.record_count, wait_num);
+    TEST_ASSERT_EQUAL(report.record_count, hold_num);
+    // 10 ms <= hold of "test_hold" < 30 ms, 30 ms <= hold of "test_holder" and wait of "test_wait" < 100 ms
+    TEST_ASSERT_EQUAL(1, report.hold_histogram[4]);
+    TEST_ASSERT_EQUAL(1, report.hold_histogram[5]);
+    TEST_ASSERT_EQUAL(1, report.wait_histogram[5]);
+
+    // Only the records after the reset are reported
+    LvLock::resetProfile();
+    TEST_ASSERT_TRUE(LvLock::getProfileReport(report));
+    TEST_ASSERT_EQUAL(0, report.record_count);
+    TEST_ASSERT_TRUE(report.offenders.empty());
+
+    LvLock::registerCallbacks(nullptr, nullptr);
+}
+
+#endif // CONFIG_ESP_BROOKESIA_LVGL_LOCK_ENABLE_PROFILER
@@ -0,0 +1,580 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "sdkconfig.h"
+#if CONFIG_ESP_BROOKESIA_SERVICES_ENABLE_STORAGE_NVS
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_vfs_fat.h"
+#include "nvs_flash.h"
+#include "unity.h"
+#include "esp_brookesia.hpp"
+
+using namespace esp_brookesia::services;
+
+#define TEST_PARAMS_READER_NUM      (2)
+#define TEST_PARAMS_WRITE_NUM       (200)
+#define TEST_PARAMS_WRITE_PERIOD_MS (5)
+#define TEST_PARAMS_KEY_SSID        "wlan_ssid"
+#define TEST_PARAMS_KEY_PASSWORD    "wlan_pwd"
+#define TEST_NVS_NAMESPACE          "test_storage"
+#define TEST_FILE_BASE_PATH         "/test_fs"
+#define TEST_FILE_PARTITION_LABEL   "storage"
+// FAT without long file names, so the temporary file of compaction (`<path>.tmp`) has to be a 8.3 name
+#define TEST_FILE_LOG_PATH          TEST_FILE_BASE_PATH "/kv"
+#define TEST_STORAGE_SET_NUM        (20)
+#define TEST_STORAGE_KEY_VOLUME     "test_volume"
+#define TEST_STORAGE_KEY_BRIGHTNESS "test_brightness"
+#define TEST_STORAGE_KEY_BAD        "test_bad"
+#define TEST_STORAGE_KEY_OTHER      "test_other"
+#define TEST_STORAGE_KEY_GAIN       "test_gain"
+// Margin of the write-back window, the storage thread may be delayed by the others
+#define TEST_STORAGE_WINDOW_MARGIN_MS   (200)
+
+static const char *TAG = "test_esp_brookesia_storage_nvs";
+
+/**
+ * The read path used before the snapshot table, kept here as the baseline of the benchmark
+ */
+class TestLockedParams {
+public:
+    bool getLocalParam(const std::string &key, StorageNVS::Value &value)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _params.find(key);
+        if (it == _params.end()) {
+            return false;
+        }
+        value = it->second;
+        return true;
+    }
+
+    void setLocalParam(const std::string &key, const StorageNVS::Value &value)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _params[key] = value;
+    }
+
+private:
+    std::mutex _mutex;
+    std::map<std::string, StorageNVS::Value> _params;
+};
+
+template <typename ReadFunc, typename WriteFunc>
+static size_t test_params_benchmark(ReadFunc &&read_func, WriteFunc &&write_func)
+{
+    std::atomic<bool> is_running = true;
+    std::atomic<size_t> read_count = 0;
+    std::atomic<size_t> read_failed_count = 0;
+
+    // The results are checked on the test task, a failed assertion must not unwind the stack of another thread
+    std::vector<std::thread> readers;
+    for (int i = 0; i < TEST_PARAMS_READER_NUM; i++) {
+        readers.emplace_back([&]() {
+            size_t count = 0;
+            while (is_running) {
+                if (!read_func()) {
+                    read_failed_count++;
+                }
+                count++;
+            }
+            read_count += count;
+        });
+    }
+
+    for (int i = 0; i < TEST_PARAMS_WRITE_NUM; i++) {
+        write_func(i);
+        std::this_thread::sleep_for(std::chrono::milliseconds(TEST_PARAMS_WRITE_PERIOD_MS));
+    }
+    is_running = false;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    TEST_ASSERT_EQUAL(0, read_failed_count.load());
+
+    return read_count;
+}
+
+TEST_CASE("test storage nvs snapshot read benchmark", "[esp-brookesia][storage_nvs][benchmark]")
+{
+    size_t locked_read_count = 0;
+    size_t snapshot_read_count = 0;
+
+    {
+        TestLockedParams params;
+        params.setLocalParam(TEST_PARAMS_KEY_SSID, std::string("ssid"));
+        params.setLocalParam(TEST_PARAMS_KEY_PASSWORD, std::string("password"));
+        locked_read_count = test_params_benchmark([&]() {
+            StorageNVS::Value ssid;
+            StorageNVS::Value password;
+            return params.getLocalParam(TEST_PARAMS_KEY_SSID, ssid) &&
+                   params.getLocalParam(TEST_PARAMS_KEY_PASSWORD, password) &&
+                   (std::get<std::string>(ssid).size() > 0);
+        }, [&](int i) {
+            params.setLocalParam(TEST_PARAMS_KEY_SSID, "ssid_" + std::to_string(i));
+        });
+    }
+    {
+        StorageNVSParams params;
+        params.update([](StorageNVSParams::Map & map) {
+            map[TEST_PARAMS_KEY_SSID] = std::string("ssid");
+            map[TEST_PARAMS_KEY_PASSWORD] = std::string("password");
+        });
+        snapshot_read_count = test_params_benchmark([&]() {
+            auto snapshot = params.acquire();
+            std::string_view ssid;
+            std::string_view password;
+            return snapshot.getString(TEST_PARAMS_KEY_SSID, ssid) &&
+                   snapshot.getString(TEST_PARAMS_KEY_PASSWORD, password) && (ssid.size() > 0);
+        }, [&](int i) {
+            params.update([i](StorageNVSParams::Map & map) {
+                map[TEST_PARAMS_KEY_SSID] = "ssid_" + std::to_string(i);
+            });
+        });
+        TEST_ASSERT_EQUAL(TEST_PARAMS_WRITE_NUM + 1, params.acquire().getVersion());
+    }
+
+    ESP_LOGI(TAG, "%d readers, %d writes every %d ms", TEST_PARAMS_READER_NUM, TEST_PARAMS_WRITE_NUM,
+             TEST_PARAMS_WRITE_PERIOD_MS);
+    ESP_LOGI(TAG, "Locked  : %d reads", static_cast<int>(locked_read_count));
+    ESP_LOGI(TAG, "Snapshot: %d reads", static_cast<int>(snapshot_read_count));
+}
+
+TEST_CASE("test storage nvs snapshot outlives updates", "[esp-brookesia][storage_nvs][snapshot]")
+{
+    StorageNVSParams params;
+    params.update([](StorageNVSParams::Map & map) {
+        map[TEST_PARAMS_KEY_SSID] = std::string("old");
+    });
+
+    auto snapshot = params.acquire();
+    std::string_view ssid;
+    TEST_ASSERT_TRUE(snapshot.getString(TEST_PARAMS_KEY_SSID, ssid));
+
+    params.update([](StorageNVSParams::Map & map) {
+        map[TEST_PARAMS_KEY_SSID] = std::string("new");
+    });
+
+    // The pinned version is still readable, the new one is visible to new snapshots
+    TEST_ASSERT_EQUAL_STRING_LEN("old", ssid.data(), ssid.size());
+    auto new_snapshot = params.acquire();
+    std::string_view new_ssid;
+    TEST_ASSERT_TRUE(new_snapshot.getString(TEST_PARAMS_KEY_SSID, new_ssid));
+    TEST_ASSERT_EQUAL_STRING_LEN("new", new_ssid.data(), new_ssid.size());
+}
+
+TEST_CASE("test storage nvs extended types and migration", "[esp-brookesia][storage_nvs][types]")
+{
+    // A namespace of its own, so the real "storage" one is left untouched
+    StorageNVSBackend::Params params;
+    {
+        StorageNVSFlashBackend backend(NVS_DEFAULT_PART_NAME, TEST_NVS_NAMESPACE);
+        TEST_ASSERT_TRUE(backend.init());
+        TEST_ASSERT_TRUE(backend.eraseAll());
+        TEST_ASSERT_TRUE(backend.set("test_gain", std::string("3.5")));
+        TEST_ASSERT_TRUE(backend.set("test_blob", StorageNVS::Blob{1, 2, 3, 4}));
+        TEST_ASSERT_TRUE(backend.set("test_time", static_cast<int64_t>(1) << 40));
+        // Only a declared key may hold a float
+        TEST_ASSERT_FALSE(backend.set("test_ratio", 0.5f));
+        TEST_ASSERT_TRUE(backend.commit());
+    }
+    {
+        // A u32 written by someone else is not a float
+        nvs_handle_t handle = 0;
+        TEST_ASSERT_EQUAL(ESP_OK, nvs_open(TEST_NVS_NAMESPACE, NVS_READWRITE, &handle));
+        TEST_ASSERT_EQUAL(ESP_OK, nvs_set_u32(handle, "test_u32", 1));
+        TEST_ASSERT_EQUAL(ESP_OK, nvs_commit(handle));
+        nvs_close(handle);
+    }
+    {
+        StorageNVSFlashBackend backend(NVS_DEFAULT_PART_NAME, TEST_NVS_NAMESPACE, {"test_gain"});
+        TEST_ASSERT_TRUE(backend.init());
+        TEST_ASSERT_TRUE(backend.load(params));
+        TEST_ASSERT_TRUE(params.find("test_u32") == params.end());
+
+        // Migrate the string as `migrateLocalParam()` does
+        StorageNVS::Value gain;
+        TEST_ASSERT_TRUE(StorageNVS::parseFloatString(std::get<std::string>(params["test_gain"]), gain));
+        TEST_ASSERT_TRUE(backend.set("test_gain", gain));
+        TEST_ASSERT_TRUE(backend.commit());
+    }
+    {
+        // The values keep their types after a reload
+        StorageNVSFlashBackend backend(NVS_DEFAULT_PART_NAME, TEST_NVS_NAMESPACE, {"test_gain"});
+        params.clear();
+        TEST_ASSERT_TRUE(backend.init());
+        TEST_ASSERT_TRUE(backend.load(params));
+        TEST_ASSERT_EQUAL(3, params.size());
+        TEST_ASSERT_EQUAL_FLOAT(3.5f, std::get<float>(params["test_gain"]));
+        TEST_ASSERT_TRUE(std::get<int64_t>(params["test_time"]) == (static_cast<int64_t>(1) << 40));
+        TEST_ASSERT_TRUE(std::get<StorageNVS::Blob>(params["test_blob"]) == StorageNVS::Blob({1, 2, 3, 4}));
+        TEST_ASSERT_TRUE(backend.eraseAll());
+    }
+    params.clear();
+
+    // The test app uses NVS only here, release the memory of the partition for the leak check
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_flash_deinit());
+}
+
+static wl_handle_t test_file_wl_handle = WL_INVALID_HANDLE;
+
+static void test_file_mount()
+{
+    esp_vfs_fat_mount_config_t mount_config = {
+        .format_if_mount_failed = true,
+        .max_files = 4,
+        .allocation_unit_size = CONFIG_WL_SECTOR_SIZE,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, esp_vfs_fat_spiflash_mount_rw_wl(
+                          TEST_FILE_BASE_PATH, TEST_FILE_PARTITION_LABEL, &mount_config, &test_file_wl_handle
+                      ));
+    remove(TEST_FILE_LOG_PATH);
+    remove(TEST_FILE_LOG_PATH ".tmp");
+}
+
+static void test_file_unmount()
+{
+    remove(TEST_FILE_LOG_PATH);
+    remove(TEST_FILE_LOG_PATH ".tmp");
+    TEST_ASSERT_EQUAL(ESP_OK, esp_vfs_fat_spiflash_unmount_rw_wl(TEST_FILE_BASE_PATH, test_file_wl_handle));
+    test_file_wl_handle = WL_INVALID_HANDLE;
+}
+
+static void test_file_append(const void *data, size_t size)
+{
+    FILE *file = fopen(TEST_FILE_LOG_PATH, "ab");
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_EQUAL(size, fwrite(data, 1, size, file));
+    TEST_ASSERT_EQUAL(0, fclose(file));
+}
+
+TEST_CASE("test storage nvs file backend commit and replay", "[esp-brookesia][storage_nvs][file_backend]")
+{
+    test_file_mount();
+
+    StorageNVSFileBackend::Config config = {
+        .path = TEST_FILE_LOG_PATH,
+    };
+    {
+        StorageNVSFileBackend backend(config);
+        TEST_ASSERT_TRUE(backend.init());
+        TEST_ASSERT_TRUE(backend.set("int", 1));
+        TEST_ASSERT_TRUE(backend.set("str", std::string("value")));
+        TEST_ASSERT_TRUE(backend.set("float", 0.5f));
+        TEST_ASSERT_TRUE(backend.set("int64", static_cast<int64_t>(1) << 40));
+        TEST_ASSERT_TRUE(backend.set("blob", StorageNVSBackend::Blob{1, 2, 3}));
+        TEST_ASSERT_TRUE(backend.commit());
+        // Overwritten in a later commit, and never committed
+        TEST_ASSERT_TRUE(backend.set("int", 2));
+        TEST_ASSERT_TRUE(backend.commit());
+        TEST_ASSERT_TRUE(backend.set("int", 3));
+    }
+    {
+        StorageNVSFileBackend backend(config);
+        StorageNVSBackend::Params params;
+        TEST_ASSERT_TRUE(backend.init());
+        TEST_ASSERT_TRUE(backend.load(params));
+        TEST_ASSERT_EQUAL(5, params.size());
+        TEST_ASSERT_EQUAL(2, std::get<int>(params["int"]));
+        TEST_ASSERT_EQUAL_STRING("value", std::get<std::string>(params["str"]).c_str());
+        TEST_ASSERT_EQUAL_FLOAT(0.5f, std::get<float>(params["float"]));
+        TEST_ASSERT_TRUE(std::get<int64_t>(params["int64"]) == (static_cast<int64_t>(1) << 40));
+        TEST_ASSERT_TRUE(std::get<StorageNVSBackend::Blob>(params["blob"]) == StorageNVSBackend::Blob({1, 2, 3}));
+    }
+
+    // The log is compacted to the live keys once it grows beyond the ratio
+    config.compact_min_size = 0;
+    {
+        StorageNVSFileBackend backend(config);
+        TEST_ASSERT_TRUE(backend.init());
+        size_t log_size = backend.getLogSize();
+        for (int i = 0; i < 10; i++) {
+            TEST_ASSERT_TRUE(backend.set("int", i));
+            TEST_ASSERT_TRUE(backend.commit());
+        }
+        TEST_ASSERT_LESS_OR_EQUAL(log_size * config.compact_ratio, backend.getLogSize());
+    }
+    {
+        StorageNVSFileBackend backend(config);
+        StorageNVSBackend::Params params;
+        TEST_ASSERT_TRUE(backend.init());
+        TEST_ASSERT_TRUE(backend.load(params));
+        TEST_ASSERT_EQUAL(9, std::get<int>(params["int"]));
+    }
+
+    test_file_unmount();
+}
+
+TEST_CASE("test storage nvs file backend drops a torn tail", "[esp-brookesia][storage_nvs][file_backend]")
+{
+    test_file_mount();
+
+    StorageNVSFileBackend::Config config = {
+        .path = TEST_FILE_LOG_PATH,
+    };
+    size_t committed_size = 0;
+    {
+        StorageNVSFileBackend backend(config);
+        TEST_ASSERT_TRUE(backend.init());
+        TEST_ASSERT_TRUE(backend.set("int", 1));
+        TEST_ASSERT_TRUE(backend.commit());
+        committed_size = backend.getLogSize();
+    }
+
+    // A complete record without a commit marker, then a record cut in the middle of its value, as a power loss does
+    const uint8_t uncommitted_record[] = {1, 0, 3, 0, 4, 0, 0, 0, 'i', 'n', 't', 2, 0, 0, 0};
+    const uint8_t torn_record[] = {1, 0, 3, 0, 4, 0, 0, 0, 'i', 'n', 't', 3};
+    test_file_append(uncommitted_record, sizeof(uncommitted_record));
+    test_file_append(torn_record, sizeof(torn_record));
+
+    {
+        StorageNVSFileBackend backend(config);
+        StorageNVSBackend::Params params;
+        TEST_ASSERT_TRUE(backend.init());
+        TEST_ASSERT_TRUE(backend.load(params));
+        TEST_ASSERT_EQUAL(1, std::get<int>(params["int"]));
+        TEST_ASSERT_EQUAL(committed_size, backend.getLogSize());
+
+        // The next commit is appended right after the last valid one, so it is replayed
+        TEST_ASSERT_TRUE(backend.set("int", 4));
+        TEST_ASSERT_TRUE(backend.commit());
+    }
+    {
+        StorageNVSFileBackend backend(config);
+        StorageNVSBackend::Params params;
+        TEST_ASSERT_TRUE(backend.init());
+        TEST_ASSERT_TRUE(backend.load(params));
+        TEST_ASSERT_EQUAL(4, std::get<int>(params["int"]));
+    }
+
+    test_file_unmount();
+}
+/**
+ * Keeps the committed keys in memory, the set of the keys in `fail_keys` fails. Only accessed by the storage thread
+ * while `StorageNVS` is running, and by the test task after `del()`. Like `StorageNVSFlashBackend`, only the keys in
+ * `float_keys` may hold a float
+ */
+class TestMemoryBackend: public StorageNVSBackend {
+public:
+    const char *getName() const override
+    {
+        return "test_memory";
+    }
+    bool checkValueSupported(const Key &key, const Value &value) const override
+    {
+        return !std::holds_alternative<float>(value) || (float_keys.find(key) != float_keys.end());
+    }
+
+    std::set<Key> fail_keys;
+    std::set<Key> float_keys;
+    Params committed_params;
+
+protected:
+    bool doInit() override
+    {
+        return true;
+    }
+    bool doLoad(Params &params) override
+    {
+        params = committed_params;
+        return true;
+    }
+    bool doSet(const Key &key, const Value &value) override
+    {
+        if (fail_keys.find(key) != fail_keys.end()) {
+            return false;
+        }
+        _pending_params[key] = value;
+        return true;
+    }
+    bool doCommit() override
+    {
+        for (auto &[key, value] : _pending_params) {
+            committed_params[key] = value;
+        }
+        _pending_params.clear();
+        return true;
+    }
+    bool doEraseAll() override
+    {
+        committed_params.clear();
+        _pending_params.clear();
+        return true;
+    }
+
+private:
+    Params _pending_params;
+};
+
+static size_t test_storage_get_operation_count(const StorageNVSBackend &backend, StorageNVSBackend::Operation operation)
+{
+    return backend.getStats()[static_cast<size_t>(operation)].count;
+}
+
+#if CONFIG_ESP_BROOKESIA_STORAGE_NVS_WRITE_BACK_WINDOW_MS > 0
+TEST_CASE("test storage nvs write coalescing", "[esp-brookesia][storage_nvs][write_back]")
+{
+    auto &storage = StorageNVS::requestInstance();
+    auto backend = std::make_shared<TestMemoryBackend>();
+    TEST_ASSERT_TRUE(storage.begin(backend));
+
+    // Updates within one window are merged into a single write of each key
+    for (int i = 0; i < TEST_STORAGE_SET_NUM; i++) {
+        TEST_ASSERT_TRUE(storage.setLocalParam(TEST_STORAGE_KEY_VOLUME, i));
+        TEST_ASSERT_TRUE(storage.setLocalParam(TEST_STORAGE_KEY_BRIGHTNESS, i));
+    }
+    TEST_ASSERT_EQUAL(0, storage.getWriteStats().commits);
+
+    // Written back when the window is over, without any further event
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(CONFIG_ESP_BROOKESIA_STORAGE_NVS_WRITE_BACK_WINDOW_MS + TEST_STORAGE_WINDOW_MARGIN_MS)
+    );
+    auto stats = storage.getWriteStats();
+    TEST_ASSERT_EQUAL(2 * TEST_STORAGE_SET_NUM, stats.writes_requested);
+    TEST_ASSERT_EQUAL(2 * TEST_STORAGE_SET_NUM - 2, stats.writes_coalesced);
+    TEST_ASSERT_EQUAL(2, stats.writes_issued);
+    TEST_ASSERT_EQUAL(1, stats.commits);
+    TEST_ASSERT_EQUAL(2, test_storage_get_operation_count(*backend, StorageNVSBackend::Operation::Set));
+    TEST_ASSERT_EQUAL(1, test_storage_get_operation_count(*backend, StorageNVSBackend::Operation::Commit));
+
+    // A request with a future is written back at once
+    StorageNVS::EventFuture future;
+    TEST_ASSERT_TRUE(storage.setLocalParam(TEST_STORAGE_KEY_VOLUME, TEST_STORAGE_SET_NUM, nullptr, &future));
+    TEST_ASSERT_TRUE(future.get());
+    TEST_ASSERT_EQUAL(2, storage.getWriteStats().commits);
+
+    TEST_ASSERT_TRUE(storage.del());
+    TEST_ASSERT_EQUAL(TEST_STORAGE_SET_NUM, std::get<int>(backend->committed_params[TEST_STORAGE_KEY_VOLUME]));
+    TEST_ASSERT_EQUAL(TEST_STORAGE_SET_NUM - 1, std::get<int>(backend->committed_params[TEST_STORAGE_KEY_BRIGHTNESS]));
+}
+#endif // CONFIG_ESP_BROOKESIA_STORAGE_NVS_WRITE_BACK_WINDOW_MS > 0
+
+TEST_CASE("test storage nvs write failure", "[esp-brookesia][storage_nvs][write_back]")
+{
+    auto &storage = StorageNVS::requestInstance();
+    auto backend = std::make_shared<TestMemoryBackend>();
+    backend->fail_keys.insert(TEST_STORAGE_KEY_BAD);
+    TEST_ASSERT_TRUE(storage.begin(backend));
+
+    // The bad key is reported, the other keys of the same flush are still committed
+    StorageNVS::EventFuture future;
+    TEST_ASSERT_TRUE(storage.setLocalParam(TEST_STORAGE_KEY_BAD, 1));
+    TEST_ASSERT_TRUE(storage.setLocalParam(TEST_STORAGE_KEY_VOLUME, 1));
+    TEST_ASSERT_TRUE(storage.flushNVS(nullptr, &future));
+    TEST_ASSERT_FALSE(future.get());
+    auto stats = storage.getWriteStats();
+    TEST_ASSERT_EQUAL(1, stats.writes_failed);
+    TEST_ASSERT_EQUAL(1, stats.writes_issued);
+    TEST_ASSERT_EQUAL(1, stats.commits);
+
+    // The bad key is dropped, so it does not fail the next flushes
+    TEST_ASSERT_TRUE(storage.setLocalParam(TEST_STORAGE_KEY_VOLUME, 2));
+    TEST_ASSERT_TRUE(storage.flushNVS(nullptr, &future));
+    TEST_ASSERT_TRUE(future.get());
+    TEST_ASSERT_EQUAL(1, storage.getWriteStats().writes_failed);
+
+    TEST_ASSERT_TRUE(storage.del());
+    TEST_ASSERT_TRUE(backend->committed_params.find(TEST_STORAGE_KEY_BAD) == backend->committed_params.end());
+    TEST_ASSERT_EQUAL(2, std::get<int>(backend->committed_params[TEST_STORAGE_KEY_VOLUME]));
+}
+
+TEST_CASE("test storage nvs unsupported value", "[esp-brookesia][storage_nvs][types]")
+{
+    auto &storage = StorageNVS::requestInstance();
+    auto backend = std::make_shared<TestMemoryBackend>();
+    backend->float_keys.insert(TEST_STORAGE_KEY_GAIN);
+    backend->committed_params[TEST_STORAGE_KEY_OTHER] = std::string("0.5");
+    TEST_ASSERT_TRUE(storage.begin(backend));
+
+    // The caller gets the error at once, the value is not accepted in memory
+    StorageNVS::Value value;
+    TEST_ASSERT_FALSE(storage.setLocalParam(TEST_STORAGE_KEY_VOLUME, 0.5f));
+    TEST_ASSERT_FALSE(storage.getParamsSnapshot().find(TEST_STORAGE_KEY_VOLUME) != nullptr);
+    TEST_ASSERT_FALSE(storage.migrateLocalParam(TEST_STORAGE_KEY_OTHER, StorageNVS::parseFloatString));
+    TEST_ASSERT_TRUE(storage.getLocalParam(TEST_STORAGE_KEY_OTHER, value));
+    TEST_ASSERT_TRUE(std::holds_alternative<std::string>(value));
+
+    // A declared float key is accepted, and the write-back does not fail
+    StorageNVS::EventFuture future;
+    TEST_ASSERT_TRUE(storage.setLocalParam(TEST_STORAGE_KEY_GAIN, 0.5f, nullptr, &future));
+    TEST_ASSERT_TRUE(future.get());
+    TEST_ASSERT_EQUAL(0, storage.getWriteStats().writes_failed);
+
+    TEST_ASSERT_TRUE(storage.del());
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, std::get<float>(backend->committed_params[TEST_STORAGE_KEY_GAIN]));
+}
+
+TEST_CASE("test storage nvs key subscriptions", "[esp-brookesia][storage_nvs][subscription]")
+{
+    auto &storage = StorageNVS::requestInstance();
+    auto backend = std::make_shared<TestMemoryBackend>();
+    TEST_ASSERT_TRUE(storage.begin(backend));
+
+    // The slots are called on the storage thread, the received keys are checked once the future is ready
+    std::vector<StorageNVS::Key> volume_keys;
+    std::vector<StorageNVS::Key> display_keys;
+    size_t display_event_count = 0;
+    auto volume_connection = storage.connectKeyEventSignal(
+    TEST_STORAGE_KEY_VOLUME, [&](const StorageNVS::Event & event) {
+        volume_keys.push_back(event.key);
+    });
+    auto display_connection = storage.connectKeyEventSignal(
+    std::vector<StorageNVS::Key> {TEST_STORAGE_KEY_BRIGHTNESS, TEST_STORAGE_KEY_OTHER},
+    [&](const StorageNVS::Event & event) {
+        display_event_count++;
+        if (event.operation == StorageNVS::Operation::UpdateParam) {
+            display_keys.insert(display_keys.end(), event.keys.begin(), event.keys.end());
+        } else {
+            display_keys.push_back(event.key);
+        }
+    });
+    TEST_ASSERT_TRUE(volume_connection.connected());
+    TEST_ASSERT_TRUE(display_connection.connected());
+
+    // Each subscriber only gets its own keys, a key without subscriber is delivered to nobody
+    StorageNVS::EventFuture future;
+    TEST_ASSERT_TRUE(storage.setLocalParam(TEST_STORAGE_KEY_VOLUME, 1, nullptr, &future));
+    TEST_ASSERT_TRUE(future.get());
+    TEST_ASSERT_TRUE(storage.setLocalParam(TEST_STORAGE_KEY_BRIGHTNESS, 1, nullptr, &future));
+    TEST_ASSERT_TRUE(future.get());
+    TEST_ASSERT_TRUE(storage.setLocalParam(TEST_STORAGE_KEY_BAD, 1, nullptr, &future));
+    TEST_ASSERT_TRUE(future.get());
+    TEST_ASSERT_TRUE((std::vector<StorageNVS::Key> {TEST_STORAGE_KEY_VOLUME}) == volume_keys);
+    TEST_ASSERT_TRUE((std::vector<StorageNVS::Key> {TEST_STORAGE_KEY_BRIGHTNESS}) == display_keys);
+    TEST_ASSERT_EQUAL(1, display_event_count);
+
+    // A reload which changes several keys of a subscriber is delivered to it once, with only the changed keys
+    backend->committed_params[TEST_STORAGE_KEY_BRIGHTNESS] = 2;
+    backend->committed_params[TEST_STORAGE_KEY_OTHER] = 2;
+    display_keys.clear();
+    TEST_ASSERT_TRUE(storage.sendEvent({
+        .operation = StorageNVS::Operation::UpdateParam,
+    }, &future));
+    TEST_ASSERT_TRUE(future.get());
+    TEST_ASSERT_EQUAL(2, display_event_count);
+    TEST_ASSERT_TRUE(
+        (std::vector<StorageNVS::Key> {TEST_STORAGE_KEY_BRIGHTNESS, TEST_STORAGE_KEY_OTHER}) == display_keys
+    );
+    TEST_ASSERT_EQUAL(1, volume_keys.size());
+
+    // Nothing is delivered once disconnected
+    volume_connection.disconnect();
+    TEST_ASSERT_TRUE(storage.setLocalParam(TEST_STORAGE_KEY_VOLUME, 2, nullptr, &future));
+    TEST_ASSERT_TRUE(future.get());
+    TEST_ASSERT_EQUAL(1, volume_keys.size());
+    TEST_ASSERT_EQUAL(2, display_event_count);
+
+    TEST_ASSERT_TRUE(storage.del());
+}
+#endif // CONFIG_ESP_BROOKESIA_SERVICES_ENABLE_STORAGE_NVS
@@ -0,0 +1,140 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "unity.h"
+#include "esp_brookesia.hpp"
+
+using namespace esp_brookesia::gui;
+
+#define TEST_STYLESHEET_VALUE           (10)
+#define TEST_STYLESHEET_INVALID_VALUE   (-1)
+
+struct TestStylesheet {
+    int value;
+};
+
+/**
+ * Calibration doubles the value, so a stylesheet calibrated twice is caught by its value as well as by the count
+ */
+class TestStylesheetManager: public StylesheetManager<TestStylesheet> {
+public:
+    bool calibrateScreenSize(StyleSize &size) override
+    {
+        return (size.width > 0) && (size.height > 0);
+    }
+
+    int calibrate_count = 0;
+
+protected:
+    bool calibrateStylesheet(const StyleSize &screen_size, TestStylesheet &stylesheet) override
+    {
+        calibrate_count++;
+        if (stylesheet.value < 0) {
+            return false;
+        }
+        stylesheet.value *= 2;
+        return true;
+    }
+};
+
+static const StyleSize test_size_large = StyleSize::RECT(800, 480);
+static const StyleSize test_size_small = StyleSize::RECT(320, 240);
+
+TEST_CASE("test stylesheet manager lazy calibration", "[esp-brookesia][gui][stylesheet_manager]")
+{
+    TestStylesheetManager manager;
+    const TestStylesheet stylesheet = {TEST_STYLESHEET_VALUE};
+
+    // Nothing is calibrated when added
+    TEST_ASSERT_TRUE(manager.addStylesheet("a", test_size_large, stylesheet));
+    TEST_ASSERT_TRUE(manager.addStylesheet("b", test_size_large, stylesheet));
+    TEST_ASSERT_TRUE(manager.addStylesheet("a", test_size_small, stylesheet));
+    TEST_ASSERT_FALSE(manager.addStylesheet("a", StyleSize::RECT(0, 0), stylesheet));
+    TEST_ASSERT_EQUAL(3, manager.getStylesheetCount());
+    TEST_ASSERT_EQUAL(0, manager.calibrate_count);
+
+    // Calibrated once on the first use of each (name, resolution)
+    auto large_a = manager.getStylesheet("a", test_size_large);
+    TEST_ASSERT_NOT_NULL(large_a);
+    TEST_ASSERT_EQUAL(TEST_STYLESHEET_VALUE * 2, large_a->value);
+    TEST_ASSERT_EQUAL(1, manager.calibrate_count);
+    TEST_ASSERT_TRUE(large_a == manager.getStylesheet("a", test_size_large));
+    TEST_ASSERT_EQUAL(1, manager.calibrate_count);
+    auto small_a = manager.getStylesheet("a", test_size_small);
+    TEST_ASSERT_NOT_NULL(small_a);
+    TEST_ASSERT_TRUE(small_a != large_a);
+    TEST_ASSERT_EQUAL(TEST_STYLESHEET_VALUE * 2, small_a->value);
+    TEST_ASSERT_EQUAL(2, manager.calibrate_count);
+    // A missing one is not calibrated, and "b" is never used so it is never calibrated
+    TEST_ASSERT_NULL(manager.getStylesheet("c", test_size_large));
+    TEST_ASSERT_EQUAL(2, manager.calibrate_count);
+
+    // Replacing a stylesheet drops its calibration
+    TEST_ASSERT_TRUE(manager.addStylesheet("a", test_size_large, stylesheet));
+    large_a = manager.getStylesheet("a", test_size_large);
+    TEST_ASSERT_EQUAL(TEST_STYLESHEET_VALUE * 2, large_a->value);
+    TEST_ASSERT_EQUAL(3, manager.calibrate_count);
+
+    // An invalid stylesheet is accepted when added, then fails and is removed on its first use
+    TEST_ASSERT_TRUE(manager.addStylesheet("invalid", test_size_large, {TEST_STYLESHEET_INVALID_VALUE}));
+    TEST_ASSERT_EQUAL(4, manager.getStylesheetCount());
+    TEST_ASSERT_FALSE(manager.activateStylesheet("invalid", test_size_large));
+    TEST_ASSERT_EQUAL(3, manager.getStylesheetCount());
+    TEST_ASSERT_NULL(manager.getStylesheetHandle());
+}
+
+TEST_CASE("test stylesheet manager activation reuse", "[esp-brookesia][gui][stylesheet_manager]")
+{
+    TestStylesheetManager manager;
+    const TestStylesheet stylesheet = {TEST_STYLESHEET_VALUE};
+
+    TEST_ASSERT_TRUE(manager.addStylesheet("a", test_size_large, stylesheet));
+    TEST_ASSERT_TRUE(manager.addStylesheet("b", test_size_large, {TEST_STYLESHEET_VALUE + 1}));
+
+    // The active handle is the calibrated stylesheet itself, not a copy
+    TEST_ASSERT_TRUE(manager.activateStylesheet("a", test_size_large));
+    auto handle_a = manager.getStylesheetHandle();
+    TEST_ASSERT_NOT_NULL(handle_a.get());
+    TEST_ASSERT_TRUE(handle_a.get() == manager.getStylesheet("a", test_size_large));
+    TEST_ASSERT_EQUAL(TEST_STYLESHEET_VALUE * 2, manager.getStylesheet()->value);
+    TEST_ASSERT_EQUAL(1, manager.calibrate_count);
+
+    // Switching back and forth calibrates each one once
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(manager.activateStylesheet("b", test_size_large));
+        TEST_ASSERT_EQUAL((TEST_STYLESHEET_VALUE + 1) * 2, manager.getStylesheet()->value);
+        TEST_ASSERT_TRUE(manager.activateStylesheet("a", test_size_large));
+        TEST_ASSERT_TRUE(handle_a == manager.getStylesheetHandle());
+    }
+    TEST_ASSERT_EQUAL(2, manager.calibrate_count);
+    // The previous handle is kept unchanged by the switches
+    TEST_ASSERT_EQUAL(TEST_STYLESHEET_VALUE * 2, handle_a->value);
+
+    // Activating a stylesheet by value adds it once, then reuses it
+    const TestStylesheet stylesheet_c = {TEST_STYLESHEET_VALUE + 2};
+    TEST_ASSERT_TRUE(manager.activateStylesheet("c", test_size_small, stylesheet_c));
+    auto handle_c = manager.getStylesheetHandle();
+    TEST_ASSERT_EQUAL((TEST_STYLESHEET_VALUE + 2) * 2, handle_c->value);
+    TEST_ASSERT_EQUAL(3, manager.calibrate_count);
+    TEST_ASSERT_TRUE(manager.activateStylesheet("a", test_size_large));
+    TEST_ASSERT_TRUE(manager.activateStylesheet("c", test_size_small, stylesheet_c));
+    TEST_ASSERT_TRUE(handle_c == manager.getStylesheetHandle());
+    TEST_ASSERT_EQUAL(3, manager.calibrate_count);
+    TEST_ASSERT_EQUAL(3, manager.getStylesheetCount());
+
+    // The active stylesheet passed back is recognized by its calibrated data
+    TEST_ASSERT_TRUE(manager.activateStylesheet("c", test_size_small, *manager.getStylesheet()));
+    TEST_ASSERT_TRUE(handle_c == manager.getStylesheetHandle());
+    TEST_ASSERT_EQUAL(3, manager.calibrate_count);
+
+    // Different data with the same name and screen size replaces the added one, the previous handle is kept unchanged
+    const TestStylesheet stylesheet_c_new = {TEST_STYLESHEET_VALUE + 3};
+    TEST_ASSERT_TRUE(manager.activateStylesheet("c", test_size_small, stylesheet_c_new));
+    TEST_ASSERT_TRUE(handle_c != manager.getStylesheetHandle());
+    TEST_ASSERT_EQUAL((TEST_STYLESHEET_VALUE + 3) * 2, manager.getStylesheet()->value);
+    TEST_ASSERT_EQUAL((TEST_STYLESHEET_VALUE + 2) * 2, handle_c->value);
+    TEST_ASSERT_EQUAL(4, manager.calibrate_count);
+    TEST_ASSERT_EQUAL(3, manager.getStylesheetCount());
+}
@@ -7,3 +7,18 @@ from pytest_embedded import Dut
 @pytest.mark.env('esp32_s3_lcd_ev_board')
 def test_usb_stream(dut: Dut)-> None:
     dut.run_all_single_board_cases()
+
+# The storage NVS tests and benchmarks, built by `sdkconfig.ci.services`
+@pytest.mark.target('esp32s3')
+@pytest.mark.env('esp32_s3_lcd_ev_board')
+@pytest.mark.config('services')
+def test_esp_brookesia_services(dut: Dut)-> None:
+    dut.run_all_single_board_cases(group='storage_nvs')
+
+# The animation player and expression tests, built by `sdkconfig.ci.anim_player`
+@pytest.mark.target('esp32s3')
+@pytest.mark.env('esp32_s3_lcd_ev_board')
+@pytest.mark.config('anim_player')
+def test_esp_brookesia_anim_player(dut: Dut)-> None:
+    dut.run_all_single_board_cases(group='anim_player')
+    dut.run_all_single_board_cases(group='expression')
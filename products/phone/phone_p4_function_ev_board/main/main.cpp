@@ -85,20 +85,12 @@ extern "C" void app_main(void)
     Phone *phone = new (std::nothrow) Phone();
     ESP_UTILS_CHECK_NULL_EXIT(phone, "Create phone failed");
 
-    /* Try using a stylesheet that corresponds to the resolution */
-    Stylesheet *stylesheet = nullptr;
-    if ((BSP_LCD_H_RES == 1024) && (BSP_LCD_V_RES == 600)) {
-        stylesheet = new (std::nothrow) Stylesheet(STYLESHEET_1024_600_DARK);
-        ESP_UTILS_CHECK_NULL_EXIT(stylesheet, "Create stylesheet failed");
-    } else if ((BSP_LCD_H_RES == 800) && (BSP_LCD_V_RES == 1280)) {
-        stylesheet = new (std::nothrow) Stylesheet(STYLESHEET_800_1280_DARK);
-        ESP_UTILS_CHECK_NULL_EXIT(stylesheet, "Create stylesheet failed");
-    }
-    if (stylesheet) {
+    /* Use the built-in stylesheet of the resolution, it is looked up at compile time and used without a copy */
+    constexpr const Stylesheet *stylesheet = getBuiltinStylesheet(BSP_LCD_H_RES, BSP_LCD_V_RES);
+    if constexpr (stylesheet != nullptr) {
         ESP_UTILS_LOGI("Using stylesheet (%s)", stylesheet->core.name);
         ESP_UTILS_CHECK_FALSE_EXIT(phone->addStylesheet(stylesheet), "Add stylesheet failed");
         ESP_UTILS_CHECK_FALSE_EXIT(phone->activateStylesheet(stylesheet), "Activate stylesheet failed");
-        delete stylesheet;
     }
 
     {
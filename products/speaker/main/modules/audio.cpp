@@ -67,8 +67,8 @@ bool audio_init()
 
     /* Update media sound volume when NVS volume is updated */
     auto &storage_service = StorageNVS::requestInstance();
-    storage_service.connectEventSignal([&](const StorageNVS::Event & event) {
-        if ((event.operation != StorageNVS::Operation::UpdateNVS) || (event.key != Manager::SETTINGS_VOLUME)) {
+    storage_service.connectKeyEventSignal(Manager::SETTINGS_VOLUME, [&](const StorageNVS::Event & event) {
+        if (event.operation != StorageNVS::Operation::UpdateNVS) {
             return;
         }
 
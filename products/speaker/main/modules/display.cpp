@@ -65,10 +65,12 @@ bool display_init(bool default_dummy_draw)
 
     /* Configure LVGL lock and unlock */
     LvLock::registerCallbacks([](int timeout_ms) {
+        // `LvLock::tryLock()` only polls the lock, so a busy lock is not an error
+        if (timeout_ms == 0) {
+            return bsp_display_lock(1);
+        }
         if (timeout_ms < 0) {
             timeout_ms = 0;
-        } else if (timeout_ms == 0) {
-            timeout_ms = 1;
         }
         ESP_UTILS_CHECK_FALSE_RETURN(bsp_display_lock(timeout_ms), false, "Lock failed");
 
@@ -78,11 +80,12 @@ bool display_init(bool default_dummy_draw)
 
         return true;
     });
+    ESP_UTILS_CHECK_FALSE_RETURN(LvLock::beginUiTaskTimer(), false, "Begin UI task timer failed");
 
     /* Update display brightness when NVS brightness is updated */
     auto &storage_service = StorageNVS::requestInstance();
-    storage_service.connectEventSignal([&](const StorageNVS::Event & event) {
-        if ((event.operation != StorageNVS::Operation::UpdateNVS) || (event.key != Manager::SETTINGS_BRIGHTNESS)) {
+    storage_service.connectKeyEventSignal(Manager::SETTINGS_BRIGHTNESS, [&](const StorageNVS::Event & event) {
+        if (event.operation != StorageNVS::Operation::UpdateNVS) {
             return;
         }
 
@@ -146,6 +149,8 @@ bool display_init(bool default_dummy_draw)
             lv_obj_invalidate(lv_screen_active());
         } else {
             ESP_UTILS_CHECK_FALSE_EXIT(clear_display(disp), "Clear display failed");
+            // The animations are drawn on a cleared screen, so their next frames must be flushed completely
+            AnimPlayer::invalidateDeltaFrames();
         }
 
         is_lvgl_dummy_draw = enable;
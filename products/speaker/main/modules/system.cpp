@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: CC0-1.0
  */
 #include <string>
+#include <memory>
 #include "soc/soc_caps.h"
 #if SOC_USB_SERIAL_JTAG_SUPPORTED
 #   include "soc/usb_serial_jtag_reg.h"
@@ -110,94 +111,113 @@ bool system_init()
     ESP_UTILS_CHECK_FALSE_RETURN(speaker->activateStylesheet(stylesheet.get()), false, "Activate stylesheet failed");
     stylesheet = nullptr;
 
-    /* Begin the speaker */
-    LvLockGuard gui_guard;
-    ESP_UTILS_CHECK_FALSE_RETURN(speaker->begin(), false, "Begin failed");
-
-    /* Init app from registry */
-    std::vector<systems::base::Manager::RegistryAppInfo> inited_apps;
-    ESP_UTILS_CHECK_FALSE_RETURN(speaker->initAppFromRegistry(inited_apps), false, "Init app registry failed");
-
-    /* Process apps */
-    Settings *app_settings = nullptr;
-    for (const auto &[app_name, app] : inited_apps) {
-        if (app_name == "Settings") { // Settings
-            auto app_settings_ptr = std::dynamic_pointer_cast<Settings>(app);
-            ESP_UTILS_CHECK_NULL_RETURN(app_settings_ptr, false, "Failed to get app settings");
-
-            app_settings = app_settings_ptr.get();
+    /* Install the apps while the boot animation plays, after the handlers of WiFi events are registered by ai buddy */
+    // The speaker keeps the stage after this function returns, so the results are shared instead of captured locals
+    struct InstalledApps {
+        std::vector<systems::base::Manager::RegistryAppInfo> inited_apps;
+        Settings *app_settings = nullptr;
+    };
+    auto installed_apps = std::make_shared<InstalledApps>();
+    auto install_apps = [speaker, installed_apps]() {
+        auto &inited_apps = installed_apps->inited_apps;
+        auto &app_settings = installed_apps->app_settings;
+
+        /* Init app from registry */
+        ESP_UTILS_CHECK_FALSE_RETURN(speaker->initAppFromRegistry(inited_apps), false, "Init app registry failed");
+
+        /* Process apps */
+        for (const auto &[app_name, app] : inited_apps) {
+            if (app_name == "Settings") { // Settings
+                auto app_settings_ptr = std::dynamic_pointer_cast<Settings>(app);
+                ESP_UTILS_CHECK_NULL_RETURN(app_settings_ptr, false, "Failed to get app settings");
+
+                app_settings = app_settings_ptr.get();
+            }
         }
-    }
-    // Settings
-    if (app_settings) {
-        std::unique_ptr<SettingsStylesheetData> app_settings_stylesheet;
-        ESP_UTILS_CHECK_EXCEPTION_RETURN(
-            app_settings_stylesheet = std::make_unique<SettingsStylesheetData>(SETTINGS_UI_360_360_STYLESHEET_DARK()),
-            false, "Create app settings stylesheet failed"
-        );
-        app_settings_stylesheet->screen_size = StyleSize::RECT_PERCENT(100, 100);
-        app_settings_stylesheet->manager.wlan.scan_ap_count_max = 30;
-        app_settings_stylesheet->manager.wlan.scan_interval_ms = 10000;
+        // Settings
+        if (app_settings) {
+            std::unique_ptr<SettingsStylesheetData> app_settings_stylesheet;
+            ESP_UTILS_CHECK_EXCEPTION_RETURN(
+                app_settings_stylesheet = std::make_unique<SettingsStylesheetData>(SETTINGS_UI_360_360_STYLESHEET_DARK()),
+                false, "Create app settings stylesheet failed"
+            );
+            app_settings_stylesheet->screen_size = StyleSize::RECT_PERCENT(100, 100);
+            app_settings_stylesheet->manager.wlan.scan_ap_count_max = 30;
+            app_settings_stylesheet->manager.wlan.scan_interval_ms = 10000;
 #if CONFIG_BSP_PCB_VERSION_V1_0
-        app_settings_stylesheet->manager.about.device_board_name = "EchoEar V1.0";
+            app_settings_stylesheet->manager.about.device_board_name = "EchoEar V1.0";
 #elif CONFIG_BSP_PCB_VERSION_V1_2
-        app_settings_stylesheet->manager.about.device_board_name = "EchoEar V1.2";
+            app_settings_stylesheet->manager.about.device_board_name = "EchoEar V1.2";
 #else
-        app_settings_stylesheet->manager.about.device_board_name = "EchoEar";
+            app_settings_stylesheet->manager.about.device_board_name = "EchoEar";
 #endif
-        app_settings_stylesheet->manager.about.device_ram_main = "512KB";
-        app_settings_stylesheet->manager.about.device_ram_minor = "16MB";
-        ESP_UTILS_CHECK_FALSE_RETURN(
-            app_settings->addStylesheet(speaker, app_settings_stylesheet.get()), false, "Add app settings stylesheet failed"
-        );
-        ESP_UTILS_CHECK_FALSE_RETURN(
-            app_settings->activateStylesheet(app_settings_stylesheet.get()), false, "Activate app settings stylesheet failed"
-        );
-        app_settings_stylesheet = nullptr;
+            app_settings_stylesheet->manager.about.device_ram_main = "512KB";
+            app_settings_stylesheet->manager.about.device_ram_minor = "16MB";
+            ESP_UTILS_CHECK_FALSE_RETURN(
+                app_settings->addStylesheet(speaker, app_settings_stylesheet.get()), false, "Add app settings stylesheet failed"
+            );
+            ESP_UTILS_CHECK_FALSE_RETURN(
+                app_settings->activateStylesheet(app_settings_stylesheet.get()), false, "Activate app settings stylesheet failed"
+            );
+            app_settings_stylesheet = nullptr;
 
-        // Process settings events
-        app_settings->manager.event_signal.connect([ = ](SettingsManager::EventType event_type, SettingsManager::EventData event_data) {
-            ESP_UTILS_LOGD("Param: event_type(%d), event_data(%s)", static_cast<int>(event_type), event_data.type().name());
+            // Process settings events
+            app_settings->manager.event_signal.connect([ = ](SettingsManager::EventType event_type, SettingsManager::EventData event_data) {
+                ESP_UTILS_LOGD("Param: event_type(%d), event_data(%s)", static_cast<int>(event_type), event_data.type().name());
 
-            switch (event_type) {
-            case SettingsManager::EventType::EnterDeveloperMode: {
-                ESP_UTILS_CHECK_FALSE_RETURN(
-                    event_data.type() == typeid(SettingsManager::EventDataEnterDeveloperMode), false,
-                    "Invalid developer mode type"
-                );
+                switch (event_type) {
+                case SettingsManager::EventType::EnterDeveloperMode: {
+                    ESP_UTILS_CHECK_FALSE_RETURN(
+                        event_data.type() == typeid(SettingsManager::EventDataEnterDeveloperMode), false,
+                        "Invalid developer mode type"
+                    );
 
-                ESP_UTILS_LOGW("Enter developer mode");
-                developer_mode_key = DEVELOPER_MODE_KEY;
-                esp_restart();
-                break;
-            }
-            case SettingsManager::EventType::EnterScreen: {
-                ESP_UTILS_CHECK_FALSE_RETURN(
-                    event_data.type() == typeid(SettingsManager::EventDataEnterScreenIndex), false,
-                    "Invalid developer mode type"
-                );
-                auto screen_index = std::any_cast<SettingsManager::EventDataEnterScreenIndex>(event_data);
-                if (screen_index == SettingsManager::UI_Screen::MORE_ABOUT) {
-                    // update about info immediately
-                    update_battery_info(speaker, app_settings);
+                    ESP_UTILS_LOGW("Enter developer mode");
+                    developer_mode_key = DEVELOPER_MODE_KEY;
+                    esp_restart();
+                    break;
+                }
+                case SettingsManager::EventType::EnterScreen: {
+                    ESP_UTILS_CHECK_FALSE_RETURN(
+                        event_data.type() == typeid(SettingsManager::EventDataEnterScreenIndex), false,
+                        "Invalid developer mode type"
+                    );
+                    auto screen_index = std::any_cast<SettingsManager::EventDataEnterScreenIndex>(event_data);
+                    if (screen_index == SettingsManager::UI_Screen::MORE_ABOUT) {
+                        // update about info immediately
+                        update_battery_info(speaker, app_settings);
+                    }
+                    break;
+                }
+                default:
+                    return false;
                 }
-                break;
-            }
-            default:
-                return false;
-            }
 
-            return true;
-        });
-    }
+                return true;
+            });
+        }
+
+        /* Install app from registry */
+        // The app will be installed in the order of the vector, this determines the order of app icons in the main interface
+        std::vector<std::string> ordered_app_names = {"Settings", "AI_Profile", "2048", "Calculator", "Timer", "Pos"};
+        ESP_UTILS_CHECK_FALSE_RETURN(
+            speaker->installAppFromRegistry(inited_apps, &ordered_app_names), false, "Install app registry failed"
+        );
 
-    /* Install app from registry */
-    // The app will be installed in the order of the vector, this determines the order of app icons in the main interface
-    std::vector<std::string> ordered_app_names = {"Settings", "AI_Profile", "2048", "Calculator", "Timer", "Pos"};
+        return true;
+    };
+    std::vector<std::string> install_apps_dependencies = {Speaker::BOOT_STAGE_MANAGER, Speaker::BOOT_STAGE_AI_BUDDY};
     ESP_UTILS_CHECK_FALSE_RETURN(
-        speaker->installAppFromRegistry(inited_apps, &ordered_app_names), false, "Install app registry failed"
+        speaker->addBootStage("apps", systems::base::BootSequence::Runner::CALLER, install_apps, install_apps_dependencies),
+        false, "Add apps boot stage failed"
     );
 
+    /* Begin the speaker */
+    LvLockGuard gui_guard;
+    ESP_UTILS_CHECK_FALSE_RETURN(speaker->begin(), false, "Begin failed");
+    auto inited_apps = installed_apps->inited_apps;
+    Settings *app_settings = installed_apps->app_settings;
+
     /* Register agent function calling */
     FunctionDefinition openApp("open_app", "Open a specific app.打开一个应用");
     openApp.addParameter("app_name", "The name of the app to open.应用名称", FunctionParameter::ValueType::String);
@@ -407,8 +427,8 @@ bool system_init()
 
     /* Process touch sensor */
     auto &storage_service = StorageNVS::requestInstance();
-    storage_service.connectEventSignal([](const StorageNVS::Event & event) {
-        if ((event.operation != StorageNVS::Operation::UpdateNVS) || (event.key != SETTINGS_NVS_KEY_TOUCH_SENSOR_SWITCH)) {
+    storage_service.connectKeyEventSignal(SETTINGS_NVS_KEY_TOUCH_SENSOR_SWITCH, [](const StorageNVS::Event & event) {
+        if (event.operation != StorageNVS::Operation::UpdateNVS) {
             return;
         }
         ESP_UTILS_LOG_TRACE_GUARD();
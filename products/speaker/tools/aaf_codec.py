@@ -0,0 +1,236 @@
+#!/usr/bin/env python3
+#
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""
+Parse, decode and encode AAF animations on the host.
+
+The frames are decoded the same way as the `anim_player` decoder used by `AnimPlayer`: the palette indexes of each
+block are run-length decoded, then mapped to RGB565 through the palette of the frame. The encoder produces the frames
+the decoder supports (8-bit palette, run-length encoded blocks).
+"""
+import os
+import struct
+
+# Header: frame number, checksum of the bytes after the header, length of the bytes after the header
+AAF_HEADER_FORMAT = '<3I'
+# Table entry of each frame: size, offset from the end of the table. Repeated frames share the same data
+AAF_ENTRY_FORMAT = '<2I'
+# Each frame starts with the magic, followed by the format, the version string and its size
+AAF_FRAME_MAGIC = b'ZZ'
+AAF_FRAME_FORMAT = b'_S'
+AAF_FRAME_VERSION = b'V1.00\x00'
+AAF_FRAME_SIZE_OFFSET = 12
+# Frame: magic, format, padding, version, bit depth, width, height, block number, block height
+AAF_FRAME_HEADER_FORMAT = '<2s2sx6sB4H'
+AAF_FRAME_BIT_DEPTH = 8
+# Palette entries are stored as B, G, R, 0
+AAF_PALETTE_ENTRY_SIZE = 4
+AAF_BLOCK_LEN_FORMAT = '<H'
+AAF_BLOCK_MAX_LEN = 0xFFFF
+AAF_BLOCK_ENCODING_RLE = 0
+AAF_RLE_MAX_COUNT = 0xFF
+
+
+def parse_aaf(data):
+    """Return the frame table of an AAF file as a list of `(size, offset)`, with offsets from the start of `data`"""
+    header_size = struct.calcsize(AAF_HEADER_FORMAT)
+    entry_size = struct.calcsize(AAF_ENTRY_FORMAT)
+    if len(data) < header_size:
+        raise ValueError('File is too small')
+
+    frame_num, checksum, length = struct.unpack_from(AAF_HEADER_FORMAT, data, 0)
+    if length != len(data) - header_size:
+        raise ValueError(f'Invalid length: {length}, expected {len(data) - header_size}')
+    if (sum(data[header_size:]) & 0xFFFFFFFF) != checksum:
+        raise ValueError('Checksum mismatch')
+
+    table_end = header_size + frame_num * entry_size
+    if (frame_num == 0) or (table_end > len(data)):
+        raise ValueError(f'Invalid frame number: {frame_num}')
+
+    frames = []
+    for i in range(frame_num):
+        size, offset = struct.unpack_from(AAF_ENTRY_FORMAT, data, header_size + i * entry_size)
+        start = table_end + offset
+        if start + size > len(data):
+            raise ValueError(f'Frame {i} is out of range')
+        if data[start:start + len(AAF_FRAME_MAGIC)] != AAF_FRAME_MAGIC:
+            raise ValueError(f'Frame {i} has an invalid magic')
+        frames.append((size, start))
+
+    return frames
+
+
+def get_frame_size(frame):
+    return struct.unpack_from('<2H', frame, AAF_FRAME_SIZE_OFFSET)
+
+
+def decode_frame_indexes(frame):
+    """Decode a frame into its width, height, palette (list of `(r, g, b)`) and palette indexes (one byte per pixel)"""
+    header_size = struct.calcsize(AAF_FRAME_HEADER_FORMAT)
+    magic, fmt, _, bit_depth, width, height, block_num, block_height = \
+        struct.unpack_from(AAF_FRAME_HEADER_FORMAT, frame, 0)
+    if (magic != AAF_FRAME_MAGIC) or (fmt != AAF_FRAME_FORMAT):
+        raise ValueError(f'Unsupported frame format: {fmt}')
+    if bit_depth != AAF_FRAME_BIT_DEPTH:
+        raise ValueError(f'Unsupported bit depth: {bit_depth}')
+    if (block_num == 0) or (block_height == 0):
+        raise ValueError('Invalid blocks')
+
+    len_size = struct.calcsize(AAF_BLOCK_LEN_FORMAT)
+    block_lens = [
+        struct.unpack_from(AAF_BLOCK_LEN_FORMAT, frame, header_size + i * len_size)[0] for i in range(block_num)
+    ]
+    offset = header_size + block_num * len_size
+    palette = []
+    for i in range(1 << bit_depth):
+        b, g, r, _ = frame[offset:offset + AAF_PALETTE_ENTRY_SIZE]
+        palette.append((r, g, b))
+        offset += AAF_PALETTE_ENTRY_SIZE
+
+    indexes = bytearray()
+    for i, block_len in enumerate(block_lens):
+        block = frame[offset:offset + block_len]
+        offset += block_len
+        if (len(block) != block_len) or (block_len == 0):
+            raise ValueError(f'Block {i} is out of range')
+        if block[0] != AAF_BLOCK_ENCODING_RLE:
+            raise ValueError(f'Unsupported encoding of block {i}: {block[0]}')
+        if (block_len - 1) % 2:
+            raise ValueError(f'Invalid length of block {i}: {block_len}')
+        for j in range(1, block_len, 2):
+            indexes += block[j + 1:j + 2] * block[j]
+        expected_size = width * min(block_height, height - i * block_height)
+        if len(indexes) != width * i * block_height + expected_size:
+            raise ValueError(f'Block {i} does not match the frame size')
+
+    return width, height, palette, bytes(indexes)
+
+
+def palette_to_rgb565(palette, swap_bytes=False):
+    """Convert the palette like `anim_player` does, `swap_bytes` matches `enable_data_swap_bytes` of `AnimPlayerData`"""
+    colors = []
+    for r, g, b in palette:
+        color = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+        colors.append(struct.pack('>H' if swap_bytes else '<H', color))
+    return colors
+
+
+def decode_frame(frame, swap_bytes=False):
+    """Decode a frame into its width, height and RGB565 pixels (2 bytes per pixel, little-endian unless swapped)"""
+    width, height, palette, indexes = decode_frame_indexes(frame)
+    colors = palette_to_rgb565(palette, swap_bytes)
+
+    return width, height, b''.join(colors[index] for index in indexes)
+
+
+def decode_aaf(data, swap_bytes=False):
+    """Decode all the frames of an AAF file, repeated frames are only decoded once"""
+    decoded = {}
+    result = []
+    for size, start in parse_aaf(data):
+        if start not in decoded:
+            decoded[start] = decode_frame(data[start:start + size], swap_bytes)
+        result.append(decoded[start])
+
+    return result
+
+
+def encode_rle(indexes):
+    data = bytearray([AAF_BLOCK_ENCODING_RLE])
+    i = 0
+    while i < len(indexes):
+        value = indexes[i]
+        count = 1
+        while (i + count < len(indexes)) and (indexes[i + count] == value) and (count < AAF_RLE_MAX_COUNT):
+            count += 1
+        data += bytes([count, value])
+        i += count
+
+    return bytes(data)
+
+
+def encode_frame(width, height, palette, indexes):
+    """Encode the palette indexes of a frame, `palette` holds up to 256 `(r, g, b)` entries"""
+    palette_num = 1 << AAF_FRAME_BIT_DEPTH
+    if len(palette) > palette_num:
+        raise ValueError(f'Too many colors: {len(palette)}')
+    if len(indexes) != width * height:
+        raise ValueError(f'Invalid pixel number: {len(indexes)}, expected {width * height}')
+
+    # Halve the block height until each block fits its 16-bit length
+    block_height = height
+    while True:
+        blocks = [
+            encode_rle(indexes[row * width:min(row + block_height, height) * width])
+            for row in range(0, height, block_height)
+        ]
+        if all(len(block) <= AAF_BLOCK_MAX_LEN for block in blocks):
+            break
+        if block_height == 1:
+            raise ValueError('Frame is too large to encode')
+        block_height = (block_height + 1) // 2
+
+    data = bytearray(struct.pack(
+        AAF_FRAME_HEADER_FORMAT, AAF_FRAME_MAGIC, AAF_FRAME_FORMAT, AAF_FRAME_VERSION, AAF_FRAME_BIT_DEPTH, width,
+        height, len(blocks), block_height
+    ))
+    for block in blocks:
+        data += struct.pack(AAF_BLOCK_LEN_FORMAT, len(block))
+    for r, g, b in list(palette) + [(0, 0, 0)] * (palette_num - len(palette)):
+        data += bytes([b, g, r, 0])
+    for block in blocks:
+        data += block
+
+    return bytes(data)
+
+
+def encode_aaf(frames):
+    """Pack encoded frames into an AAF file, repeated frames share the same data"""
+    if not frames:
+        raise ValueError('No frame to encode')
+
+    offsets = {}
+    body = bytearray()
+    table = bytearray()
+    for frame in frames:
+        if frame not in offsets:
+            offsets[frame] = len(body)
+            body += frame
+        table += struct.pack(AAF_ENTRY_FORMAT, len(frame), offsets[frame])
+
+    payload = bytes(table + body)
+    header = struct.pack(AAF_HEADER_FORMAT, len(frames), sum(payload) & 0xFFFFFFFF, len(payload))
+
+    return header + payload
+
+
+def encode_images(images):
+    """Encode Pillow images, each one is quantized to the 256 colors of its own palette"""
+    frames = []
+    size = None
+    for image in images:
+        if size is None:
+            size = image.size
+        elif image.size != size:
+            raise ValueError(f'Image size {image.size} differs from {size}')
+        image = image.convert('RGB').quantize(colors=1 << AAF_FRAME_BIT_DEPTH)
+        palette = image.getpalette()[:(1 << AAF_FRAME_BIT_DEPTH) * 3]
+        palette = [tuple(palette[i:i + 3]) for i in range(0, len(palette), 3)]
+        frames.append(encode_frame(size[0], size[1], palette, image.tobytes()))
+
+    return encode_aaf(frames)
+
+
+def collect_files(paths, extension='.aaf'):
+    files = []
+    for path in paths:
+        if os.path.isdir(path):
+            for root, _, names in os.walk(path):
+                files += [os.path.join(root, name) for name in sorted(names) if name.endswith(extension)]
+        else:
+            files.append(path)
+    return files
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+#
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""
+Decode AAF animations into raw RGB565 frames, and encode PNG/GIF sequences into AAF animations.
+Usage:
+    python3 aaf_convert.py decode [--swap-bytes] [--png] <aaf_file> <output_dir>
+    python3 aaf_convert.py encode <png_or_gif> [<png_or_gif> ...] <aaf_file>
+PNG output and encoding need Pillow (`pip install pillow`).
+"""
+import os
+import sys
+import struct
+import argparse
+
+from aaf_codec import decode_aaf, encode_images, collect_files
+
+
+def rgb565_to_rgb888(pixels, swap_bytes):
+    values = struct.unpack(f"{'>' if swap_bytes else '<'}{len(pixels) // 2}H", pixels)
+    rgb = bytearray()
+    for value in values:
+        rgb += bytes([(value >> 8) & 0xF8, (value >> 3) & 0xFC, (value << 3) & 0xF8])
+    return bytes(rgb)
+
+
+def decode(args):
+    with open(args.aaf, 'rb') as f:
+        frames = decode_aaf(f.read(), args.swap_bytes)
+    if args.png:
+        from PIL import Image
+
+    os.makedirs(args.output, exist_ok=True)
+    name = os.path.splitext(os.path.basename(args.aaf))[0]
+    for i, (width, height, pixels) in enumerate(frames):
+        path = os.path.join(args.output, f'{name}_{i:03d}')
+        if args.png:
+            Image.frombytes('RGB', (width, height), rgb565_to_rgb888(pixels, args.swap_bytes)).save(path + '.png')
+        else:
+            with open(path + '.rgb565', 'wb') as f:
+                f.write(pixels)
+    print(f'Decoded {len(frames)} frames ({frames[0][0]}x{frames[0][1]}) into {args.output}')
+
+
+def encode(args):
+    from PIL import Image, ImageSequence
+
+    images = []
+    for file in collect_files(args.images, '.png'):
+        with Image.open(file) as image:
+            images += [frame.copy() for frame in ImageSequence.Iterator(image)]
+    if not images:
+        print('Error: No image found.')
+        sys.exit(1)
+
+    data = encode_images(images)
+    with open(args.aaf, 'wb') as f:
+        f.write(data)
+    print(f'Encoded {len(images)} frames into {args.aaf} ({len(data)} bytes)')
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Decode AAF animations into RGB565 frames, and encode PNG/GIF sequences into AAF animations',
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  python3 aaf_convert.py decode emotion_happy_284_126.aaf happy_frames
+  python3 aaf_convert.py decode --png emotion_happy_284_126.aaf happy_preview
+  python3 aaf_convert.py encode happy_preview emotion_happy_284_126.aaf
+        """
+    )
+    subparsers = parser.add_subparsers(dest='command', required=True)
+
+    decode_parser = subparsers.add_parser('decode', help='Decode each frame into a raw RGB565 file')
+    decode_parser.add_argument('aaf', help='AAF file')
+    decode_parser.add_argument('output', help='Directory of the decoded frames')
+    decode_parser.add_argument(
+        '--swap-bytes', action='store_true', help='Swap the bytes of each pixel, like `enable_data_swap_bytes`'
+    )
+    decode_parser.add_argument('--png', action='store_true', help='Write the frames as PNG images instead')
+    decode_parser.set_defaults(func=decode)
+
+    encode_parser = subparsers.add_parser('encode', help='Encode images into an AAF file')
+    encode_parser.add_argument(
+        'images', nargs='+', help='PNG or GIF files in frame order, or directories of PNG files sorted by name'
+    )
+    encode_parser.add_argument('aaf', help='AAF file')
+    encode_parser.set_defaults(func=encode)
+
+    args = parser.parse_args()
+    try:
+        args.func(args)
+    except (OSError, ValueError, struct.error) as e:
+        print(f'Error: {e}')
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
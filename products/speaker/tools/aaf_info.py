@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+#
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""
+Report the frames and the size per frame of AAF animations, and check their checksums.
+Usage:
+    python3 aaf_info.py <aaf_file_or_dir> [<aaf_file_or_dir> ...]
+    python3 aaf_info.py --csv <aaf_file_or_dir> [<aaf_file_or_dir> ...]
+"""
+import os
+import sys
+import struct
+import argparse
+
+from aaf_codec import parse_aaf, get_frame_size, collect_files
+
+
+def get_aaf_info(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    frames = parse_aaf(data)
+    width, height = get_frame_size(data[frames[0][1]:])
+    unique_frames = {start: size for size, start in frames}
+
+    return {
+        'name': os.path.basename(path),
+        'width': width,
+        'height': height,
+        'frames': len(frames),
+        'unique_frames': len(unique_frames),
+        'file_bytes': len(data),
+        'bytes_per_frame': len(data) // len(frames),
+        'max_frame_bytes': max(size for size, _ in frames),
+        # Compared with the raw RGB565 pixels of the unique frames
+        'ratio': sum(unique_frames.values()) / (len(unique_frames) * width * height * 2),
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Report the frames and the size per frame of AAF animations',
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  python3 aaf_info.py ../../../core/brookesia_core/systems/speaker/assets/animations
+  python3 aaf_info.py --csv emotion_happy_284_126.aaf
+        """
+    )
+    parser.add_argument('paths', nargs='+', help='AAF files, or directories to search for them')
+    parser.add_argument('--csv', action='store_true', help='Print the result as CSV')
+    args = parser.parse_args()
+
+    files = collect_files(args.paths)
+    if not files:
+        print('Error: No AAF file found.')
+        sys.exit(1)
+
+    keys = ['name', 'width', 'height', 'frames', 'unique_frames', 'file_bytes', 'bytes_per_frame',
+            'max_frame_bytes', 'ratio']
+    if args.csv:
+        print(','.join(keys))
+    else:
+        print(f"{'name':<36} {'size':>9} {'frames':>7} {'unique':>7} {'bytes':>8} {'B/frame':>8} "
+              f"{'max B':>7} {'ratio':>6}")
+
+    has_error = False
+    for file in files:
+        try:
+            info = get_aaf_info(file)
+        except (OSError, ValueError, struct.error) as e:
+            print(f"Error: Failed to parse '{file}': {e}")
+            has_error = True
+            continue
+
+        if args.csv:
+            print(','.join(f'{info[key]:.3f}' if key == 'ratio' else str(info[key]) for key in keys))
+        else:
+            print(f"{info['name']:<36} {info['width']:>4}x{info['height']:<4} {info['frames']:>7} "
+                  f"{info['unique_frames']:>7} {info['file_bytes']:>8} {info['bytes_per_frame']:>8} "
+                  f"{info['max_frame_bytes']:>7} {info['ratio']:>6.3f}")
+
+    sys.exit(1 if has_error else 0)
+
+
+if __name__ == '__main__':
+    main()